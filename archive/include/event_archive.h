@@ -0,0 +1,106 @@
+/**
+ * @file event_archive.h
+ * @author AK <alex.nuclearboy@gmail.com>
+ * @brief Compact archive format of the PLUTO event files.
+ *
+ * The PLUTO tree "data" written by the generators stores every particle as
+ * a PParticle object of a TClonesArray, and every event the Impact and Phi
+ * branches, which are always 0. For long-term storage the events are kept
+ * instead as flat columns:
+ *
+ * - tree "particles", one entry per particle in the order of the events:
+ *   px, py, pz, e [GeV] (Double_t, or Float_t if single precision) and the
+ *   PLUTO code pid (Int_t);
+ * - tree "events", one entry per event: end (Long64_t), the number of
+ *   particles of this and all earlier events, i.e. the particles of event
+ *   i are the entries [end(i-1), end(i)) of "particles"; Accepted and
+ *   Channel (Int_t) if the PLUTO tree has them;
+ * - Impact and Phi (TParameter<Float_t>) holding the constant values of
+ *   the branches of the same name.
+ *
+ * All other objects of the PLUTO file (event counts, acceptance, the
+ * "values" tree of a single-file output) are copied unchanged.
+ *
+ * The energy is stored rather than the mass, so that the four-momenta are
+ * restored bit by bit. The vertex and the weight of the particles are not
+ * stored; files with a particle not at the origin or with a weight other
+ * than 1 are not archived. Single precision loses the lower bits of the
+ * momenta, which GEANT3 does not use (it tracks in single precision).
+ *
+ * restore() writes the PLUTO tree read by the KINE 50 card of WMC: the
+ * branches Npart, Impact, Phi, Particles (PParticle with code and
+ * four-momentum) and Accepted and Channel if archived.
+ *
+ * @date 2026-10-18
+ *
+ * @note Distributed under the GNU General Public License version 3.0 (GPLv3).
+ */
+
+#ifndef EVENT_ARCHIVE_H
+#define EVENT_ARCHIVE_H
+
+#include <set>
+#include <string>
+#include "Rtypes.h"
+#include "TFile.h"
+#include "TTree.h"
+
+/**
+ * @class EventArchive
+ * @brief Converts PLUTO files to the archive format and back.
+ */
+class EventArchive {
+public:
+    EventArchive();
+
+    /**
+     * Writes the events of a PLUTO file to an archive file.
+     *
+     * @param input PLUTO file with the "data" tree.
+     * @param output Archive file; written under a temporary name.
+     * @param compression ROOT compression settings of the archive.
+     * @param single_precision Store the momenta as Float_t.
+     * @return false if a file cannot be read or written or the events
+     *         cannot be archived.
+     */
+    Bool_t archive(const std::string& input, const std::string& output,
+                   Int_t compression, Bool_t single_precision);
+
+    /**
+     * Writes the PLUTO file of an archive, with its event counts and
+     * acceptance. Other trees of the archive are not needed by WMC and
+     * are not written.
+     *
+     * @param input Archive file.
+     * @param output PLUTO file; written under a temporary name.
+     * @return false if a file cannot be read or written.
+     */
+    Bool_t restore(const std::string& input, const std::string& output);
+
+    /**
+     * Checks whether a ROOT file is an archive.
+     */
+    static Bool_t isArchive(const std::string& path);
+
+    /// Compression of the "archive" output profile of the generators.
+    static Int_t defaultCompression();
+
+private:
+    void bookParticles(TTree* tree, Bool_t single_precision);
+    Bool_t attachParticles(TTree* tree);
+    static void copyObjects(TFile* input, TFile* output,
+                            const std::set<std::string>& skip, Bool_t trees);
+
+    // Current particle: px, py, pz, e in double or single precision
+    Double_t momentum_[4];
+    Float_t momentum_float_[4];
+    Bool_t single_precision_;
+    Int_t pid_;
+
+    // Current event
+    Long64_t end_;
+    Int_t accepted_;
+    Int_t channel_;
+};
+
+#endif // EVENT_ARCHIVE_H
@@ -0,0 +1,102 @@
+/**
+ * @file archive_events.cpp
+ * @author AK <alex.nuclearboy@gmail.com>
+ * @brief Converts PLUTO files of the generators to the archive format.
+ *
+ * Usage: archive_events [--float] [--compression N] <PLUTO file> <archive>
+ *
+ * The events of the "data" tree are written as flat particle columns with
+ * an event index (see event_archive.h); all other objects of the file are
+ * copied. --float stores the momenta in single precision, --compression
+ * sets the ROOT compression settings (100 * algorithm + level, default:
+ * those of the "archive" output profile). An existing archive is not
+ * overwritten.
+ *
+ * If the PLUTO file is listed in the event catalogue of its directory, the
+ * archive is recorded with the same events, seed, model and reaction in
+ * the catalogue of its own directory, as tree "events".
+ *
+ * @date 2026-10-18
+ *
+ * @note Distributed under the GNU General Public License version 3.0 (GPLv3).
+ */
+
+#include "event_archive.h"
+#include "event_catalogue.h"
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+
+/**
+ * @brief Records the archive of a catalogued PLUTO file.
+ */
+void recordArchive(const std::string& input, const std::string& output)
+{
+    std::string catalogue_path = EventCatalogue::catalogueOf(input);
+    if (access(catalogue_path.c_str(), F_OK) != 0) return;
+    EventCatalogue catalogue;
+    if (!catalogue.load(catalogue_path)) return;
+
+    struct stat info;
+    std::string file = input.substr(input.find_last_of('/') + 1);
+    const std::vector<EventCatalogue::Entry>& entries = catalogue.entries();
+    for (size_t i = 0; i < entries.size(); ++i) {
+        // Only the description of the file as it is now is taken over
+        if (entries[i].file != file || entries[i].tree != "data" ||
+            stat(input.c_str(), &info) != 0 || info.st_size != entries[i].bytes) {
+            continue;
+        }
+        EventCatalogue::Entry entry = entries[i];
+        entry.tree = "events";
+        EventCatalogue::record(output, entry);
+        return;
+    }
+}
+
+Int_t main(Int_t argc, char** argv)
+{
+    Bool_t single_precision = false;
+    Int_t compression = EventArchive::defaultCompression();
+    std::vector<std::string> files;
+    Bool_t valid = true;
+    for (Int_t i = 1; i < argc && valid; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--float") {
+            single_precision = true;
+        } else if (arg.compare(0, 2, "--") != 0) {
+            files.push_back(arg);
+        } else if (arg == "--compression" && i + 1 < argc) {
+            compression = atoi(argv[++i]);
+            valid = compression >= 0;
+        } else {
+            valid = false;
+        }
+    }
+    if (!valid || files.size() != 2) {
+        std::cerr << "Usage: " << argv[0] << " [--float] [--compression N]"
+                  << " <PLUTO file> <archive>" << std::endl;
+        return 1;
+    }
+    if (access(files[1].c_str(), F_OK) == 0) {
+        std::cerr << files[1] << " exists, it is not overwritten." << std::endl;
+        return 1;
+    }
+
+    EventArchive archive;
+    if (!archive.archive(files[0], files[1], compression, single_precision)) {
+        return 1;
+    }
+    recordArchive(files[0], files[1]);
+
+    struct stat input, output;
+    if (stat(files[0].c_str(), &input) == 0 && stat(files[1].c_str(), &output) == 0 &&
+        input.st_size > 0) {
+        std::cout << "Size: " << input.st_size / 1024 << " kB -> "
+                  << output.st_size / 1024 << " kB ("
+                  << 100.0 * output.st_size / input.st_size << " %)" << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,328 @@
+/**
+ * @file event_archive.cpp
+ * @author AK <alex.nuclearboy@gmail.com>
+ * @brief Implementation of the EventArchive class.
+ *
+ * @date 2026-10-18
+ *
+ * @note Distributed under the GNU General Public License version 3.0 (GPLv3).
+ */
+
+#include "event_archive.h"
+#include <cstdio>
+#include <iostream>
+#include <unistd.h>
+#include "PParticle.h"
+#include "RVersion.h"
+#include "TClonesArray.h"
+#include "TKey.h"
+#include "TLeaf.h"
+#include "TList.h"
+#include "TParameter.h"
+
+namespace {
+    // Compression algorithms of ROOT (ROOT::ECompressionAlgorithm)
+    const Int_t LZMA = 2;
+    const Int_t ZSTD = 5;
+
+    // Baskets and clusters of the "archive" output profile
+    const Int_t BASKET_SIZE = 1024000;
+    const Long64_t CLUSTER_BYTES = -100000000;
+
+    const char* MOMENTUM[4] = { "px", "py", "pz", "e" };
+}
+
+EventArchive::EventArchive()
+    : single_precision_(false), pid_(0), end_(0), accepted_(1), channel_(0)
+{
+    for (Int_t k = 0; k < 4; ++k) {
+        momentum_[k] = 0;
+        momentum_float_[k] = 0;
+    }
+}
+
+Int_t EventArchive::defaultCompression()
+{
+#if ROOT_VERSION_CODE >= ROOT_VERSION(6,20,0)
+    return 100 * ZSTD + 9;
+#else
+    return 100 * LZMA + 8;
+#endif
+}
+
+void EventArchive::bookParticles(TTree* tree, Bool_t single_precision)
+{
+    single_precision_ = single_precision;
+    for (Int_t k = 0; k < 4; ++k) {
+        std::string leaf = std::string(MOMENTUM[k]) + (single_precision ? "/F" : "/D");
+        if (single_precision) {
+            tree->Branch(MOMENTUM[k], &momentum_float_[k], leaf.c_str());
+        } else {
+            tree->Branch(MOMENTUM[k], &momentum_[k], leaf.c_str());
+        }
+    }
+    tree->Branch("pid", &pid_, "pid/I");
+    tree->SetBasketSize("*", BASKET_SIZE);
+    tree->SetAutoFlush(CLUSTER_BYTES);
+}
+
+Bool_t EventArchive::attachParticles(TTree* tree)
+{
+    TLeaf* leaf = tree->GetLeaf(MOMENTUM[0]);
+    if (leaf == NULL || tree->GetBranch("pid") == NULL) return false;
+    single_precision_ = (std::string(leaf->GetTypeName()) == "Float_t");
+    for (Int_t k = 0; k < 4; ++k) {
+        if (single_precision_) {
+            tree->SetBranchAddress(MOMENTUM[k], &momentum_float_[k]);
+        } else {
+            tree->SetBranchAddress(MOMENTUM[k], &momentum_[k]);
+        }
+    }
+    tree->SetBranchAddress("pid", &pid_);
+    return true;
+}
+
+void EventArchive::copyObjects(TFile* input, TFile* output,
+                               const std::set<std::string>& skip,
+                               Bool_t trees)
+{
+    // The keys are listed with the highest cycle of each name first
+    std::set<std::string> copied;
+    TIter next(input->GetListOfKeys());
+    TKey* key;
+    while ((key = static_cast<TKey*>(next()))) {
+        std::string name = key->GetName();
+        if (skip.count(name) || copied.count(name)) continue;
+        copied.insert(name);
+
+        Bool_t tree = (std::string(key->GetClassName()) == "TTree");
+        if (tree && !trees) continue;
+        TObject* object = key->ReadObj();
+        output->cd();
+        if (tree) {
+            // Baskets are copied without being decompressed
+            static_cast<TTree*>(object)->CloneTree(-1, "fast")->Write();
+        } else {
+            object->Write(name.c_str());
+            delete object;
+        }
+    }
+}
+
+Bool_t EventArchive::archive(const std::string& input,
+                             const std::string& output, Int_t compression,
+                             Bool_t single_precision)
+{
+    TFile* in = TFile::Open(input.c_str(), "READ");
+    TTree* data = NULL;
+    if (in != NULL && !in->IsZombie()) in->GetObject("data", data);
+    if (data == NULL) {
+        std::cerr << "No PLUTO tree in " << input << std::endl;
+        delete in;
+        return false;
+    }
+    Float_t impact = 0, phi = 0;
+    TClonesArray* particles = NULL;
+    data->SetBranchAddress("Impact", &impact);
+    data->SetBranchAddress("Phi", &phi);
+    data->SetBranchAddress("Particles", &particles);
+    Bool_t with_accepted = (data->GetBranch("Accepted") != NULL);
+    Bool_t with_channel = (data->GetBranch("Channel") != NULL);
+    if (with_accepted) data->SetBranchAddress("Accepted", &accepted_);
+    if (with_channel) data->SetBranchAddress("Channel", &channel_);
+
+    // Written under a temporary name, so that no partial archive is left
+    std::string tmp_path = output + ".tmp";
+    TFile out(tmp_path.c_str(), "RECREATE");
+    if (!out.IsOpen()) {
+        std::cerr << "Failed to open file: " << tmp_path << std::endl;
+        delete in;
+        return false;
+    }
+    out.SetCompressionSettings(compression);
+    TTree* particle_tree = new TTree("particles", "Archived particles");
+    bookParticles(particle_tree, single_precision);
+    TTree* event_tree = new TTree("events", "Archived events");
+    event_tree->Branch("end", &end_, "end/L");
+    if (with_accepted) event_tree->Branch("Accepted", &accepted_, "Accepted/I");
+    if (with_channel) event_tree->Branch("Channel", &channel_, "Channel/I");
+
+    Long64_t entries = data->GetEntries();
+    Float_t impact0 = 0, phi0 = 0;
+    Bool_t ok = true;
+    end_ = 0;
+    for (Long64_t entry = 0; ok && entry < entries; ++entry) {
+        data->GetEntry(entry);
+        if (entry == 0) {
+            impact0 = impact;
+            phi0 = phi;
+        } else if (impact != impact0 || phi != phi0) {
+            std::cerr << "Event " << entry << " of " << input << " has another"
+                      << " Impact or Phi than the first one." << std::endl;
+            ok = false;
+        }
+
+        Int_t npart = particles->GetEntriesFast();
+        for (Int_t i = 0; ok && i < npart; ++i) {
+            PParticle* particle = static_cast<PParticle*>(particles->At(i));
+            if (particle->W() != 1 || particle->getVertex().Mag() != 0) {
+                std::cerr << "Particle " << i << " of event " << entry << " of "
+                          << input << " has a vertex or weight, which are not"
+                          << " archived." << std::endl;
+                ok = false;
+                break;
+            }
+            pid_ = particle->ID();
+            momentum_[0] = particle->Px();
+            momentum_[1] = particle->Py();
+            momentum_[2] = particle->Pz();
+            momentum_[3] = particle->E();
+            for (Int_t k = 0; k < 4; ++k) momentum_float_[k] = momentum_[k];
+            particle_tree->Fill();
+            ++end_;
+        }
+        event_tree->Fill();
+    }
+    if (!ok) {
+        out.Close();
+        unlink(tmp_path.c_str());
+        delete in;
+        return false;
+    }
+
+    out.cd();
+    particle_tree->Write();
+    event_tree->Write();
+    TParameter<Float_t>("Impact", impact0).Write();
+    TParameter<Float_t>("Phi", phi0).Write();
+    std::set<std::string> skip;
+    skip.insert("data");
+    copyObjects(in, &out, skip, true);
+    out.Close();
+    delete in;
+
+    if (rename(tmp_path.c_str(), output.c_str()) != 0) {
+        std::cerr << "Failed to write " << output << std::endl;
+        return false;
+    }
+    std::cout << entries << " events, " << end_ << " particles archived in "
+              << output << std::endl;
+    return true;
+}
+
+Bool_t EventArchive::restore(const std::string& input,
+                             const std::string& output)
+{
+    TFile* in = TFile::Open(input.c_str(), "READ");
+    TTree* particle_tree = NULL;
+    TTree* event_tree = NULL;
+    TParameter<Float_t>* impact = NULL;
+    TParameter<Float_t>* phi = NULL;
+    if (in != NULL && !in->IsZombie()) {
+        in->GetObject("particles", particle_tree);
+        in->GetObject("events", event_tree);
+        in->GetObject("Impact", impact);
+        in->GetObject("Phi", phi);
+    }
+    if (particle_tree == NULL || event_tree == NULL || impact == NULL ||
+        phi == NULL || !attachParticles(particle_tree)) {
+        std::cerr << "No event archive in " << input << std::endl;
+        delete in;
+        return false;
+    }
+    event_tree->SetBranchAddress("end", &end_);
+    Bool_t with_accepted = (event_tree->GetBranch("Accepted") != NULL);
+    Bool_t with_channel = (event_tree->GetBranch("Channel") != NULL);
+    if (with_accepted) event_tree->SetBranchAddress("Accepted", &accepted_);
+    if (with_channel) event_tree->SetBranchAddress("Channel", &channel_);
+
+    // Written under a temporary name, so that WMC never sees a partial file
+    std::string tmp_path = output + ".tmp";
+    TFile out(tmp_path.c_str(), "RECREATE");
+    if (!out.IsOpen()) {
+        std::cerr << "Failed to open file: " << tmp_path << std::endl;
+        delete in;
+        return false;
+    }
+
+    // The branches of the PLUTO trees written by the generators
+    Int_t npart = 0;
+    Float_t impact_value = impact->GetVal();
+    Float_t phi_value = phi->GetVal();
+    TClonesArray* particles = new TClonesArray("PParticle", 8);
+    TTree* data = new TTree("data", "Particles Tree");
+    data->Branch("Npart", &npart, "Npart/I");
+    data->Branch("Impact", &impact_value, "Impact/F");
+    data->Branch("Phi", &phi_value, "Phi/F");
+    data->Branch("Particles", &particles);
+    if (with_channel) data->Branch("Channel", &channel_, "Channel/I");
+    if (with_accepted) data->Branch("Accepted", &accepted_, "Accepted/I");
+
+    Long64_t events = event_tree->GetEntries();
+    Long64_t total = particle_tree->GetEntries();
+    Long64_t begin = 0;
+    Bool_t ok = true;
+    for (Long64_t entry = 0; entry < events; ++entry) {
+        event_tree->GetEntry(entry);
+        if (end_ < begin || end_ > total) {
+            std::cerr << "Invalid particle index of event " << entry << " in "
+                      << input << std::endl;
+            ok = false;
+            break;
+        }
+        particles->Clear();
+        npart = static_cast<Int_t>(end_ - begin);
+        for (Int_t i = 0; i < npart; ++i) {
+            particle_tree->GetEntry(begin + i);
+            if (single_precision_) {
+                for (Int_t k = 0; k < 4; ++k) momentum_[k] = momentum_float_[k];
+            }
+            // The stored energy keeps the four-momentum as generated
+            PParticle* particle = new ((*particles)[i]) PParticle(
+                pid_, momentum_[0], momentum_[1], momentum_[2]);
+            particle->SetPxPyPzE(momentum_[0], momentum_[1], momentum_[2],
+                                 momentum_[3]);
+        }
+        data->Fill();
+        begin = end_;
+    }
+    if (ok && begin != total) {
+        std::cerr << input << " has " << total - begin << " particles not"
+                  << " belonging to an event." << std::endl;
+        ok = false;
+    }
+    if (!ok) {
+        out.Close();
+        unlink(tmp_path.c_str());
+        delete in;
+        return false;
+    }
+
+    out.cd();
+    data->Write();
+    std::set<std::string> skip;
+    skip.insert("particles");
+    skip.insert("events");
+    skip.insert("Impact");
+    skip.insert("Phi");
+    copyObjects(in, &out, skip, false);
+    out.Close();
+    delete in;
+
+    if (rename(tmp_path.c_str(), output.c_str()) != 0) {
+        std::cerr << "Failed to write " << output << std::endl;
+        return false;
+    }
+    std::cout << events << " events restored to " << output << std::endl;
+    return true;
+}
+
+Bool_t EventArchive::isArchive(const std::string& path)
+{
+    TFile* file = TFile::Open(path.c_str(), "READ");
+    Bool_t archive = file != NULL && !file->IsZombie() &&
+                     file->Get("particles") != NULL &&
+                     file->Get("events") != NULL;
+    delete file;
+    return archive;
+}
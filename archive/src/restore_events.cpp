@@ -0,0 +1,42 @@
+/**
+ * @file restore_events.cpp
+ * @author AK <alex.nuclearboy@gmail.com>
+ * @brief Writes the PLUTO file of an event archive for WMC.
+ *
+ * Usage: restore_events <archive> <PLUTO file>
+ *        restore_events --check <file>
+ *
+ * The "data" tree read by the KINE 50 card of WMC is rebuilt from the
+ * archive (see event_archive.h), together with the event counts and the
+ * acceptance. The PLUTO file is written under a temporary name and renamed
+ * when complete. --check exits with 0 if the file is an archive and with 1
+ * otherwise; the WMC scripts use it to convert archived inputs only.
+ *
+ * @date 2026-10-18
+ *
+ * @note Distributed under the GNU General Public License version 3.0 (GPLv3).
+ */
+
+#include "event_archive.h"
+#include <iostream>
+#include <string>
+#include "TStopwatch.h"
+
+Int_t main(Int_t argc, char** argv)
+{
+    if (argc == 3 && std::string(argv[1]) == "--check") {
+        return EventArchive::isArchive(argv[2]) ? 0 : 1;
+    }
+    if (argc != 3 || argv[1][0] == '-') {
+        std::cerr << "Usage: " << argv[0] << " <archive> <PLUTO file>\n"
+                  << "       " << argv[0] << " --check <file>" << std::endl;
+        return 1;
+    }
+
+    TStopwatch timer;
+    EventArchive archive;
+    if (!archive.restore(argv[1], argv[2])) return 1;
+    timer.Stop();
+    std::cout << "Restored in " << timer.RealTime() << " s" << std::endl;
+    return 0;
+}
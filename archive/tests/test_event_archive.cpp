@@ -0,0 +1,171 @@
+/**
+ * @file test_event_archive.cpp
+ * @author AK <alex.nuclearboy@gmail.com>
+ * @brief Archive and restore test of EventArchive on a small PLUTO file.
+ *
+ * Usage: test_event_archive [directory]
+ *
+ * Writes a PLUTO file of random events (with Accepted, Channel and an event
+ * count), archives it in double and in single precision and restores both
+ * archives. The restored events must equal the original ones bit by bit,
+ * and in single precision up to the rounding of the momenta to Float_t.
+ * A file with a weighted particle must not be archived. Exits with 0 if
+ * all checks pass.
+ *
+ * @date 2026-10-18
+ *
+ * @note Distributed under the GNU General Public License version 3.0 (GPLv3).
+ */
+
+#include "event_archive.h"
+#include <iostream>
+#include <string>
+#include <unistd.h>
+#include "PParticle.h"
+#include "TClonesArray.h"
+#include "TParameter.h"
+#include "TRandom3.h"
+#include "test_check.h"
+
+namespace {
+
+const Long64_t EVENTS = 2000;
+const Long64_t COUNT = 123456;      // Event count object copied unchanged
+
+/// Writes a PLUTO tree as the generators do; weighted - last particle has W = 2.
+Bool_t writePluto(const std::string& path, Bool_t weighted)
+{
+    TFile file(path.c_str(), "RECREATE");
+    if (!file.IsOpen()) return false;
+    Int_t npart = 0, accepted = 0, channel = 0;
+    Float_t impact = 0, phi = 0;
+    TClonesArray* particles = new TClonesArray("PParticle", 8);
+    TTree* data = new TTree("data", "Particles Tree");
+    data->Branch("Npart", &npart, "Npart/I");
+    data->Branch("Impact", &impact, "Impact/F");
+    data->Branch("Phi", &phi, "Phi/F");
+    data->Branch("Particles", &particles);
+    data->Branch("Channel", &channel, "Channel/I");
+    data->Branch("Accepted", &accepted, "Accepted/I");
+
+    TRandom3 random(4357);
+    const Int_t ids[] = { 14, 13, 8, 9, 7 };    // p, n, pi+, pi-, pi0
+    const Double_t masses[] = { 0.938272, 0.939565, 0.139570, 0.139570, 0.134977 };
+    for (Long64_t entry = 0; entry < EVENTS; ++entry) {
+        particles->Clear();
+        npart = 1 + static_cast<Int_t>(random.Uniform(0, 5));
+        for (Int_t i = 0; i < npart; ++i) {
+            Int_t k = static_cast<Int_t>(random.Uniform(0, 5));
+            PParticle* particle = new ((*particles)[i]) PParticle(
+                ids[k], random.Uniform(-1, 1), random.Uniform(-1, 1),
+                random.Uniform(0, 3), masses[k]);
+            if (weighted && entry == EVENTS - 1 && i == npart - 1) {
+                particle->SetW(2);
+            }
+        }
+        accepted = static_cast<Int_t>(random.Uniform(0, 2));
+        channel = static_cast<Int_t>(random.Uniform(0, 10));
+        data->Fill();
+    }
+    data->Write();
+    TParameter<Long64_t>("events_count", COUNT).Write();
+    file.Close();
+    return true;
+}
+
+/// Compares the events of a restored PLUTO file with the original ones.
+Bool_t compare(const std::string& original, const std::string& restored,
+               Bool_t single_precision)
+{
+    TFile first(original.c_str(), "READ");
+    TFile second(restored.c_str(), "READ");
+    TTree* trees[2] = { NULL, NULL };
+    first.GetObject("data", trees[0]);
+    second.GetObject("data", trees[1]);
+    TParameter<Long64_t>* count = NULL;
+    second.GetObject("events_count", count);
+    if (!trees[0] || !trees[1] || !count || count->GetVal() != COUNT ||
+        trees[1]->GetEntries() != EVENTS) {
+        std::cerr << restored << " lacks events or the event count" << std::endl;
+        return false;
+    }
+
+    Int_t npart[2], accepted[2], channel[2];
+    Float_t impact[2], phi[2];
+    TClonesArray* particles[2] = { NULL, NULL };
+    for (Int_t f = 0; f < 2; ++f) {
+        trees[f]->SetBranchAddress("Npart", &npart[f]);
+        trees[f]->SetBranchAddress("Impact", &impact[f]);
+        trees[f]->SetBranchAddress("Phi", &phi[f]);
+        trees[f]->SetBranchAddress("Particles", &particles[f]);
+        trees[f]->SetBranchAddress("Accepted", &accepted[f]);
+        trees[f]->SetBranchAddress("Channel", &channel[f]);
+    }
+    for (Long64_t entry = 0; entry < EVENTS; ++entry) {
+        trees[0]->GetEntry(entry);
+        trees[1]->GetEntry(entry);
+        Bool_t equal = npart[0] == npart[1] && impact[0] == impact[1] &&
+                       phi[0] == phi[1] && accepted[0] == accepted[1] &&
+                       channel[0] == channel[1] &&
+                       particles[1]->GetEntriesFast() == npart[0];
+        for (Int_t i = 0; equal && i < npart[0]; ++i) {
+            PParticle* a = static_cast<PParticle*>(particles[0]->At(i));
+            PParticle* b = static_cast<PParticle*>(particles[1]->At(i));
+            Double_t expected[4] = { a->Px(), a->Py(), a->Pz(), a->E() };
+            Double_t values[4] = { b->Px(), b->Py(), b->Pz(), b->E() };
+            equal = a->ID() == b->ID() && b->W() == 1;
+            for (Int_t k = 0; k < 4; ++k) {
+                if (single_precision) {
+                    expected[k] = static_cast<Float_t>(expected[k]);
+                }
+                equal = equal && expected[k] == values[k];
+            }
+        }
+        if (!equal) {
+            std::cerr << "Event " << entry << " of " << restored
+                      << " differs from the original" << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+Int_t main(Int_t argc, char** argv)
+{
+    std::string directory = argc > 1 ? argv[1] : ".";
+    std::string pluto = directory + "/test_archive_pluto.root";
+    std::string weighted = directory + "/test_archive_weighted.root";
+    std::string archived = directory + "/test_archive_archived.root";
+    std::string restored = directory + "/test_archive_restored.root";
+    if (!writePluto(pluto, false) || !writePluto(weighted, true)) {
+        std::cerr << "Failed to write the PLUTO files" << std::endl;
+        return 1;
+    }
+
+    EventArchive archive;
+    const Bool_t precisions[] = { false, true };
+    for (Int_t p = 0; p < 2; ++p) {
+        std::string name = precisions[p] ? "single precision" : "double precision";
+        Bool_t written = archive.archive(pluto, archived,
+                                         EventArchive::defaultCompression(),
+                                         precisions[p]);
+        check(written && EventArchive::isArchive(archived) &&
+              !EventArchive::isArchive(pluto), "archive in " + name);
+        check(written && archive.restore(archived, restored) &&
+              compare(pluto, restored, precisions[p]), "restore in " + name);
+        unlink(archived.c_str());
+        unlink(restored.c_str());
+    }
+
+    check(!archive.archive(weighted, archived, EventArchive::defaultCompression(),
+                           false) &&
+          access(archived.c_str(), F_OK) != 0 &&
+          access((archived + ".tmp").c_str(), F_OK) != 0,
+          "weighted particle not archived");
+
+    unlink(pluto.c_str());
+    unlink(weighted.c_str());
+    return testResult();
+}
@@ -0,0 +1,82 @@
+/**
+ * @file fast_simulation.h
+ * @author AK <alex.nuclearboy@gmail.com>
+ * @brief Parametrised detector simulation of PLUTO files.
+ *
+ * The fast simulation replaces WMC for acceptance and resolution studies.
+ * It works in three stages per event:
+ * 1. the final-state particles are read from the PLUTO "data" tree written
+ *    by the generators (pluto_run, run_simulate, the bound-state macro);
+ * 2. every particle is assigned to a detector by the acceptance windows of
+ *    the setup, and reconstructed and smeared with the efficiency and
+ *    resolution tables of that detector (SmearingTables);
+ * 3. the reconstructed particles are written to the "fastsim" tree.
+ *
+ * The output tree holds per event the number of generated (Npart) and
+ * reconstructed (Nrec) particles and, for the reconstructed ones, the
+ * PLUTO code (pid), the detector index (names in the Detectors object of
+ * the file), the reconstructed and the generated momentum [GeV/c], polar
+ * and azimuthal angle [rad]. The event counts of an acceptance prefilter
+ * (EventsGenerated, EventsAccepted) are copied from the input.
+ *
+ * @date 2026-10-18
+ *
+ * @note Distributed under the GNU General Public License version 3.0 (GPLv3).
+ */
+
+#ifndef FAST_SIMULATION_H
+#define FAST_SIMULATION_H
+
+#include "acceptance_filter.h"
+#include "smearing_tables.h"
+#include <string>
+#include <vector>
+#include "Rtypes.h"
+#include "TRandom3.h"
+#include "TTree.h"
+
+/**
+ * @class FastSimulation
+ * @brief Smears the events of PLUTO files with tabulated detector response.
+ */
+class FastSimulation {
+public:
+    /**
+     * @param acceptance Acceptance windows assigning the detectors.
+     * @param tables Efficiency and resolution tables of the detectors.
+     * @param seed Seed of the random number generator (0 - clock).
+     */
+    FastSimulation(const AcceptanceFilter& acceptance, SmearingTables& tables,
+                   UInt_t seed);
+
+    /**
+     * Simulates all events of a PLUTO file.
+     *
+     * @param input PLUTO file with the "data" tree.
+     * @param output ROOT file receiving the "fastsim" tree.
+     * @return false if a file cannot be read or written.
+     */
+    Bool_t process(const std::string& input, const std::string& output);
+
+private:
+    void book(TTree* tree);
+    void clear();
+
+    const AcceptanceFilter& acceptance_;
+    SmearingTables& tables_;
+    TRandom3 rng_;
+
+    // Output of the current event
+    Int_t npart_;
+    Int_t nrec_;
+    std::vector<Int_t> pid_;
+    std::vector<Int_t> detector_;
+    std::vector<Double_t> p_;
+    std::vector<Double_t> theta_;
+    std::vector<Double_t> phi_;
+    std::vector<Double_t> p_true_;
+    std::vector<Double_t> theta_true_;
+    std::vector<Double_t> phi_true_;
+};
+
+#endif // FAST_SIMULATION_H
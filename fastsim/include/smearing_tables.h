@@ -0,0 +1,98 @@
+/**
+ * @file smearing_tables.h
+ * @author AK <alex.nuclearboy@gmail.com>
+ * @brief Efficiency and resolution tables of the fast detector simulation.
+ *
+ * The tables are two-dimensional histograms in the LAB polar angle [deg]
+ * (x axis) and momentum [GeV/c] (y axis) of the generated particle, one set
+ * per detector and particle type, named <detector>_<particle>_<quantity>:
+ * - efficiency:     probability to reconstruct the particle;
+ * - theta_bias,
+ *   theta_sigma:    mean and RMS of the polar angle error [deg];
+ * - phi_sigma:      RMS of the azimuthal angle error [deg];
+ * - momentum_bias,
+ *   momentum_sigma: mean and RMS of the relative momentum error.
+ * They are built from WMC runs by fastsim_calibrate (TableBuilder).
+ *
+ * @date 2026-10-18
+ *
+ * @note Distributed under the GNU General Public License version 3.0 (GPLv3).
+ */
+
+#ifndef SMEARING_TABLES_H
+#define SMEARING_TABLES_H
+
+#include <map>
+#include <set>
+#include <string>
+#include "Rtypes.h"
+#include "TFile.h"
+#include "TH2D.h"
+#include "TRandom.h"
+#include "TVector3.h"
+
+/**
+ * @class SmearingTables
+ * @brief Looks up the tables of a detector and particle type and smears
+ *        the momentum of a particle accordingly.
+ */
+class SmearingTables {
+public:
+    /// Quantities tabulated for every detector and particle type.
+    enum Quantity {
+        kEfficiency, kThetaBias, kThetaSigma, kPhiSigma,
+        kMomentumBias, kMomentumSigma, kNumQuantities
+    };
+
+    SmearingTables();
+    ~SmearingTables();
+
+    /**
+     * Opens the table file written by fastsim_calibrate.
+     *
+     * @return false if the file cannot be read.
+     */
+    bool load(const std::string& path);
+
+    /**
+     * Decides with the efficiency table whether a particle is reconstructed
+     * and smears its momentum vector with the resolution tables.
+     *
+     * @param detector Detector holding the particle (acceptance window).
+     * @param particle PLUTO name of the particle.
+     * @param momentum Generated LAB momentum [GeV/c].
+     * @param rng Random number generator.
+     * @param smeared Reconstructed momentum, set if the particle is seen.
+     * @return true if the particle is reconstructed. Particles without
+     *         tables are never reconstructed (a warning is printed once).
+     */
+    bool smear(const std::string& detector, const std::string& particle,
+               const TVector3& momentum, TRandom& rng, TVector3& smeared);
+
+    /**
+     * Name of the table of a quantity, e.g. "FD_p_efficiency".
+     */
+    static std::string tableName(const std::string& detector,
+                                 const std::string& particle,
+                                 Quantity quantity);
+
+    /**
+     * PLUTO name of a particle from its PLUTO (GEANT) code, or an empty
+     * string if the particle is not known.
+     */
+    static std::string particleName(Int_t pid);
+
+private:
+    struct Table {
+        TH2D* histograms[kNumQuantities];
+    };
+
+    /// Tables of a detector and particle, NULL if they are missing.
+    const Table* find(const std::string& detector, const std::string& particle);
+
+    TFile* file_;
+    std::map<std::string, Table> tables_;
+    std::set<std::string> missing_;
+};
+
+#endif // SMEARING_TABLES_H
@@ -0,0 +1,92 @@
+/**
+ * @file table_builder.h
+ * @author AK <alex.nuclearboy@gmail.com>
+ * @brief Builds the tables of the fast detector simulation from WMC runs.
+ *
+ * The input are the generated particles of WMC runs matched with their
+ * reconstruction, one entry per generated particle (see fastsim_calibrate).
+ * Every particle is assigned to a detector by the acceptance windows of the
+ * setup; per detector and particle type the builder counts the generated
+ * and reconstructed particles and accumulates the reconstruction errors in
+ * bins of the polar angle and momentum, from which the tables described in
+ * smearing_tables.h are computed.
+ *
+ * @date 2026-10-18
+ *
+ * @note Distributed under the GNU General Public License version 3.0 (GPLv3).
+ */
+
+#ifndef TABLE_BUILDER_H
+#define TABLE_BUILDER_H
+
+#include "acceptance_filter.h"
+#include <map>
+#include <string>
+#include "Rtypes.h"
+#include "TH2D.h"
+#include "TVector3.h"
+
+/**
+ * @class TableBuilder
+ * @brief Accumulates matched WMC particles and writes the smearing tables.
+ */
+class TableBuilder {
+public:
+    /**
+     * @param acceptance Acceptance windows assigning the detectors.
+     * @param theta_bins Number of polar angle bins from 0 to 180 deg.
+     * @param p_bins Number of momentum bins from 0 to p_max.
+     * @param p_max Upper edge of the momentum axis [GeV/c].
+     */
+    TableBuilder(const AcceptanceFilter& acceptance, Int_t theta_bins,
+                 Int_t p_bins, Double_t p_max);
+    ~TableBuilder();
+
+    /**
+     * Adds a generated particle.
+     *
+     * @param particle PLUTO name of the particle.
+     * @param generated Generated LAB momentum [GeV/c].
+     * @param reconstructed Reconstructed LAB momentum, ignored if the
+     *                      particle was not reconstructed.
+     * @param detected True if WMC and the reconstruction found the particle.
+     */
+    void add(const std::string& particle, const TVector3& generated,
+             const TVector3& reconstructed, Bool_t detected);
+
+    /**
+     * Computes the tables and writes them to path. The resolution of bins
+     * with fewer than min_entries reconstructed particles is replaced by
+     * the mean resolution of the detector and particle type.
+     *
+     * @return false if the file cannot be written or nothing was added.
+     */
+    Bool_t write(const std::string& path, Long64_t min_entries) const;
+
+private:
+    /// Reconstruction errors accumulated per bin.
+    enum Error { kTheta, kPhi, kMomentum, kNumErrors };
+
+    struct Sums {
+        std::string detector;
+        std::string particle;
+        TH2D* generated;
+        TH2D* detected;
+        TH2D* sum[kNumErrors];
+        TH2D* sum2[kNumErrors];
+        Double_t total[kNumErrors];     ///< Over all bins.
+        Double_t total2[kNumErrors];
+        Double_t total_detected;
+    };
+
+    Sums& sums(const std::string& detector, const std::string& particle);
+    TH2D* book(const std::string& name) const;
+
+    const AcceptanceFilter& acceptance_;
+    Int_t theta_bins_;
+    Int_t p_bins_;
+    Double_t p_max_;
+    std::map<std::string, Sums> sums_;     ///< Per <detector>_<particle>.
+};
+
+#endif // TABLE_BUILDER_H
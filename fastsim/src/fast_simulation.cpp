@@ -0,0 +1,132 @@
+/**
+ * @file fast_simulation.cpp
+ * @author AK <alex.nuclearboy@gmail.com>
+ * @brief Implementation of the FastSimulation class.
+ *
+ * @date 2026-10-18
+ *
+ * @note Distributed under the GNU General Public License version 3.0 (GPLv3).
+ */
+
+#include "fast_simulation.h"
+#include <iostream>
+#include "PParticle.h"
+#include "TClonesArray.h"
+#include "TFile.h"
+#include "TNamed.h"
+#include "TParameter.h"
+
+FastSimulation::FastSimulation(const AcceptanceFilter& acceptance,
+                               SmearingTables& tables, UInt_t seed)
+    : acceptance_(acceptance), tables_(tables), rng_(seed),
+      npart_(0), nrec_(0) {}
+
+void FastSimulation::book(TTree* tree)
+{
+    tree->Branch("Npart", &npart_, "Npart/I");
+    tree->Branch("Nrec", &nrec_, "Nrec/I");
+    tree->Branch("pid", &pid_);
+    tree->Branch("detector", &detector_);
+    tree->Branch("p", &p_);
+    tree->Branch("theta", &theta_);
+    tree->Branch("phi", &phi_);
+    tree->Branch("p_true", &p_true_);
+    tree->Branch("theta_true", &theta_true_);
+    tree->Branch("phi_true", &phi_true_);
+}
+
+void FastSimulation::clear()
+{
+    pid_.clear();
+    detector_.clear();
+    p_.clear();
+    theta_.clear();
+    phi_.clear();
+    p_true_.clear();
+    theta_true_.clear();
+    phi_true_.clear();
+}
+
+Bool_t FastSimulation::process(const std::string& input,
+                               const std::string& output)
+{
+    // Stage 1: the PLUTO tree of the generators
+    TFile* in = TFile::Open(input.c_str(), "READ");
+    TTree* data = NULL;
+    if (in != NULL && !in->IsZombie()) in->GetObject("data", data);
+    if (data == NULL) {
+        std::cerr << "No PLUTO tree in " << input << std::endl;
+        delete in;
+        return false;
+    }
+    TClonesArray* particles = NULL;
+    data->SetBranchAddress("Particles", &particles);
+
+    TFile out(output.c_str(), "RECREATE");
+    if (!out.IsOpen()) {
+        std::cerr << "Failed to open file: " << output << std::endl;
+        delete in;
+        return false;
+    }
+    TTree* tree = new TTree("fastsim", "Fast detector simulation");
+    book(tree);
+
+    const std::vector<std::string>& detectors = acceptance_.detectors();
+    Long64_t entries = data->GetEntries();
+    Long64_t reconstructed = 0;
+    for (Long64_t entry = 0; entry < entries; ++entry) {
+        data->GetEntry(entry);
+        clear();
+        npart_ = particles->GetEntriesFast();
+
+        // Stage 2: detector assignment, efficiency and smearing
+        for (Int_t i = 0; i < npart_; ++i) {
+            PParticle* particle = static_cast<PParticle*>(particles->At(i));
+            std::string name = SmearingTables::particleName(particle->ID());
+            TVector3 momentum = particle->Vect();
+            Int_t detector = acceptance_.detectorIndex(name, momentum);
+            if (detector < 0) continue;
+
+            TVector3 smeared;
+            if (!tables_.smear(detectors[detector], name, momentum, rng_,
+                               smeared)) {
+                continue;
+            }
+            pid_.push_back(particle->ID());
+            detector_.push_back(detector);
+            p_.push_back(smeared.Mag());
+            theta_.push_back(smeared.Theta());
+            phi_.push_back(smeared.Phi());
+            p_true_.push_back(momentum.Mag());
+            theta_true_.push_back(momentum.Theta());
+            phi_true_.push_back(momentum.Phi());
+        }
+        nrec_ = static_cast<Int_t>(pid_.size());
+        reconstructed += nrec_;
+
+        // Stage 3: the reconstructed particles
+        tree->Fill();
+    }
+
+    // Detector names and the normalisation of a prefiltered input
+    std::string names;
+    for (size_t i = 0; i < detectors.size(); ++i) {
+        names += (i > 0 ? " " : "") + detectors[i];
+    }
+    TParameter<Long64_t>* generated = NULL;
+    TParameter<Long64_t>* accepted = NULL;
+    in->GetObject("EventsGenerated", generated);
+    in->GetObject("EventsAccepted", accepted);
+
+    out.cd();
+    tree->Write();
+    TNamed("Detectors", names.c_str()).Write();
+    if (generated != NULL) generated->Write();
+    if (accepted != NULL) accepted->Write();
+    out.Close();
+    delete in;
+
+    std::cout << entries << " events, " << reconstructed
+              << " reconstructed particles written to " << output << std::endl;
+    return true;
+}
@@ -0,0 +1,139 @@
+/**
+ * @file fastsim_calibrate.cpp
+ * @brief Builds the tables of the fast detector simulation from WMC runs.
+ *
+ * Usage: fastsim_calibrate --acceptance FILE [--theta-bins N] [--p-bins N]
+ *                          [--p-max P] [--min-entries N]
+ *                          <tables file> <matched file>...
+ *
+ * The matched files hold the tree "wmc_match" with one entry per generated
+ * particle of a WMC run, written by the analysis of the run (the .ems
+ * output can only be reconstructed there):
+ * - pid/I                          PLUTO (GEANT) particle code;
+ * - p_true/D, theta_true/D,
+ *   phi_true/D                     generated LAB momentum [GeV/c] and
+ *                                  angles [rad];
+ * - detected/I                     1 if the particle was reconstructed;
+ * - p_rec/D, theta_rec/D,
+ *   phi_rec/D                      reconstructed momentum and angles.
+ * The tables are binned in 2 deg polar angle and 50 MeV/c momentum bins
+ * up to 2 GeV/c by default; bins with fewer than --min-entries (default:
+ * 20) reconstructed particles take the mean resolution of the detector.
+ *
+ * @date 2026-10-18
+ *
+ * @note Distributed under the GNU General Public License version 3.0 (GPLv3).
+ */
+
+#include "acceptance_filter.h"
+#include "smearing_tables.h"
+#include "table_builder.h"
+#include <cstdlib>
+#include <iostream>
+#include <set>
+#include <string>
+#include <vector>
+#include "TFile.h"
+#include "TTree.h"
+#include "TVector3.h"
+
+/**
+ * @brief Adds the matched particles of a file to the builder.
+ *
+ * @return false if the file holds no wmc_match tree.
+ */
+Bool_t addFile(const std::string& path, TableBuilder& builder,
+               std::set<Int_t>& unknown)
+{
+    TFile* file = TFile::Open(path.c_str(), "READ");
+    TTree* tree = NULL;
+    if (file != NULL && !file->IsZombie()) file->GetObject("wmc_match", tree);
+    if (tree == NULL) {
+        std::cerr << "No wmc_match tree in " << path << std::endl;
+        delete file;
+        return false;
+    }
+
+    Int_t pid = 0, detected = 0;
+    Double_t p_true = 0, theta_true = 0, phi_true = 0;
+    Double_t p_rec = 0, theta_rec = 0, phi_rec = 0;
+    tree->SetBranchAddress("pid", &pid);
+    tree->SetBranchAddress("p_true", &p_true);
+    tree->SetBranchAddress("theta_true", &theta_true);
+    tree->SetBranchAddress("phi_true", &phi_true);
+    tree->SetBranchAddress("detected", &detected);
+    tree->SetBranchAddress("p_rec", &p_rec);
+    tree->SetBranchAddress("theta_rec", &theta_rec);
+    tree->SetBranchAddress("phi_rec", &phi_rec);
+
+    Long64_t entries = tree->GetEntries();
+    for (Long64_t entry = 0; entry < entries; ++entry) {
+        tree->GetEntry(entry);
+        std::string name = SmearingTables::particleName(pid);
+        if (name.empty()) {
+            if (unknown.insert(pid).second) {
+                std::cerr << "Unknown particle code " << pid
+                          << ", such particles are skipped." << std::endl;
+            }
+            continue;
+        }
+        TVector3 generated, reconstructed;
+        generated.SetMagThetaPhi(p_true, theta_true, phi_true);
+        reconstructed.SetMagThetaPhi(p_rec, theta_rec, phi_rec);
+        builder.add(name, generated, reconstructed, detected != 0);
+    }
+    std::cout << entries << " particles read from " << path << std::endl;
+    delete file;
+    return true;
+}
+
+Int_t main(Int_t argc, char** argv)
+{
+    std::string acceptance_file;
+    Int_t theta_bins = 90;
+    Int_t p_bins = 40;
+    Double_t p_max = 2.0;
+    Long64_t min_entries = 20;
+    std::vector<std::string> files;
+    Bool_t valid = true;
+    for (Int_t i = 1; i < argc && valid; ++i) {
+        std::string arg = argv[i];
+        if (arg.compare(0, 2, "--") != 0) {
+            files.push_back(arg);
+            continue;
+        }
+        if (i + 1 >= argc) {
+            valid = false;
+        } else if (arg == "--acceptance") {
+            acceptance_file = argv[++i];
+        } else if (arg == "--theta-bins") {
+            theta_bins = atoi(argv[++i]);
+        } else if (arg == "--p-bins") {
+            p_bins = atoi(argv[++i]);
+        } else if (arg == "--p-max") {
+            p_max = atof(argv[++i]);
+        } else if (arg == "--min-entries") {
+            min_entries = atoll(argv[++i]);
+        } else {
+            valid = false;
+        }
+    }
+    if (!valid || acceptance_file.empty() || files.size() < 2 ||
+        theta_bins <= 0 || p_bins <= 0 || p_max <= 0) {
+        std::cerr << "Usage: " << argv[0] << " --acceptance FILE"
+                  << " [--theta-bins N] [--p-bins N] [--p-max P]"
+                  << " [--min-entries N] <tables file> <matched file>..."
+                  << std::endl;
+        return 1;
+    }
+
+    AcceptanceFilter acceptance;
+    if (!acceptance.load(acceptance_file)) return 1;
+
+    TableBuilder builder(acceptance, theta_bins, p_bins, p_max);
+    std::set<Int_t> unknown;
+    for (size_t i = 1; i < files.size(); ++i) {
+        if (!addFile(files[i], builder, unknown)) return 1;
+    }
+    return builder.write(files[0], min_entries) ? 0 : 1;
+}
@@ -0,0 +1,92 @@
+/**
+ * @file fastsim_run.cpp
+ * @brief Runs the fast detector simulation on PLUTO files.
+ *
+ * Usage: fastsim_run --tables FILE --acceptance FILE [--seed S]
+ *                    [--output DIR] <PLUTO file>...
+ *
+ * Every PLUTO file <name>.root is simulated into <name>.fast.root, written
+ * to DIR (default: the directory of the PLUTO file). The tables are built
+ * by fastsim_calibrate with the same acceptance file.
+ *
+ * @date 2026-10-18
+ *
+ * @note Distributed under the GNU General Public License version 3.0 (GPLv3).
+ */
+
+#include "acceptance_filter.h"
+#include "fast_simulation.h"
+#include "smearing_tables.h"
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Output file of a PLUTO file: <name>.fast.root in output_dir, or
+ *        next to the input if output_dir is empty.
+ */
+std::string outputPath(const std::string& input, const std::string& output_dir)
+{
+    std::string::size_type slash = input.find_last_of('/');
+    std::string name = (slash == std::string::npos) ? input : input.substr(slash + 1);
+    std::string dir = (slash == std::string::npos) ? "." : input.substr(0, slash);
+    if (!output_dir.empty()) dir = output_dir;
+    std::string::size_type dot = name.rfind(".root");
+    if (dot != std::string::npos) name = name.substr(0, dot);
+    return dir + "/" + name + ".fast.root";
+}
+
+Int_t main(Int_t argc, char** argv)
+{
+    std::string tables_file, acceptance_file, output_dir;
+    UInt_t seed = 0;
+    std::vector<std::string> inputs;
+    Bool_t valid = true;
+    for (Int_t i = 1; i < argc && valid; ++i) {
+        std::string arg = argv[i];
+        if (arg.compare(0, 2, "--") != 0) {
+            inputs.push_back(arg);
+            continue;
+        }
+        if (i + 1 >= argc) {
+            valid = false;
+        } else if (arg == "--tables") {
+            tables_file = argv[++i];
+        } else if (arg == "--acceptance") {
+            acceptance_file = argv[++i];
+        } else if (arg == "--seed") {
+            seed = static_cast<UInt_t>(strtoul(argv[++i], NULL, 10));
+        } else if (arg == "--output") {
+            output_dir = argv[++i];
+        } else {
+            valid = false;
+        }
+    }
+    if (!valid || tables_file.empty() || acceptance_file.empty() ||
+        inputs.empty()) {
+        std::cerr << "Usage: " << argv[0] << " --tables FILE --acceptance FILE"
+                  << " [--seed S] [--output DIR] <PLUTO file>..." << std::endl;
+        return 1;
+    }
+
+    AcceptanceFilter acceptance;
+    SmearingTables tables;
+    if (!acceptance.load(acceptance_file) || !tables.load(tables_file)) {
+        return 1;
+    }
+
+    FastSimulation simulation(acceptance, tables, seed);
+    Int_t failed = 0;
+    for (size_t i = 0; i < inputs.size(); ++i) {
+        if (!simulation.process(inputs[i], outputPath(inputs[i], output_dir))) {
+            ++failed;
+        }
+    }
+    if (failed > 0) {
+        std::cerr << failed << " of " << inputs.size()
+                  << " file(s) could not be simulated." << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,137 @@
+/**
+ * @file smearing_tables.cpp
+ * @author AK <alex.nuclearboy@gmail.com>
+ * @brief Implementation of the SmearingTables class of the fast detector
+ *        simulation.
+ *
+ * @date 2026-10-18
+ *
+ * @note Distributed under the GNU General Public License version 3.0 (GPLv3).
+ */
+
+#include "smearing_tables.h"
+#include <iostream>
+#include "TMath.h"
+
+namespace {
+
+const char* quantity_names[SmearingTables::kNumQuantities] = {
+    "efficiency", "theta_bias", "theta_sigma", "phi_sigma",
+    "momentum_bias", "momentum_sigma"
+};
+
+// Content of the bin holding (theta, p), 0 outside the table
+Double_t lookup(const TH2D* histogram, Double_t theta, Double_t p)
+{
+    Int_t x = histogram->GetXaxis()->FindFixBin(theta);
+    Int_t y = histogram->GetYaxis()->FindFixBin(p);
+    if (x < 1 || x > histogram->GetNbinsX() ||
+        y < 1 || y > histogram->GetNbinsY()) {
+        return 0.;
+    }
+    return histogram->GetBinContent(x, y);
+}
+
+}  // namespace
+
+SmearingTables::SmearingTables() : file_(NULL) {}
+
+SmearingTables::~SmearingTables()
+{
+    delete file_;   // Also deletes the histograms read from the file
+}
+
+bool SmearingTables::load(const std::string& path)
+{
+    delete file_;
+    tables_.clear();
+    missing_.clear();
+    file_ = TFile::Open(path.c_str(), "READ");
+    if (file_ == NULL || file_->IsZombie()) {
+        std::cerr << "Failed to open smearing tables: " << path << std::endl;
+        delete file_;
+        file_ = NULL;
+        return false;
+    }
+    return true;
+}
+
+std::string SmearingTables::tableName(const std::string& detector,
+                                      const std::string& particle,
+                                      Quantity quantity)
+{
+    return detector + "_" + particle + "_" + quantity_names[quantity];
+}
+
+std::string SmearingTables::particleName(Int_t pid)
+{
+    switch (pid) {
+        case 1:  return "g";
+        case 2:  return "e+";
+        case 3:  return "e-";
+        case 7:  return "pi0";
+        case 8:  return "pi+";
+        case 9:  return "pi-";
+        case 13: return "n";
+        case 14: return "p";
+        case 17: return "eta";
+        case 45: return "d";
+        case 46: return "t";
+        case 47: return "alpha";
+        case 49: return "He3";
+        default: return "";
+    }
+}
+
+const SmearingTables::Table* SmearingTables::find(
+    const std::string& detector, const std::string& particle)
+{
+    std::string key = detector + "_" + particle;
+    std::map<std::string, Table>::const_iterator it = tables_.find(key);
+    if (it != tables_.end()) return &it->second;
+    if (missing_.count(key) > 0 || file_ == NULL) return NULL;
+
+    Table table;
+    for (Int_t q = 0; q < kNumQuantities; ++q) {
+        table.histograms[q] = NULL;
+        file_->GetObject(tableName(detector, particle,
+                                   static_cast<Quantity>(q)).c_str(),
+                         table.histograms[q]);
+        if (table.histograms[q] == NULL) {
+            std::cerr << "No smearing tables for " << particle << " in "
+                      << detector << ", the particle is never reconstructed."
+                      << std::endl;
+            missing_.insert(key);
+            return NULL;
+        }
+    }
+    return &(tables_[key] = table);
+}
+
+bool SmearingTables::smear(const std::string& detector,
+                           const std::string& particle,
+                           const TVector3& momentum, TRandom& rng,
+                           TVector3& smeared)
+{
+    const Table* table = find(detector, particle);
+    if (table == NULL) return false;
+
+    Double_t p = momentum.Mag();
+    Double_t theta = momentum.Theta() * TMath::RadToDeg();
+    TH2D* const* h = table->histograms;
+    if (rng.Rndm() >= lookup(h[kEfficiency], theta, p)) return false;
+
+    Double_t theta_rec = theta + rng.Gaus(lookup(h[kThetaBias], theta, p),
+                                          lookup(h[kThetaSigma], theta, p));
+    Double_t phi_rec = momentum.Phi() * TMath::RadToDeg()
+                       + rng.Gaus(0., lookup(h[kPhiSigma], theta, p));
+    Double_t p_rec = p * (1. + rng.Gaus(lookup(h[kMomentumBias], theta, p),
+                                        lookup(h[kMomentumSigma], theta, p)));
+    if (theta_rec < 0) theta_rec = -theta_rec;
+    if (theta_rec > 180) theta_rec = 360 - theta_rec;
+    if (p_rec < 0) p_rec = 0;
+
+    smeared.SetMagThetaPhi(p_rec, theta_rec * TMath::DegToRad(),
+                           phi_rec * TMath::DegToRad());
+    return true;
+}
@@ -0,0 +1,170 @@
+/**
+ * @file table_builder.cpp
+ * @author AK <alex.nuclearboy@gmail.com>
+ * @brief Implementation of the TableBuilder class of the fast detector
+ *        simulation.
+ *
+ * @date 2026-10-18
+ *
+ * @note Distributed under the GNU General Public License version 3.0 (GPLv3).
+ */
+
+#include "table_builder.h"
+#include "smearing_tables.h"
+#include <iostream>
+#include "TFile.h"
+#include "TMath.h"
+
+TableBuilder::TableBuilder(const AcceptanceFilter& acceptance,
+                           Int_t theta_bins, Int_t p_bins, Double_t p_max)
+    : acceptance_(acceptance), theta_bins_(theta_bins), p_bins_(p_bins),
+      p_max_(p_max) {}
+
+TableBuilder::~TableBuilder()
+{
+    std::map<std::string, Sums>::iterator it;
+    for (it = sums_.begin(); it != sums_.end(); ++it) {
+        delete it->second.generated;
+        delete it->second.detected;
+        for (Int_t e = 0; e < kNumErrors; ++e) {
+            delete it->second.sum[e];
+            delete it->second.sum2[e];
+        }
+    }
+}
+
+TH2D* TableBuilder::book(const std::string& name) const
+{
+    TH2D* histogram = new TH2D(name.c_str(), name.c_str(), theta_bins_, 0., 180.,
+                               p_bins_, 0., p_max_);
+    histogram->SetDirectory(NULL);
+    histogram->GetXaxis()->SetTitle("#theta [deg]");
+    histogram->GetYaxis()->SetTitle("p [GeV/c]");
+    return histogram;
+}
+
+TableBuilder::Sums& TableBuilder::sums(const std::string& detector,
+                                       const std::string& particle)
+{
+    std::string key = detector + "_" + particle;
+    std::map<std::string, Sums>::iterator it = sums_.find(key);
+    if (it != sums_.end()) return it->second;
+
+    Sums& s = sums_[key];
+    s.detector = detector;
+    s.particle = particle;
+    s.generated = book(key + "_generated");
+    s.detected = book(key + "_detected");
+    const char* names[kNumErrors] = { "theta", "phi", "momentum" };
+    for (Int_t e = 0; e < kNumErrors; ++e) {
+        s.sum[e] = book(key + "_sum_" + names[e]);
+        s.sum2[e] = book(key + "_sum2_" + names[e]);
+        s.total[e] = s.total2[e] = 0;
+    }
+    s.total_detected = 0;
+    return s;
+}
+
+void TableBuilder::add(const std::string& particle, const TVector3& generated,
+                       const TVector3& reconstructed, Bool_t detected)
+{
+    Int_t detector = acceptance_.detectorIndex(particle, generated);
+    if (detector < 0) return;   // Outside the acceptance, never seen
+
+    Sums& s = sums(acceptance_.detectors()[detector], particle);
+    Double_t theta = generated.Theta() * TMath::RadToDeg();
+    Double_t p = generated.Mag();
+    s.generated->Fill(theta, p);
+    if (!detected) return;
+
+    // Errors of the polar and azimuthal angle [deg] and relative momentum
+    Double_t dphi = (reconstructed.Phi() - generated.Phi()) * TMath::RadToDeg();
+    if (dphi > 180) dphi -= 360;
+    if (dphi < -180) dphi += 360;
+    Double_t errors[kNumErrors] = {
+        reconstructed.Theta() * TMath::RadToDeg() - theta,
+        dphi,
+        reconstructed.Mag() / p - 1.
+    };
+    s.detected->Fill(theta, p);
+    for (Int_t e = 0; e < kNumErrors; ++e) {
+        s.sum[e]->Fill(theta, p, errors[e]);
+        s.sum2[e]->Fill(theta, p, errors[e] * errors[e]);
+        s.total[e] += errors[e];
+        s.total2[e] += errors[e] * errors[e];
+    }
+    s.total_detected += 1;
+}
+
+Bool_t TableBuilder::write(const std::string& path, Long64_t min_entries) const
+{
+    if (sums_.empty()) {
+        std::cerr << "No particles inside the acceptance windows." << std::endl;
+        return false;
+    }
+    TFile file(path.c_str(), "RECREATE");
+    if (!file.IsOpen()) {
+        std::cerr << "Failed to open file: " << path << std::endl;
+        return false;
+    }
+
+    std::map<std::string, Sums>::const_iterator it;
+    for (it = sums_.begin(); it != sums_.end(); ++it) {
+        const Sums& s = it->second;
+
+        // Mean resolution of the detector, used for sparsely filled bins
+        Double_t mean[kNumErrors], rms[kNumErrors];
+        for (Int_t e = 0; e < kNumErrors; ++e) {
+            Double_t n = TMath::Max(s.total_detected, 1.);
+            mean[e] = s.total[e] / n;
+            rms[e] = TMath::Sqrt(TMath::Max(s.total2[e] / n - mean[e] * mean[e], 0.));
+        }
+
+        TH2D* tables[SmearingTables::kNumQuantities];
+        for (Int_t q = 0; q < SmearingTables::kNumQuantities; ++q) {
+            tables[q] = book(SmearingTables::tableName(s.detector, s.particle,
+                static_cast<SmearingTables::Quantity>(q)));
+        }
+        for (Int_t x = 1; x <= theta_bins_; ++x) {
+            for (Int_t y = 1; y <= p_bins_; ++y) {
+                Double_t generated = s.generated->GetBinContent(x, y);
+                Double_t detected = s.detected->GetBinContent(x, y);
+                if (generated > 0) {
+                    tables[SmearingTables::kEfficiency]->SetBinContent(
+                        x, y, detected / generated);
+                }
+                Double_t bin_mean[kNumErrors], bin_rms[kNumErrors];
+                for (Int_t e = 0; e < kNumErrors; ++e) {
+                    if (detected < min_entries || detected <= 0) {
+                        bin_mean[e] = mean[e];
+                        bin_rms[e] = rms[e];
+                        continue;
+                    }
+                    bin_mean[e] = s.sum[e]->GetBinContent(x, y) / detected;
+                    bin_rms[e] = TMath::Sqrt(TMath::Max(
+                        s.sum2[e]->GetBinContent(x, y) / detected
+                        - bin_mean[e] * bin_mean[e], 0.));
+                }
+                tables[SmearingTables::kThetaBias]->SetBinContent(x, y, bin_mean[kTheta]);
+                tables[SmearingTables::kThetaSigma]->SetBinContent(x, y, bin_rms[kTheta]);
+                tables[SmearingTables::kPhiSigma]->SetBinContent(x, y, bin_rms[kPhi]);
+                tables[SmearingTables::kMomentumBias]->SetBinContent(x, y, bin_mean[kMomentum]);
+                tables[SmearingTables::kMomentumSigma]->SetBinContent(x, y, bin_rms[kMomentum]);
+            }
+        }
+        file.cd();
+        for (Int_t q = 0; q < SmearingTables::kNumQuantities; ++q) {
+            tables[q]->Write();
+            delete tables[q];
+        }
+
+        std::cout << it->first << ": " << static_cast<Long64_t>(s.total_detected)
+                  << " reconstructed particles, resolution "
+                  << rms[kTheta] << " deg (theta), " << rms[kPhi]
+                  << " deg (phi), " << 100 * rms[kMomentum] << " % (p)"
+                  << std::endl;
+    }
+    file.Close();
+    std::cout << "Smearing tables written to " << path << std::endl;
+    return true;
+}
@@ -0,0 +1,73 @@
+/**
+ * @file file_summary.h
+ * @author AK <alex.nuclearboy@gmail.com>
+ * @brief Contents of a ROOT output file checked before it is merged.
+ *
+ * The outputs of the generators (PLUTO files, calculated values, histogram
+ * files) are merged with the trees copied basket by basket. This only gives
+ * a usable file if every input has the same trees with the same branches,
+ * and the same objects that cannot be added (e.g. the "Acceptance" label,
+ * of which the merged file keeps one). A summary records per file:
+ * - the trees with their number of entries and their schema (name, type
+ *   and title of every leaf);
+ * - the event counts (TParameter<Long64_t>, e.g. EventsGenerated,
+ *   EventsAccepted, EventsFilled), which are added by the merge;
+ * - the labels (TNamed) and the class of every other object;
+ * - the compression settings, which must agree for the baskets to be
+ *   copied without recompression.
+ *
+ * @date 2026-10-18
+ *
+ * @note Distributed under the GNU General Public License version 3.0 (GPLv3).
+ */
+
+#ifndef FILE_SUMMARY_H
+#define FILE_SUMMARY_H
+
+#include <map>
+#include <string>
+#include "Rtypes.h"
+
+/**
+ * @class FileSummary
+ * @brief Trees, event counts and other objects of a ROOT file.
+ */
+class FileSummary {
+public:
+    struct Tree {
+        Long64_t entries;
+        std::string schema;     ///< One line per leaf: name, type and title.
+    };
+
+    FileSummary() : compression_(-1) {}
+
+    /**
+     * Reads the summary of a file; the file is closed again.
+     *
+     * @return false if the file cannot be read.
+     */
+    Bool_t read(const std::string& path);
+
+    /**
+     * Checks that the file can be merged with reference, printing every
+     * difference.
+     *
+     * @return false if the trees, their branches or the objects differ.
+     */
+    Bool_t matches(const FileSummary& reference) const;
+
+    const std::string& path() const { return path_; }
+    Int_t compression() const { return compression_; }
+    const std::map<std::string, Tree>& trees() const { return trees_; }
+    const std::map<std::string, Long64_t>& counts() const { return counts_; }
+
+private:
+    std::string path_;
+    Int_t compression_;
+    std::map<std::string, Tree> trees_;
+    std::map<std::string, Long64_t> counts_;
+    std::map<std::string, std::string> labels_;     ///< Name -> title.
+    std::map<std::string, std::string> objects_;    ///< Name -> class.
+};
+
+#endif // FILE_SUMMARY_H
@@ -0,0 +1,71 @@
+/**
+ * @file parallel_merger.h
+ * @author AK <alex.nuclearboy@gmail.com>
+ * @brief Merges ROOT files as a tree of merges run in parallel processes.
+ *
+ * Every merge copies the baskets of the trees without decompressing them
+ * (TFileMerger with the fast method, as hadd), adds histograms and event
+ * counts and keeps one copy of other objects. The inputs are split into
+ * groups of at most fan_in files, each merged by a child process into a
+ * temporary file next to the output, with up to jobs processes at a time;
+ * the temporary files are merged the same way until one group is left,
+ * which is merged into the output. The default fan-in makes two levels for
+ * any number of files: jobs parallel merges and the final one.
+ *
+ * The merged file has the compression settings given to merge(); inputs
+ * with other settings are recompressed, which is much slower.
+ *
+ * @date 2026-10-18
+ *
+ * @note Distributed under the GNU General Public License version 3.0 (GPLv3).
+ */
+
+#ifndef PARALLEL_MERGER_H
+#define PARALLEL_MERGER_H
+
+#include <string>
+#include <vector>
+#include "Rtypes.h"
+
+/**
+ * @class ParallelMerger
+ * @brief Tree of fast merges run in forked processes.
+ */
+class ParallelMerger {
+public:
+    /**
+     * @param jobs Maximum number of merges run at a time.
+     * @param fan_in Maximum number of files per merge (0 - chosen from the
+     *               number of inputs and jobs).
+     */
+    ParallelMerger(Int_t jobs, Int_t fan_in) : jobs_(jobs), fan_in_(fan_in) {}
+
+    /**
+     * Merges the inputs into output through a temporary file and a rename.
+     * No ROOT file may be open in the calling process (the merges are run
+     * in forked processes).
+     *
+     * @return false if a merge failed; no output is written then.
+     */
+    Bool_t merge(const std::vector<std::string>& inputs,
+                 const std::string& output, Int_t compression) const;
+
+    /**
+     * Merges files in the current process.
+     */
+    static Bool_t mergeGroup(const std::vector<std::string>& inputs,
+                             const std::string& output, Int_t compression);
+
+private:
+    /**
+     * Runs the merges of one level, up to jobs_ at a time.
+     */
+    Bool_t runLevel(const std::vector<std::vector<std::string> >& groups,
+                    const std::vector<std::string>& outputs,
+                    Int_t compression) const;
+
+    Int_t jobs_;
+    Int_t fan_in_;
+};
+
+#endif // PARALLEL_MERGER_H
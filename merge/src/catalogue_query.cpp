@@ -0,0 +1,127 @@
+/**
+ * @file catalogue_query.cpp
+ * @author AK <alex.nuclearboy@gmail.com>
+ * @brief Finds the files and tree entries holding a selection of events.
+ *
+ * Usage: catalogue_query [--tree T] [--reaction R] [--model M]
+ *                        [--geometry G] [--seed S] [--events FIRST:LAST]
+ *                        [--verify] <catalogue or directory>...
+ *
+ * The event catalogues (see event_catalogue.h; for a directory its
+ * events.catalogue) are searched for the files of the given tree, reaction
+ * (e.g. "pd -> p d"), model, geometry and seed holding generated events of
+ * the range [FIRST, LAST) of their run. One line is printed per file:
+ *
+ *     <path> <tree> <first entry> <number of entries>
+ *
+ * separated by tabs, e.g. as event ranges of chunked WMC jobs. Files with
+ * dropped events are listed whole. --verify compares the size and the MD5
+ * checksum of the selected files with the catalogue.
+ *
+ * @date 2026-10-18
+ *
+ * @note Distributed under the GNU General Public License version 3.0 (GPLv3).
+ */
+
+#include "event_catalogue.h"
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <sys/stat.h>
+#include <vector>
+#include "TMD5.h"
+
+/**
+ * @brief Checks that a file has the size and checksum of its catalogue
+ *        entry.
+ */
+Bool_t verify(const std::string& path, const EventCatalogue::Entry& entry)
+{
+    struct stat info;
+    if (stat(path.c_str(), &info) != 0) {
+        std::cerr << path << ": missing" << std::endl;
+        return false;
+    }
+    if (info.st_size != entry.bytes) {
+        std::cerr << path << ": " << info.st_size << " bytes, "
+                  << entry.bytes << " catalogued" << std::endl;
+        return false;
+    }
+    TMD5* checksum = TMD5::FileChecksum(path.c_str());
+    Bool_t valid = checksum && entry.md5 == checksum->AsString();
+    if (!valid) std::cerr << path << ": checksum differs" << std::endl;
+    delete checksum;
+    return valid;
+}
+
+Int_t main(Int_t argc, char** argv)
+{
+    EventCatalogue::Query query;
+    Bool_t check = false;
+    std::vector<std::string> catalogues;
+    Bool_t valid = true;
+    for (Int_t i = 1; i < argc && valid; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--verify") {
+            check = true;
+            continue;
+        }
+        if (arg.compare(0, 2, "--") != 0) {
+            catalogues.push_back(arg);
+            continue;
+        }
+        if (i + 1 >= argc) {
+            valid = false;
+        } else if (arg == "--tree") {
+            query.tree = argv[++i];
+        } else if (arg == "--reaction") {
+            query.reaction = argv[++i];
+        } else if (arg == "--model") {
+            query.model = argv[++i];
+        } else if (arg == "--geometry") {
+            query.geometry = argv[++i];
+        } else if (arg == "--seed") {
+            query.seed = strtoul(argv[++i], NULL, 10);
+        } else if (arg == "--events") {
+            valid = sscanf(argv[++i], "%lld:%lld", &query.first_event,
+                           &query.last_event) == 2 &&
+                    query.first_event >= 0 &&
+                    query.last_event > query.first_event;
+        } else {
+            valid = false;
+        }
+    }
+    if (!valid || catalogues.empty()) {
+        std::cerr << "Usage: " << argv[0] << " [--tree T] [--reaction R]"
+                  << " [--model M] [--geometry G] [--seed S]"
+                  << " [--events FIRST:LAST] [--verify]"
+                  << " <catalogue or directory>..." << std::endl;
+        return 1;
+    }
+
+    EventCatalogue catalogue;
+    for (size_t i = 0; i < catalogues.size(); ++i) {
+        struct stat info;
+        std::string path = catalogues[i];
+        if (stat(path.c_str(), &info) == 0 && S_ISDIR(info.st_mode)) {
+            path += "/events.catalogue";
+        }
+        if (!catalogue.load(path)) return 1;
+    }
+
+    std::vector<EventCatalogue::Range> ranges = catalogue.query(query);
+    Int_t failed = 0;
+    for (size_t i = 0; i < ranges.size(); ++i) {
+        const EventCatalogue::Range& range = ranges[i];
+        std::cout << range.path << "\t" << range.tree << "\t"
+                  << range.first_entry << "\t" << range.entries << std::endl;
+    }
+    for (size_t i = 0; check && i < ranges.size(); ++i) {
+        if (!verify(ranges[i].path, catalogue.entries()[ranges[i].index])) {
+            ++failed;
+        }
+    }
+    if (ranges.empty()) std::cerr << "No catalogued events selected." << std::endl;
+    return (ranges.empty() || failed > 0) ? 1 : 0;
+}
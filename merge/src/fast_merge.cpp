@@ -0,0 +1,190 @@
+/**
+ * @file fast_merge.cpp
+ * @author AK <alex.nuclearboy@gmail.com>
+ * @brief Merges the per-iteration and per-shard outputs of the generators.
+ *
+ * Usage: fast_merge [-j N] [--fan-in N] <output> <input>...
+ *
+ * The inputs (e.g. pd-<reaction>-1.root ... pd-<reaction>-10.root, or
+ * data_ppn_spec-<model>-<n>.root) are checked to have the same trees,
+ * branches and labels, and merged with their baskets copied as they are
+ * (see parallel_merger.h) by up to N processes (-j, default: the number of
+ * processors). The merged file keeps the compression of the first input.
+ *
+ * The entries of every tree and the event counts (EventsGenerated,
+ * EventsAccepted, EventsFilled) of the merged file are checked against the
+ * sums over the inputs and written to the manifest <output>.manifest, a
+ * tab-separated table with one line per input and the totals.
+ *
+ * @date 2026-10-18
+ *
+ * @note Distributed under the GNU General Public License version 3.0 (GPLv3).
+ */
+
+#include "file_summary.h"
+#include "parallel_merger.h"
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <string>
+#include <unistd.h>
+#include <vector>
+#include "TStopwatch.h"
+
+/**
+ * @brief Writes the event-count manifest of a merge through a temporary
+ *        file and a rename.
+ */
+Bool_t writeManifest(const std::string& path,
+                     const std::vector<FileSummary>& inputs,
+                     const FileSummary& merged)
+{
+    std::string tmp_path = path + ".tmp";
+    std::ofstream out(tmp_path.c_str());
+    if (!out.is_open()) {
+        std::cerr << "Failed to write manifest: " << tmp_path << std::endl;
+        return false;
+    }
+
+    typedef std::map<std::string, FileSummary::Tree> Trees;
+    typedef std::map<std::string, Long64_t> Counts;
+    out << "# Merged file: " << merged.path() << "\n"
+        << "# Compression: " << merged.compression() << "\n"
+        << "file";
+    for (Trees::const_iterator it = merged.trees().begin();
+         it != merged.trees().end(); ++it) {
+        out << "\t" << it->first;
+    }
+    for (Counts::const_iterator it = merged.counts().begin();
+         it != merged.counts().end(); ++it) {
+        out << "\t" << it->first;
+    }
+    out << "\n";
+
+    for (size_t i = 0; i <= inputs.size(); ++i) {
+        const FileSummary& summary = (i < inputs.size()) ? inputs[i] : merged;
+        out << (i < inputs.size() ? summary.path() : "total");
+        for (Trees::const_iterator it = summary.trees().begin();
+             it != summary.trees().end(); ++it) {
+            out << "\t" << it->second.entries;
+        }
+        for (Counts::const_iterator it = summary.counts().begin();
+             it != summary.counts().end(); ++it) {
+            out << "\t" << it->second;
+        }
+        out << "\n";
+    }
+    out.close();
+    if (out.fail() || rename(tmp_path.c_str(), path.c_str()) != 0) {
+        std::cerr << "Failed to write manifest: " << path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Checks the entries and event counts of the merged file against
+ *        the sums over the inputs.
+ */
+Bool_t checkTotals(const std::vector<FileSummary>& inputs,
+                   const FileSummary& merged)
+{
+    Bool_t ok = true;
+    typedef std::map<std::string, FileSummary::Tree> Trees;
+    for (Trees::const_iterator it = merged.trees().begin();
+         it != merged.trees().end(); ++it) {
+        Long64_t sum = 0;
+        for (size_t i = 0; i < inputs.size(); ++i) {
+            sum += inputs[i].trees().find(it->first)->second.entries;
+        }
+        if (sum != it->second.entries) {
+            std::cerr << "Tree " << it->first << " of " << merged.path()
+                      << " has " << it->second.entries << " entries, the "
+                      << "inputs " << sum << std::endl;
+            ok = false;
+        }
+    }
+    typedef std::map<std::string, Long64_t> Counts;
+    for (Counts::const_iterator it = merged.counts().begin();
+         it != merged.counts().end(); ++it) {
+        Long64_t sum = 0;
+        for (size_t i = 0; i < inputs.size(); ++i) {
+            sum += inputs[i].counts().find(it->first)->second;
+        }
+        if (sum != it->second) {
+            std::cerr << it->first << " of " << merged.path() << " is "
+                      << it->second << ", the sum of the inputs " << sum
+                      << std::endl;
+            ok = false;
+        }
+    }
+    return ok;
+}
+
+Int_t main(Int_t argc, char** argv)
+{
+    Int_t jobs = static_cast<Int_t>(sysconf(_SC_NPROCESSORS_ONLN));
+    Int_t fan_in = 0;
+    std::vector<std::string> files;
+    Bool_t valid = true;
+    for (Int_t i = 1; i < argc && valid; ++i) {
+        std::string arg = argv[i];
+        if (arg[0] != '-') {
+            files.push_back(arg);
+        } else if (i + 1 >= argc) {
+            valid = false;
+        } else if (arg == "-j") {
+            jobs = atoi(argv[++i]);
+            valid = jobs > 0;
+        } else if (arg == "--fan-in") {
+            fan_in = atoi(argv[++i]);
+            valid = fan_in >= 2;
+        } else {
+            valid = false;
+        }
+    }
+    if (!valid || files.size() < 2) {
+        std::cerr << "Usage: " << argv[0] << " [-j N] [--fan-in N] <output>"
+                  << " <input>..." << std::endl;
+        return 1;
+    }
+    if (jobs < 1) jobs = 1;
+    std::string output = files[0];
+    std::vector<std::string> inputs(files.begin() + 1, files.end());
+    if (access(output.c_str(), F_OK) == 0) {
+        std::cerr << output << " exists, it is not overwritten." << std::endl;
+        return 1;
+    }
+
+    // Every input is checked before anything is written
+    TStopwatch timer;
+    std::vector<FileSummary> summaries(inputs.size());
+    Int_t failed = 0;
+    for (size_t i = 0; i < inputs.size(); ++i) {
+        if (!summaries[i].read(inputs[i]) ||
+            (i > 0 && !summaries[i].matches(summaries[0]))) {
+            ++failed;
+        }
+    }
+    if (failed > 0) {
+        std::cerr << failed << " of " << inputs.size()
+                  << " input(s) cannot be merged." << std::endl;
+        return 1;
+    }
+
+    ParallelMerger merger(jobs, fan_in);
+    if (!merger.merge(inputs, output, summaries[0].compression())) return 1;
+
+    FileSummary merged;
+    if (!merged.read(output) || !checkTotals(summaries, merged) ||
+        !writeManifest(output + ".manifest", summaries, merged)) {
+        return 1;
+    }
+    timer.Stop();
+    std::cout << inputs.size() << " files merged into " << output << " in "
+              << timer.RealTime() << " s, manifest: " << output << ".manifest"
+              << std::endl;
+    return 0;
+}
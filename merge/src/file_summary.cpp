@@ -0,0 +1,139 @@
+/**
+ * @file file_summary.cpp
+ * @author AK <alex.nuclearboy@gmail.com>
+ * @brief Implementation of the FileSummary class.
+ *
+ * @date 2026-10-18
+ *
+ * @note Distributed under the GNU General Public License version 3.0 (GPLv3).
+ */
+
+#include "file_summary.h"
+#include <iostream>
+#include <sstream>
+#include "TFile.h"
+#include "TKey.h"
+#include "TLeaf.h"
+#include "TList.h"
+#include "TObjArray.h"
+#include "TParameter.h"
+#include "TTree.h"
+
+namespace {
+    /// Prints the keys of a that are missing from b.
+    template <class A, class B>
+    Bool_t reportMissing(const A& a, const B& b, const std::string& path,
+                         const char* what)
+    {
+        Bool_t complete = true;
+        for (typename A::const_iterator it = a.begin(); it != a.end(); ++it) {
+            if (b.find(it->first) == b.end()) {
+                std::cerr << path << ": " << what << " " << it->first
+                          << " missing" << std::endl;
+                complete = false;
+            }
+        }
+        return complete;
+    }
+}
+
+Bool_t FileSummary::read(const std::string& path)
+{
+    path_ = path;
+    trees_.clear();
+    counts_.clear();
+    labels_.clear();
+    objects_.clear();
+
+    TFile* file = TFile::Open(path.c_str(), "READ");
+    if (!file || file->IsZombie()) {
+        std::cerr << "Failed to open " << path << std::endl;
+        delete file;
+        return false;
+    }
+    compression_ = file->GetCompressionSettings();
+
+    // The keys are listed with the highest cycle of each name first
+    TIter next(file->GetListOfKeys());
+    TKey* key;
+    while ((key = static_cast<TKey*>(next()))) {
+        std::string name = key->GetName();
+        std::string class_name = key->GetClassName();
+        if (objects_.count(name)) continue;
+        objects_[name] = class_name;
+
+        if (class_name == "TTree") {
+            TTree* tree = static_cast<TTree*>(key->ReadObj());
+            Tree& summary = trees_[name];
+            summary.entries = tree->GetEntries();
+            std::ostringstream schema;
+            TObjArray* leaves = tree->GetListOfLeaves();
+            for (Int_t i = 0; i < leaves->GetEntriesFast(); ++i) {
+                TLeaf* leaf = static_cast<TLeaf*>(leaves->At(i));
+                schema << leaf->GetName() << " " << leaf->GetTypeName() << " "
+                       << leaf->GetTitle() << "\n";
+            }
+            summary.schema = schema.str();
+        } else if (class_name == "TParameter<Long64_t>") {
+            TParameter<Long64_t>* count =
+                static_cast<TParameter<Long64_t>*>(key->ReadObj());
+            counts_[name] = count->GetVal();
+            delete count;
+        } else if (class_name == "TNamed") {
+            TNamed* label = static_cast<TNamed*>(key->ReadObj());
+            labels_[name] = label->GetTitle();
+            delete label;
+        }
+    }
+    delete file;
+    return true;
+}
+
+Bool_t FileSummary::matches(const FileSummary& reference) const
+{
+    Bool_t compatible = reportMissing(reference.objects_, objects_, path_, "object");
+    compatible = reportMissing(objects_, reference.objects_, reference.path_,
+                               "object") && compatible;
+
+    for (std::map<std::string, std::string>::const_iterator it = objects_.begin();
+         it != objects_.end(); ++it) {
+        std::map<std::string, std::string>::const_iterator other =
+            reference.objects_.find(it->first);
+        if (other != reference.objects_.end() && other->second != it->second) {
+            std::cerr << path_ << ": " << it->first << " is a " << it->second
+                      << ", a " << other->second << " in " << reference.path_
+                      << std::endl;
+            compatible = false;
+        }
+    }
+    for (std::map<std::string, Tree>::const_iterator it = trees_.begin();
+         it != trees_.end(); ++it) {
+        std::map<std::string, Tree>::const_iterator other =
+            reference.trees_.find(it->first);
+        if (other != reference.trees_.end() &&
+            other->second.schema != it->second.schema) {
+            std::cerr << path_ << ": the branches of tree " << it->first
+                      << " differ from " << reference.path_ << std::endl;
+            compatible = false;
+        }
+    }
+    // The merged file keeps one of the labels
+    for (std::map<std::string, std::string>::const_iterator it = labels_.begin();
+         it != labels_.end(); ++it) {
+        std::map<std::string, std::string>::const_iterator other =
+            reference.labels_.find(it->first);
+        if (other != reference.labels_.end() && other->second != it->second) {
+            std::cerr << path_ << ": " << it->first << " \"" << it->second
+                      << "\" differs from \"" << other->second << "\" in "
+                      << reference.path_ << std::endl;
+            compatible = false;
+        }
+    }
+    if (compatible && compression_ != reference.compression_) {
+        std::cerr << "Warning: " << path_ << " has compression "
+                  << compression_ << ", " << reference.compression_ << " in "
+                  << reference.path_ << "; its baskets are recompressed"
+                  << std::endl;
+    }
+    return compatible;
+}
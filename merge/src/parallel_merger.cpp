@@ -0,0 +1,136 @@
+/**
+ * @file parallel_merger.cpp
+ * @author AK <alex.nuclearboy@gmail.com>
+ * @brief Implementation of the ParallelMerger class.
+ *
+ * @date 2026-10-18
+ *
+ * @note Distributed under the GNU General Public License version 3.0 (GPLv3).
+ */
+
+#include "parallel_merger.h"
+#include <cstdio>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "TFileMerger.h"
+#include "TMath.h"
+
+Bool_t ParallelMerger::mergeGroup(const std::vector<std::string>& inputs,
+                                  const std::string& output, Int_t compression)
+{
+    TFileMerger merger(kFALSE);
+    merger.SetFastMethod(kTRUE);
+    merger.SetPrintLevel(0);
+    if (!merger.OutputFile(output.c_str(), kTRUE, compression)) {
+        std::cerr << "Failed to open file: " << output << std::endl;
+        return false;
+    }
+    for (size_t i = 0; i < inputs.size(); ++i) {
+        if (!merger.AddFile(inputs[i].c_str(), kFALSE)) {
+            std::cerr << "Failed to open " << inputs[i] << std::endl;
+            return false;
+        }
+    }
+    if (!merger.Merge()) {
+        std::cerr << "Failed to merge into " << output << std::endl;
+        return false;
+    }
+    return true;
+}
+
+Bool_t ParallelMerger::runLevel(
+    const std::vector<std::vector<std::string> >& groups,
+    const std::vector<std::string>& outputs, Int_t compression) const
+{
+    std::map<pid_t, size_t> running;
+    size_t next = 0;
+    Bool_t ok = true;
+    while (running.size() > 0 || (ok && next < groups.size())) {
+        if (ok && next < groups.size() &&
+            running.size() < static_cast<size_t>(jobs_)) {
+            std::cout.flush();      // Not to be written again by the child
+            std::cerr.flush();
+            pid_t pid = fork();
+            if (pid < 0) {
+                std::cerr << "Failed to start a merge process." << std::endl;
+                ok = false;
+            } else if (pid == 0) {
+                _exit(mergeGroup(groups[next], outputs[next], compression) ? 0 : 1);
+            } else {
+                running[pid] = next++;
+            }
+            continue;
+        }
+
+        Int_t status;
+        pid_t pid = wait(&status);
+        if (pid < 0) return false;
+        std::map<pid_t, size_t>::iterator it = running.find(pid);
+        if (it == running.end()) continue;
+        if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+            std::cerr << "Merge into " << outputs[it->second] << " failed."
+                      << std::endl;
+            ok = false;
+        }
+        running.erase(it);
+    }
+    return ok;
+}
+
+Bool_t ParallelMerger::merge(const std::vector<std::string>& inputs,
+                             const std::string& output, Int_t compression) const
+{
+    if (inputs.empty()) return false;
+
+    // Two levels by default: one merge per job, then the final merge
+    Int_t size = static_cast<Int_t>(inputs.size());
+    Int_t jobs = jobs_ > 0 ? jobs_ : 1;
+    Int_t fan_in = fan_in_;
+    if (fan_in <= 0) {
+        fan_in = TMath::Max((size + jobs - 1) / jobs,
+            static_cast<Int_t>(TMath::Ceil(TMath::Sqrt(size))));
+    }
+    fan_in = TMath::Max(fan_in, 2);
+
+    std::vector<std::string> files = inputs;
+    std::vector<std::string> temporary;
+    Bool_t ok = true;
+    for (Int_t level = 1; ok && static_cast<Int_t>(files.size()) > fan_in; ++level) {
+        size = static_cast<Int_t>(files.size());
+        Int_t num_groups = (size + fan_in - 1) / fan_in;
+        std::vector<std::vector<std::string> > groups(num_groups);
+        std::vector<std::string> outputs(num_groups);
+        for (Int_t g = 0; g < num_groups; ++g) {
+            groups[g].assign(files.begin() + g * size / num_groups,
+                             files.begin() + (g + 1) * size / num_groups);
+            std::ostringstream path;
+            path << output << ".part-" << level << "-" << g;
+            outputs[g] = path.str();
+        }
+        std::cout << "Merge level " << level << ": " << size << " files into "
+                  << num_groups << " (" << jobs << " at a time)" << std::endl;
+        ok = runLevel(groups, outputs, compression);
+
+        // The files of the level before are no longer needed
+        for (size_t i = 0; i < temporary.size(); ++i) unlink(temporary[i].c_str());
+        temporary = outputs;
+        files = outputs;
+    }
+
+    // Written under a temporary name, so that no partial output is left
+    std::string tmp_output = output + ".tmp";
+    if (ok) {
+        std::cout << "Final merge: " << files.size() << " files" << std::endl;
+        ok = mergeGroup(files, tmp_output, compression);
+    }
+    for (size_t i = 0; i < temporary.size(); ++i) unlink(temporary[i].c_str());
+    if (ok && rename(tmp_output.c_str(), output.c_str()) != 0) {
+        std::cerr << "Failed to write " << output << std::endl;
+        ok = false;
+    }
+    if (!ok) unlink(tmp_output.c_str());
+    return ok;
+}
@@ -0,0 +1,164 @@
+/**
+ * @file test_event_catalogue.cpp
+ * @author AK <alex.nuclearboy@gmail.com>
+ * @brief Record, load and query test of the event catalogue.
+ *
+ * Usage: test_event_catalogue [directory]
+ *
+ * Records small files in a catalogue, among them a file written again as
+ * by a resumed run and lines appended by several processes at once, loads
+ * the catalogue and checks the entries and the ranges returned by queries.
+ * Exits with 0 if all checks pass.
+ *
+ * @date 2026-10-18
+ *
+ * @note Distributed under the GNU General Public License version 3.0 (GPLv3).
+ */
+
+#include "event_catalogue.h"
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
+#include "test_check.h"
+
+namespace {
+
+void writeFile(const std::string& path, const std::string& text)
+{
+    std::ofstream out(path.c_str());
+    out << text;
+}
+
+EventCatalogue::Entry entry(Long64_t first_event, Long64_t events,
+                            Long64_t entries, UInt_t seed,
+                            const std::string& reaction)
+{
+    EventCatalogue::Entry result;
+    result.first_event = first_event;
+    result.events = events;
+    result.entries = entries;
+    result.seed = seed;
+    result.reaction = reaction;
+    return result;
+}
+
+/// Ranges as "file first_entry entries" separated by ";".
+std::string format(const std::vector<EventCatalogue::Range>& ranges)
+{
+    std::ostringstream out;
+    for (size_t i = 0; i < ranges.size(); ++i) {
+        std::string name = ranges[i].path.substr(ranges[i].path.find_last_of('/') + 1);
+        out << (i ? ";" : "") << name << " " << ranges[i].first_entry << " "
+            << ranges[i].entries;
+    }
+    return out.str();
+}
+
+} // namespace
+
+Int_t main(Int_t argc, char** argv)
+{
+    std::string directory = std::string(argc > 1 ? argv[1] : ".") +
+                            "/test_catalogue";
+    std::string catalogue = directory + "/events.catalogue";
+    mkdir(directory.c_str(), 0755);
+    unlink(catalogue.c_str());
+    check(EventCatalogue::catalogueOf(directory + "/a.root") == catalogue &&
+          EventCatalogue::catalogueOf("a.root") == "./events.catalogue",
+          "catalogue of a file");
+
+    // Files of two runs; b.root is rewritten by a resumed run, c.root lost
+    // events to an acceptance filter
+    writeFile(directory + "/a.root", "hello\n");
+    writeFile(directory + "/b.root", "first run");
+    writeFile(directory + "/c.root", "filtered");
+    Bool_t recorded =
+        EventCatalogue::record(directory + "/a.root", entry(0, 1000, 1000, 7, "pd -> p d")) &&
+        EventCatalogue::record(directory + "/b.root", entry(1000, 500, 500, 7, "pd -> p d")) &&
+        EventCatalogue::record(directory + "/c.root", entry(0, 1000, 321, 8, "pd -> p d"));
+    writeFile(directory + "/b.root", "resumed run, longer");
+    recorded = EventCatalogue::record(directory + "/b.root",
+                                      entry(1000, 1000, 1000, 7, "pd -> p d")) && recorded;
+
+    // Several jobs recording files at the same time
+    const Int_t jobs = 8, files = 50;
+    for (Int_t job = 0; job < jobs; ++job) {
+        if (fork() == 0) {
+            for (Int_t i = 0; i < files; ++i) {
+                std::ostringstream name;
+                name << directory << "/job-" << job << "-" << i << ".root";
+                writeFile(name.str(), name.str());
+                if (!EventCatalogue::record(name.str(),
+                                            entry(i * 10, 10, 10, 100 + job, "pp -> pp"))) {
+                    _exit(1);
+                }
+            }
+            _exit(0);
+        }
+    }
+    for (Int_t job = 0; job < jobs; ++job) {
+        int status = 0;
+        wait(&status);
+        recorded = recorded && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+    }
+    check(recorded, "files recorded");
+
+    EventCatalogue loaded;
+    check(loaded.load(catalogue), "catalogue loaded");
+    const std::vector<EventCatalogue::Entry>& entries = loaded.entries();
+    check(entries.size() == static_cast<size_t>(3 + jobs * files),
+          "one entry per file and tree");
+    check(entries.size() >= 2 && entries[0].file == "a.root" &&
+          entries[0].tree == "data" && entries[0].bytes == 6 &&
+          entries[0].md5 == "b1946ac92492d2347c6235b4d2611184" &&
+          entries[0].model == "-" && entries[0].reaction == "pd -> p d" &&
+          entries[0].geometry == EventCatalogue::defaultGeometry(),
+          "fields of an entry");
+    check(entries.size() >= 2 && entries[1].file == "b.root" &&
+          entries[1].events == 1000 && entries[1].bytes == 19,
+          "last line of a rewritten file");
+
+    // Queries
+    EventCatalogue::Query query;
+    query.reaction = "pd -> p d";
+    check(format(loaded.query(query)) == "a.root 0 1000;b.root 0 1000;c.root 0 321",
+          "query of a reaction");
+    query.seed = 7;
+    query.first_event = 900;
+    query.last_event = 1200;
+    check(format(loaded.query(query)) == "a.root 900 100;b.root 0 200",
+          "query of an event range");
+    query.seed = 8;
+    check(format(loaded.query(query)) == "c.root 0 321",
+          "filtered file returned whole");
+    query.seed = -1;
+    query.first_event = 2000;
+    query.last_event = -1;
+    check(loaded.query(query).empty(), "query beyond the events");
+    EventCatalogue::Query jobs_query;
+    jobs_query.seed = 103;
+    jobs_query.first_event = 485;
+    check(format(loaded.query(jobs_query)) == "job-3-48.root 5 5;job-3-49.root 0 10",
+          "query of concurrently recorded files");
+    jobs_query.geometry = "other";
+    check(loaded.query(jobs_query).empty(), "query of another geometry");
+
+    // A damaged line is reported, not skipped
+    std::string damaged = directory + "/damaged.catalogue";
+    writeFile(damaged, "# comment\na.root\tdata\t0\t10\n");
+    EventCatalogue rejected;
+    check(!rejected.load(damaged) && !rejected.load(directory + "/missing.catalogue"),
+          "damaged and missing catalogue rejected");
+
+    if (testFailures() == 0) {
+        std::string command = "rm -rf '" + directory + "'";
+        if (system(command.c_str()) != 0) return 1;
+    }
+    return testResult();
+}
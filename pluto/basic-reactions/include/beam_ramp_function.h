@@ -0,0 +1,78 @@
+#ifndef BEAM_RAMP_FUNCTION_H
+#define BEAM_RAMP_FUNCTION_H
+
+#include <string>
+#include <vector>
+#include <RVersion.h>
+#include <TF1.h>
+#include <TRandom.h>
+
+/**
+ * Beam smearing distribution sampled directly instead of through the
+ * integral table which TF1::GetRandom builds from the function values.
+ * Objects of this class are passed to PBeamSmearing in place of the
+ * formula functions, so PLUTO draws the beam momentum and the angular
+ * spread analytically (flat ramp, Gaussian) or by inverting the exact
+ * cumulative distribution of a tabulated ramp profile.
+ */
+
+class BeamRampFunction : public TF1 {
+public:
+    enum Shape { kFlat, kGaussian, kProfile };
+
+    /**
+     * Flat distribution over [lower, upper], e.g. the linear beam ramp.
+     */
+    static BeamRampFunction* flat(const char* name, double lower,
+                                  double upper);
+
+    /**
+     * Gaussian distribution truncated to [lower, upper].
+     */
+    static BeamRampFunction* gaussian(const char* name, double mean,
+                                      double sigma, double lower,
+                                      double upper);
+
+    /**
+     * Piecewise linear distribution read from a text file with lines
+     * "momentum weight", e.g. the measured ramp profile of the beam.
+     * Negative weights are taken as 0.
+     *
+     * @return Pointer to the function, or NULL if the file is invalid: a
+     *         point is not finite, two points have the same momentum, or
+     *         the profile has fewer than two points or no weight.
+     */
+    static BeamRampFunction* profile(const char* name,
+                                     const std::string& file_name);
+
+    Double_t EvalPar(const Double_t* x, const Double_t* params = 0);
+
+#if ROOT_VERSION_CODE >= ROOT_VERSION(6,24,0)
+    Double_t GetRandom(TRandom* rng = 0, Option_t* opt = 0);
+    Double_t GetRandom(Double_t xmin, Double_t xmax, TRandom* rng = 0,
+                       Option_t* opt = 0);
+#else
+    Double_t GetRandom();
+    Double_t GetRandom(Double_t xmin, Double_t xmax);
+#endif
+
+private:
+    BeamRampFunction(const char* name, const char* formula, double lower,
+                     double upper, Shape shape);
+
+    double sample(double xmin, double xmax, TRandom* rng = 0);
+    double integral(double x) const;        // Profile area below x
+    double sampleProfile(double area) const;
+
+    Shape shape;
+    double lower;
+    double upper;
+    double mean;
+    double sigma;
+
+    std::vector<double> x_points;    // Profile abscissae (sorted)
+    std::vector<double> w_points;    // Profile weights
+    std::vector<double> cdf;         // Cumulative integral at x_points
+};
+
+#endif  // BEAM_RAMP_FUNCTION_H
@@ -0,0 +1,40 @@
+#ifndef COCKTAIL_H
+#define COCKTAIL_H
+
+#include <string>
+#include <vector>
+#include <Rtypes.h>
+
+/**
+ * A single reaction channel of a cocktail simulation.
+ */
+
+struct CocktailChannel {
+    std::string final_products;  // e.g. "3He pi0"
+    std::string file_name;       // Products without spaces, e.g. "3Hepi0"
+    double cross_section;        // Relative cross section
+    Long64_t events;             // Number of events assigned to the channel
+};
+
+/**
+ * Reads the channel list of a cocktail from a text file.
+ * Each line contains the relative cross section followed by the final
+ * products, e.g. "1.5 p d". Empty lines and lines starting with '#'
+ * are ignored.
+ *
+ * @param file_name Path to the cocktail file.
+ * @param channels Vector to which the channels are appended.
+ * @return true if at least one channel was read and all lines were valid.
+ */
+bool loadCocktail(const std::string& file_name,
+                  std::vector<CocktailChannel>& channels);
+
+/**
+ * Splits the total number of events between the channels in proportion
+ * to their cross sections (largest remainder rounding, so that the sum
+ * is exactly total_events).
+ */
+void distributeEvents(std::vector<CocktailChannel>& channels,
+                      Long64_t total_events);
+
+#endif  // COCKTAIL_H
@@ -0,0 +1,130 @@
+#ifndef PLUTO_FILE_ROLLER_H
+#define PLUTO_FILE_ROLLER_H
+
+#include <string>
+#include "acceptance_filter.h"
+#include "event_catalogue.h"
+#include "run_checkpoint.h"
+#include <PBulkInterface.h>
+#include <PParticle.h>
+#include <TClonesArray.h>
+#include <TFile.h>
+#include <TTree.h>
+
+/**
+ * Bulk plugin writing the PLUTO particle tree with output-file rollover.
+ * It is attached to a single PReaction, so the reaction is set up once
+ * and the events of one long Loop() are spread over several output files
+ * named <base>-1.root, <base>-2.root, ... The tree layout (Npart, Impact,
+ * Phi, Particles) is the one read by WMC in the KINE 50 mode. For mixed
+ * cocktail files an additional Channel branch identifies the reaction
+ * channel of each event.
+ *
+ * With checkpoints enabled the tree is auto-saved every few events and the
+ * state of gRandom is recorded with the number of committed events in a
+ * RunCheckpoint, from which an interrupted or finished run is continued.
+ *
+ * With an acceptance filter events outside the detector acceptance are
+ * dropped, or flagged in an Accepted branch; the counts of generated and
+ * accepted events are stored in every file.
+ *
+ * With the catalogue enabled every completed file is recorded in the
+ * EventCatalogue of the output directory.
+ */
+
+class PlutoFileRoller : public PBulkInterface {
+    /**
+     * @param base_name Output path without the file index and extension.
+     * @param events_per_file Number of events after which a new file
+     *                        is started (0 disables the event limit).
+     * @param max_file_bytes Approximate file size in bytes after which
+     *                       a new file is started (0 disables the limit).
+     * @param with_channel Add the Channel branch to the output tree.
+     */
+
+    /**
+     * Enables checkpoints written to path every interval events, at every
+     * file change and when the roller is closed.
+     *
+     * @param run Seed, number of events requested and options of the run
+     *            recorded in the checkpoint (for a resumed run the state
+     *            passed to resume()).
+     */
+
+    /**
+     * Continues the run recorded by a checkpoint: the file being written is
+     * reopened with its committed entries, later events are appended to it
+     * or to the following files. The state of gRandom is restored by
+     * restoreRandom(), right before the event loop starts.
+     */
+
+    /**
+     * Records every completed file in the catalogue of its directory, with
+     * the reaction, model, seed and geometry of run.
+     */
+
+    /**
+     * Checks every event against the acceptance windows of filter (not
+     * owned, NULL - all events are written). Must be set before the first
+     * file is opened or resumed.
+     */
+
+public:
+    PlutoFileRoller(const std::string& base_name, Long64_t events_per_file,
+                    Long64_t max_file_bytes = 0, bool with_channel = false);
+    ~PlutoFileRoller();
+
+    bool Modify(PParticle** array, int* decay_done, int* num, int stacksize);
+
+    void enableCheckpoints(const std::string& path, Long64_t interval,
+                           const RunCheckpoint& run);
+    bool resume(const RunCheckpoint& state);
+    bool restoreRandom();
+    void setAcceptance(const AcceptanceFilter* filter) { acceptance = filter; }
+    void enableCatalogue(const EventCatalogue::Entry& run);
+
+    void close();
+    void setChannel(Int_t id) { channel = id; }
+    int getNumFiles() const { return file_index; }
+    Long64_t getNumEvents() const { return total_events; }
+    Long64_t getNumGenerated() const { return generated_events; }
+
+private:
+    void openNextFile();
+    std::string filePath(int index) const;
+    void attachTree();
+    void writeCheckpoint();
+
+    std::string base_name;
+    Long64_t events_per_file;
+    Long64_t max_file_bytes;
+    bool with_channel;
+
+    TFile* output_file;
+    TTree* tree;
+    TClonesArray* particles;
+    Int_t npart;
+    Float_t impact;
+    Float_t phi;
+    Int_t channel;
+    Int_t accepted;
+
+    int file_index;          // Index of the currently open file
+    Long64_t file_events;    // Events written to the current file
+    Long64_t total_events;   // Events written to all files
+    Long64_t file_generated;     // Events generated for the current file
+    Long64_t file_accepted;      // Accepted events of the current file
+    Long64_t generated_events;   // Events generated, including dropped ones
+
+    const AcceptanceFilter* acceptance;     // NULL - no acceptance filter
+
+    std::string checkpoint_path;    // Empty - no checkpoints
+    Long64_t checkpoint_interval;   // Events between checkpoints
+    RunCheckpoint checkpoint;
+    bool random_pending;            // gRandom state still to be restored
+
+    bool with_catalogue;            // Completed files are catalogued
+    EventCatalogue::Entry catalogue_run;    // Run description of the files
+};
+
+#endif  // PLUTO_FILE_ROLLER_H
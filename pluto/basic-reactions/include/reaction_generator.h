@@ -2,8 +2,11 @@
 #define REACTION_GENERATOR_H
 
 #include <string>
+#include <vector>
+#include "beam_ramp_function.h"
+#include "cocktail.h"
+#include "pluto_file_roller.h"
 #include <PBeamSmearing.h>
-#include <TF1.h>
 
 /**
  * Class representing the nuclear reaction simulation.
@@ -11,25 +14,113 @@
  * using the PLUTO framework.
  */
 
+// Start of a simulation run
+enum RunMode { kNewRun, kResumeRun, kExtendRun };
+
 class ReactionGenerator {
     /**
      * Simulates nuclear reactions.
      *
+     * The reaction is set up once and the events are written to consecutive
+     * files pd-<file_name>-1.root, pd-<file_name>-2.root, ...
+     *
      * @param final_products A string representing the final products of the reaction.
      * @param file_name The filename for output data.
-     * @param iter The iteration number of the simulation.
+     * @param total_events Total number of events to generate.
+     * @param events_per_file Number of events per output file.
+     * @param max_file_bytes Output file size limit in bytes (0 - no limit).
+     * @param checkpoint_interval Events between checkpoints written to
+     *                            pd-<file_name>.ckpt (0 - only when a file
+     *                            is completed).
+     * @param mode kResumeRun continues the run recorded in the checkpoint,
+     *             kExtendRun appends total_events more events to a finished
+     *             run; the output layout and the random number stream are
+     *             taken from the checkpoint.
+     * @param seed Seed of a new run (0 - taken from the clock).
+     * @return false if the run could not be set up or continued.
+     *
+     * With an acceptance filter total_events counts the generated events.
+     * A resumed or extended run must be set up with the options recorded
+     * in its checkpoint (RunCheckpoint::arguments()).
+     */
+
+    /**
+     * Simulates all channels of a cocktail in one process, sharing the
+     * library bring-up and the beam smearing between the channels.
+     *
+     * @param channels Reaction channels with the number of events assigned.
+     * @param cocktail_name Name of the checkpoint pd-cocktail-<name>.ckpt
+     *                      and of the mixed output files.
+     * @param events_per_file Number of events per output file.
+     * @param max_file_bytes Output file size limit in bytes (0 - no limit).
+     * @param mixed Write all channels to pd-cocktail-<cocktail_name>-<n>
+     *              files with a Channel branch holding the index of
+     *              the channel in channels (not a line number),
+     *              instead of the per-channel pd-<products>-<n> files. The
+     *              channels are written one after the other, not
+     *              interleaved: a file holds runs of events of one channel.
+     * @param checkpoint_interval Events between checkpoints.
+     * @param mode kResumeRun continues the cocktail of the checkpoint; a
+     *             cocktail cannot be extended.
+     * @param seed Seed of a new run (0 - taken from the clock); channel i
+     *             of separate files is a run with seed + i.
+     * @return false if the run could not be set up or continued.
      */
     
 public:
-    ReactionGenerator();
+    /**
+     * @param ramp_profile Text file with the beam momentum profile
+     *                     ("momentum weight" per line); the ramp is flat
+     *                     between p_beam_lower and p_beam_upper if empty.
+     */
+    explicit ReactionGenerator(const std::string& ramp_profile = "");
     ~ReactionGenerator();
-    void simulate(const std::string& final_products,
-                  const std::string& file_name, int iter);
+
+    // False if the beam profile could not be loaded
+    bool isReady() const { return smear != NULL; }
+
+    // Acceptance prefilter of the written events (not owned, NULL - none)
+    void setAcceptance(const AcceptanceFilter* filter) { acceptance = filter; }
+
+    // Command-line options recorded in the checkpoints of new runs
+    void setRunOptions(const RunCheckpoint::Options& options)
+    {
+        run_options = options;
+    }
+
+    // Checkpoint of the run writing pd-<file_name>-<n>.root
+    static std::string checkpointPath(const std::string& file_name);
+
+    bool simulate(const std::string& final_products,
+                  const std::string& file_name, Long64_t total_events,
+                  Long64_t events_per_file, Long64_t max_file_bytes = 0,
+                  Long64_t checkpoint_interval = 0, RunMode mode = kNewRun,
+                  UInt_t seed = 0);
+    bool simulateCocktail(const std::vector<CocktailChannel>& channels,
+                          const std::string& cocktail_name,
+                          Long64_t events_per_file,
+                          Long64_t max_file_bytes = 0, bool mixed = false,
+                          Long64_t checkpoint_interval = 0,
+                          RunMode mode = kNewRun, UInt_t seed = 0);
                   
 private:
+    void runReaction(const std::string& final_products, Long64_t events,
+                     PlutoFileRoller& roller);
+    // Channels of a cocktail written to separate files
+    bool simulateChannels(const std::vector<CocktailChannel>& channels,
+                          Long64_t events_per_file, Long64_t max_file_bytes,
+                          Long64_t checkpoint_interval,
+                          const std::string& checkpoint_path,
+                          RunCheckpoint& state);
+    // Catalogue description of the files of a run
+    static EventCatalogue::Entry catalogueRun(const std::string& reaction,
+                                              UInt_t seed);
+
     PBeamSmearing* smear;
-    TF1* momentum_function;
-    TF1* angular_function;
+    const AcceptanceFilter* acceptance;
+    RunCheckpoint::Options run_options;
+    BeamRampFunction* momentum_function;
+    BeamRampFunction* angular_function;
 
     static const double p_beam_lower; // Lower beam momentum boundary
     static const double p_beam_upper; // Upper beam momentum boundary
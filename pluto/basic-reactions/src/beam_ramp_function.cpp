@@ -0,0 +1,206 @@
+/**
+ * File:         beam_ramp_function.cpp
+ * Author:       Aleksander Khreptak <aleksander.khreptak@alumni.uj.edu.pl>
+ * Created:      18 Oct 2026
+ * Last updated: 19 Oct 2026
+ *
+ * Description:
+ * This file implements the BeamRampFunction class providing the beam
+ * momentum and angular smearing distributions for PBeamSmearing. The random
+ * numbers are drawn from gRandom, which is seeded by PUtils::SetSeed, so
+ * the generated sequence depends only on the seed of the simulation run
+ * (unless ROOT passes its own generator to GetRandom).
+*/
+
+#include "beam_ramp_function.h"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <TMath.h>
+
+BeamRampFunction::BeamRampFunction(const char* name, const char* formula,
+                                   double lower, double upper, Shape shape)
+    : TF1(name, formula, lower, upper), shape(shape), lower(lower),
+      upper(upper), mean(0), sigma(1) {}
+
+BeamRampFunction* BeamRampFunction::flat(const char* name, double lower,
+                                         double upper)
+{
+    return new BeamRampFunction(name, "1", lower, upper, kFlat);
+}
+
+BeamRampFunction* BeamRampFunction::gaussian(const char* name, double mean,
+                                             double sigma, double lower,
+                                             double upper)
+{
+    BeamRampFunction* f = new BeamRampFunction(name, "gaus", lower, upper,
+                                               kGaussian);
+    f->SetParameters(1.0, mean, sigma);
+    f->mean = mean;
+    f->sigma = sigma;
+    return f;
+}
+
+BeamRampFunction* BeamRampFunction::profile(const char* name,
+                                            const std::string& file_name)
+{
+    std::ifstream file(file_name.c_str());
+    if (!file.is_open()) {
+        std::cerr << "Failed to open beam profile: " << file_name << std::endl;
+        return NULL;
+    }
+
+    std::vector<std::pair<double, double> > points;
+    std::string line;
+    int line_number = 0;
+    while (std::getline(file, line)) {
+        ++line_number;
+        std::istringstream iss(line);
+        double x, w;
+        if (!(iss >> x >> w)) continue;     // Skips comments and malformed lines
+        if (!TMath::Finite(x) || !TMath::Finite(w)) {
+            std::cerr << "Beam profile " << file_name << " has an invalid point"
+                      << " in line " << line_number << ": " << line << std::endl;
+            return NULL;
+        }
+        if (w < 0) w = 0;
+        points.push_back(std::make_pair(x, w));
+    }
+    std::sort(points.begin(), points.end());
+
+    if (points.size() < 2) {
+        std::cerr << "Beam profile " << file_name
+                  << " needs at least two points." << std::endl;
+        return NULL;
+    }
+    // The interpolation divides by the distance of neighbouring points
+    for (size_t i = 1; i < points.size(); ++i) {
+        if (points[i].first == points[i - 1].first) {
+            std::cerr << "Beam profile " << file_name << " has two points at "
+                      << points[i].first << "." << std::endl;
+            return NULL;
+        }
+    }
+
+    BeamRampFunction* f = new BeamRampFunction(
+        name, "1", points.front().first, points.back().first, kProfile);
+    f->cdf.push_back(0);
+    for (size_t i = 0; i < points.size(); ++i) {
+        f->x_points.push_back(points[i].first);
+        f->w_points.push_back(points[i].second);
+        if (i > 0) {
+            // Trapezoid area of the segment between the points i-1 and i
+            double dx = points[i].first - points[i - 1].first;
+            f->cdf.push_back(f->cdf.back() + 0.5 * dx *
+                             (points[i].second + points[i - 1].second));
+        }
+    }
+
+    if (f->cdf.back() <= 0) {
+        std::cerr << "Beam profile " << file_name << " has no weight."
+                  << std::endl;
+        delete f;
+        return NULL;
+    }
+    return f;
+}
+
+Double_t BeamRampFunction::EvalPar(const Double_t* x, const Double_t* params)
+{
+    if (shape != kProfile) return TF1::EvalPar(x, params);
+
+    // Linear interpolation of the profile weights
+    if (x[0] < x_points.front() || x[0] > x_points.back()) return 0;
+    size_t i = std::upper_bound(x_points.begin(), x_points.end(), x[0])
+               - x_points.begin();
+    if (i >= x_points.size()) return w_points.back();
+    double t = (x[0] - x_points[i - 1]) / (x_points[i] - x_points[i - 1]);
+    return w_points[i - 1] + t * (w_points[i] - w_points[i - 1]);
+}
+
+double BeamRampFunction::integral(double x) const
+{
+    if (x <= x_points.front()) return 0;
+    if (x >= x_points.back()) return cdf.back();
+    size_t i = std::upper_bound(x_points.begin(), x_points.end(), x)
+               - x_points.begin();
+    double t = x - x_points[i - 1];
+    double w0 = w_points[i - 1];
+    double w = w0 + t * (w_points[i] - w0) / (x_points[i] - x_points[i - 1]);
+    return cdf[i - 1] + 0.5 * t * (w0 + w);
+}
+
+double BeamRampFunction::sampleProfile(double area) const
+{
+    // Invert the cumulative distribution: find the segment containing the
+    // requested area and solve the quadratic for the linear density in it
+    size_t i = std::upper_bound(cdf.begin(), cdf.end(), area) - cdf.begin();
+    if (i >= cdf.size()) return x_points.back();
+
+    double dx = x_points[i] - x_points[i - 1];
+    double w0 = w_points[i - 1];
+    double slope = (w_points[i] - w0) / dx;
+    double a = area - cdf[i - 1];
+    double t;
+    if (TMath::Abs(slope * dx) <= 1e-12 * TMath::Max(w0, w_points[i])) {
+        t = a / w0;
+    } else {
+        t = (TMath::Sqrt(w0 * w0 + 2 * slope * a) - w0) / slope;
+    }
+    return x_points[i - 1] + TMath::Min(TMath::Max(t, 0.0), dx);
+}
+
+double BeamRampFunction::sample(double xmin, double xmax, TRandom* rng)
+{
+    if (rng == NULL) rng = gRandom;
+    xmin = TMath::Max(xmin, lower);
+    xmax = TMath::Min(xmax, upper);
+
+    switch (shape) {
+    case kFlat:
+        return xmin + (xmax - xmin) * rng->Rndm();
+    case kGaussian:
+        for (;;) {
+            double x = rng->Gaus(mean, sigma);
+            if (x >= xmin && x <= xmax) return x;
+        }
+    case kProfile: {
+        // The area of [xmin, xmax] is sampled directly, so a range without
+        // weight cannot make the sampling loop
+        double first = integral(xmin);
+        double last = integral(xmax);
+        if (last <= first) {
+            std::cerr << "Beam profile has no weight between " << xmin
+                      << " and " << xmax << "." << std::endl;
+            return xmin;
+        }
+        double x = sampleProfile(first + (last - first) * rng->Rndm());
+        return TMath::Min(TMath::Max(x, xmin), xmax);
+    }
+    }
+    return xmin;
+}
+
+#if ROOT_VERSION_CODE >= ROOT_VERSION(6,24,0)
+Double_t BeamRampFunction::GetRandom(TRandom* rng, Option_t* /*opt*/)
+{
+    return sample(lower, upper, rng);
+}
+
+Double_t BeamRampFunction::GetRandom(Double_t xmin, Double_t xmax,
+                                     TRandom* rng, Option_t* /*opt*/)
+{
+    return sample(xmin, xmax, rng);
+}
+#else
+Double_t BeamRampFunction::GetRandom()
+{
+    return sample(lower, upper);
+}
+
+Double_t BeamRampFunction::GetRandom(Double_t xmin, Double_t xmax)
+{
+    return sample(xmin, xmax);
+}
+#endif
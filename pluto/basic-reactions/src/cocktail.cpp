@@ -0,0 +1,90 @@
+/**
+ * File:         cocktail.cpp
+ * Author:       Aleksander Khreptak <aleksander.khreptak@alumni.uj.edu.pl>
+ * Created:      18 Oct 2026
+ * Last updated: 18 Oct 2026
+ *
+ * Description:
+ * This file implements reading of the cocktail channel list and the
+ * splitting of the requested number of events between the channels
+ * according to their relative cross sections.
+*/
+
+#include "cocktail.h"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+
+bool loadCocktail(const std::string& file_name,
+                  std::vector<CocktailChannel>& channels)
+{
+    std::ifstream in(file_name.c_str());
+    if (!in.is_open()) {
+        std::cerr << "Failed to open cocktail file: " << file_name << std::endl;
+        return false;
+    }
+
+    std::string line;
+    int line_number = 0;
+    while (std::getline(in, line)) {
+        ++line_number;
+        std::istringstream iss(line);
+        CocktailChannel channel;
+        if (!(iss >> channel.cross_section)) {
+            // Blank lines and comments are allowed, anything else is not
+            std::string first;
+            std::istringstream check(line);
+            if (!(check >> first) || first[0] == '#') continue;
+            std::cerr << "Invalid cross section in " << file_name
+                      << ", line " << line_number << std::endl;
+            return false;
+        }
+
+        std::string product;
+        while (iss >> product) {
+            if (product[0] == '#') break;
+            if (!channel.final_products.empty()) channel.final_products += " ";
+            channel.final_products += product;
+            channel.file_name += product;
+        }
+        if (channel.final_products.empty() || channel.cross_section <= 0) {
+            std::cerr << "Invalid channel in " << file_name
+                      << ", line " << line_number << std::endl;
+            return false;
+        }
+        channel.events = 0;
+        channels.push_back(channel);
+    }
+
+    return !channels.empty();
+}
+
+void distributeEvents(std::vector<CocktailChannel>& channels,
+                      Long64_t total_events)
+{
+    double sum = 0;
+    for (size_t i = 0; i < channels.size(); ++i) {
+        sum += channels[i].cross_section;
+    }
+    if (sum <= 0) return;
+
+    std::vector<double> remainders(channels.size());
+    Long64_t assigned = 0;
+    for (size_t i = 0; i < channels.size(); ++i) {
+        double share = total_events * channels[i].cross_section / sum;
+        channels[i].events = static_cast<Long64_t>(share);
+        remainders[i] = share - channels[i].events;
+        assigned += channels[i].events;
+    }
+
+    // Hand out the events lost by truncation, largest remainder first
+    while (assigned < total_events) {
+        size_t largest = 0;
+        for (size_t i = 1; i < channels.size(); ++i) {
+            if (remainders[i] > remainders[largest]) largest = i;
+        }
+        ++channels[largest].events;
+        remainders[largest] = -1;
+        ++assigned;
+    }
+}
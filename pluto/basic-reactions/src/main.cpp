@@ -1,19 +1,138 @@
 #include <iostream>
 #include <sstream>
 #include <string>
+#include <cstdlib>
+#include <vector>
 #include "reaction_generator.h"
 #include <TSystem.h>
 #include <TROOT.h>
 
-// Combine final product names and create a file name
-void processArguments(int argc, char** argv,std::string& final_products,
-                      std::string& file_name) 
+// Output layout of a simulation run
+struct RunOptions {
+    Long64_t total_events;      // 0 - ten files of events_per_file events
+    Long64_t events_per_file;
+    Long64_t max_file_bytes;    // 0 - no file size limit
+    std::string cocktail_file;  // Channel list of a cocktail simulation
+    std::string ramp_profile;   // Tabulated beam momentum profile
+    bool mixed;                 // Write the cocktail to a single mixed file
+    Long64_t checkpoint_interval;   // Events between checkpoints
+    RunMode mode;               // New run, resume or extension
+    UInt_t seed;                // 0 - taken from the clock
+    std::string acceptance;     // Acceptance windows of the prefilter
+    std::string acceptance_mode;    // Drop or flag rejected events
+    RunCheckpoint::Options recorded;    // Options of the run configuration
+    RunOptions() : total_events(0), events_per_file(1000000),
+                   max_file_bytes(0), mixed(false),
+                   checkpoint_interval(100000), mode(kNewRun), seed(0),
+                   acceptance_mode("drop") {}
+};
+
+// Parse the options and combine final product names into a file name
+bool parseArguments(const std::vector<std::string>& args, RunOptions& options,
+                    std::string& final_products, std::string& file_name)
+{
+    for (size_t i = 0; i < args.size(); ++i) {
+        const std::string& arg = args[i];
+        if (arg == "--mixed") {
+            options.mixed = true;
+            options.recorded[arg] = "";
+            continue;
+        }
+        if (arg == "--resume") {
+            options.mode = kResumeRun;
+            continue;
+        }
+        if (arg.compare(0, 2, "--") == 0) {
+            if (i + 1 >= args.size()) return false;
+            const std::string& value = args[++i];
+            // Options of a single session are not recorded
+            if (arg == "--extend") {
+                options.mode = kExtendRun;
+                options.total_events = atoll(value.c_str());
+                continue;
+            }
+            if (arg == "--checkpoint") {
+                options.checkpoint_interval = atoll(value.c_str());
+                continue;
+            }
+            // Like the products, the cocktail names the run
+            if (arg == "--cocktail") {
+                options.cocktail_file = value;
+                continue;
+            }
+            if (arg == "--events") {
+                options.total_events = atoll(value.c_str());
+            } else if (arg == "--per-file") {
+                options.events_per_file = atoll(value.c_str());
+            } else if (arg == "--max-size") {
+                options.max_file_bytes = atoll(value.c_str()) * 1024 * 1024;
+            } else if (arg == "--ramp-profile") {
+                options.ramp_profile = value;
+            } else if (arg == "--seed") {
+                options.seed = static_cast<UInt_t>(
+                    strtoul(value.c_str(), NULL, 10));
+            } else if (arg == "--acceptance") {
+                options.acceptance = value;
+            } else if (arg == "--acceptance-mode") {
+                options.acceptance_mode = value;
+            } else {
+                return false;
+            }
+            options.recorded[arg] = value;
+            continue;
+        }
+        if (!final_products.empty()) final_products += " ";
+        final_products += arg;
+        file_name += arg;
+    }
+    if (options.total_events == 0) {
+        options.total_events = 10 * options.events_per_file;
+    }
+    if (options.cocktail_file.empty() == final_products.empty()) return false;
+    // A continued run takes its other options from the checkpoint; the
+    // events of a cocktail are split between the channels once
+    if (options.mode != kNewRun && !options.recorded.empty()) return false;
+    if (options.mode == kExtendRun && !options.cocktail_file.empty()) {
+        return false;
+    }
+    return options.total_events > 0;
+}
+
+// Set up a continued run with the options recorded in its checkpoint,
+// keeping those of the session
+bool replayOptions(const std::string& checkpoint_path, RunOptions& options)
 {
-    for (int i = 1; i < argc; ++i) {
-        final_products += argv[i];
-        final_products += (i < argc - 1) ? " " : "";
-        file_name += argv[i];
+    RunCheckpoint recorded;
+    if (!recorded.load(checkpoint_path)) return false;
+
+    RunOptions run;
+    std::string products, file_name;
+    std::vector<std::string> args = recorded.arguments();
+    if (options.cocktail_file.empty()) {
+        args.push_back("recorded");
+    } else {
+        args.push_back("--cocktail");
+        args.push_back(options.cocktail_file);
     }
+    if (!parseArguments(args, run, products, file_name)) {
+        std::cerr << "Invalid options in checkpoint " << checkpoint_path
+                  << std::endl;
+        return false;
+    }
+    run.mode = options.mode;
+    run.checkpoint_interval = options.checkpoint_interval;
+    if (options.mode == kExtendRun) run.total_events = options.total_events;
+    options = run;
+    return true;
+}
+
+// Name of the cocktail used for the mixed output files: the base name
+// of the channel list file without extension
+std::string cocktailName(const std::string& cocktail_file)
+{
+    std::string name = cocktail_file.substr(
+        cocktail_file.find_last_of('/') + 1);
+    return name.substr(0, name.find_last_of('.'));
 }
 
 void printLoadedLibraries() 
@@ -24,16 +143,47 @@ void printLoadedLibraries()
 
 int main(int argc, char** argv) 
 {
-    if (argc < 3) {
-        std::cerr << "Usage: " << argv[0] << " product1 product2 ..." 
-                  << std::endl;
-        return 1;
-    }
-    
+    RunOptions options;
     std::string final_products;
     std::string file_name;
     
-    processArguments(argc, argv, final_products, file_name);
+    if (!parseArguments(std::vector<std::string>(argv + 1, argv + argc),
+                        options, final_products, file_name)) {
+        std::cerr << "Usage: " << argv[0] << " [--events N] [--per-file K]"
+                  << " [--max-size MB] [--ramp-profile <file>]"
+                  << " [--checkpoint N] [--seed S]"
+                  << " [--acceptance <file> [--acceptance-mode drop|flag]]"
+                  << " product1 product2 ..." << std::endl
+                  << "       " << argv[0] << " --resume | --extend N"
+                  << " [--checkpoint N] product1 product2 ..." << std::endl
+                  << "       " << argv[0] << " [--events N] [--per-file K]"
+                  << " [--max-size MB] [--checkpoint N] [--seed S]"
+                  << " --cocktail <file> [--mixed]" << std::endl
+                  << "       " << argv[0] << " --resume [--checkpoint N]"
+                  << " --cocktail <file>" << std::endl;
+        return 1;
+    }
+
+    if (!options.cocktail_file.empty()) {
+        file_name = "cocktail-" + cocktailName(options.cocktail_file);
+    }
+    if (options.mode != kNewRun
+        && !replayOptions(ReactionGenerator::checkpointPath(file_name),
+                          options)) {
+        return 1;
+    }
+
+    std::vector<CocktailChannel> channels;
+    if (!options.cocktail_file.empty()) {
+        if (!loadCocktail(options.cocktail_file, channels)) return 1;
+        distributeEvents(channels, options.total_events);
+    }
+
+    AcceptanceFilter acceptance;
+    if (!options.acceptance.empty()
+        && !acceptance.load(options.acceptance, options.acceptance_mode)) {
+        return 1;
+    }
     
     // Initialize ROOT and PLUTO libraries
     const char* libraries[] = {
@@ -66,12 +216,28 @@ int main(int argc, char** argv)
     printLoadedLibraries();
     
     // Perform reaction simulation
-    ReactionGenerator gen;
+    ReactionGenerator gen(options.ramp_profile);
+    if (!gen.isReady()) return 1;
+    if (!options.acceptance.empty()) gen.setAcceptance(&acceptance);
+    gen.setRunOptions(options.recorded);
     
-    for (int runindex = 0; runindex < 10; ++runindex) {
-        std::cout << "Running simulation iteration "
-                  << runindex + 1 << "/10..." << std::endl;
-        gen.simulate(final_products, file_name, runindex + 1);
+    std::cout << "Running simulation of " << options.total_events
+              << " events..." << std::endl;
+    if (channels.empty()) {
+        if (!gen.simulate(final_products, file_name, options.total_events,
+                          options.events_per_file, options.max_file_bytes,
+                          options.checkpoint_interval, options.mode,
+                          options.seed)) {
+            return 1;
+        }
+    } else {
+        if (!gen.simulateCocktail(channels, cocktailName(options.cocktail_file),
+                                  options.events_per_file,
+                                  options.max_file_bytes, options.mixed,
+                                  options.checkpoint_interval, options.mode,
+                                  options.seed)) {
+            return 1;
+        }
     }
     
     std::cout << "Simulation completed successfully." << std::endl;
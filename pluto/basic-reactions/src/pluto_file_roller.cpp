@@ -0,0 +1,234 @@
+/**
+ * File:         pluto_file_roller.cpp
+ * Author:       Aleksander Khreptak <aleksander.khreptak@alumni.uj.edu.pl>
+ * Created:      18 Oct 2026
+ * Last updated: 18 Oct 2026
+ *
+ * Description:
+ * This file implements the PlutoFileRoller bulk plugin. PLUTO calls Modify()
+ * once per event after the decay chain has been processed; the plugin copies
+ * the final-state particles into the PLUTO-format "data" tree and starts a new
+ * output file once the configured number of events or file size is reached.
+ * Checkpoints auto-save the tree and record the state of gRandom, so a run
+ * can be resumed or extended with the same random number stream.
+ * An optional acceptance filter drops or flags events outside the detector
+ * acceptance before they are written. Completed files can be recorded in
+ * the event catalogue of the output directory.
+*/
+
+#include "pluto_file_roller.h"
+#include <iostream>
+#include <sstream>
+#include <TRandom.h>
+#include <TSystem.h>
+
+PlutoFileRoller::PlutoFileRoller(const std::string& base_name,
+                                 Long64_t events_per_file,
+                                 Long64_t max_file_bytes, bool with_channel)
+    : base_name(base_name), events_per_file(events_per_file),
+      max_file_bytes(max_file_bytes), with_channel(with_channel),
+      output_file(NULL), tree(NULL), particles(NULL), npart(0), impact(0),
+      phi(0), channel(0), accepted(1), file_index(0),
+      file_events(0), total_events(0), file_generated(0), file_accepted(0),
+      generated_events(0), acceptance(NULL), checkpoint_interval(0),
+      random_pending(false), with_catalogue(false)
+{
+    particles = new TClonesArray("PParticle", 10);
+}
+
+PlutoFileRoller::~PlutoFileRoller()
+{
+    close();
+    delete particles;
+}
+
+std::string PlutoFileRoller::filePath(int index) const
+{
+    std::ostringstream oss;
+    oss << base_name << "-" << index << ".root";
+    TString path = oss.str().c_str();
+    gSystem->ExpandPathName(path);
+    return path.Data();
+}
+
+void PlutoFileRoller::openNextFile()
+{
+    close();
+    ++file_index;
+    file_events = 0;
+    file_generated = 0;
+    file_accepted = 0;
+
+    std::string path = filePath(file_index);
+    output_file = new TFile(path.c_str(), "RECREATE");
+    if (!output_file->IsOpen()) {
+        std::cerr << "Failed to open file: " << path << std::endl;
+        delete output_file;
+        output_file = NULL;
+        return;
+    }
+
+    tree = new TTree("data", "Particles Tree");
+    tree->Branch("Npart", &npart, "Npart/I");
+    tree->Branch("Impact", &impact, "Impact/F");
+    tree->Branch("Phi", &phi, "Phi/F");
+    tree->Branch("Particles", &particles);
+    if (with_channel) tree->Branch("Channel", &channel, "Channel/I");
+    if (acceptance != NULL && !acceptance->dropsEvents()) {
+        tree->Branch("Accepted", &accepted, "Accepted/I");
+    }
+
+    std::cout << "Writing events to " << path << std::endl;
+}
+
+void PlutoFileRoller::attachTree()
+{
+    tree->SetBranchAddress("Npart", &npart);
+    tree->SetBranchAddress("Impact", &impact);
+    tree->SetBranchAddress("Phi", &phi);
+    tree->SetBranchAddress("Particles", &particles);
+    if (with_channel) tree->SetBranchAddress("Channel", &channel);
+    if (acceptance != NULL && !acceptance->dropsEvents()) {
+        tree->SetBranchAddress("Accepted", &accepted);
+    }
+}
+
+void PlutoFileRoller::enableCheckpoints(const std::string& path,
+                                        Long64_t interval,
+                                        const RunCheckpoint& run)
+{
+    checkpoint_path = path;
+    checkpoint_interval = interval;
+    checkpoint = run;
+    checkpoint.events_per_file = events_per_file;
+    checkpoint.max_file_bytes = max_file_bytes;
+}
+
+void PlutoFileRoller::enableCatalogue(const EventCatalogue::Entry& run)
+{
+    with_catalogue = true;
+    catalogue_run = run;
+}
+
+bool PlutoFileRoller::resume(const RunCheckpoint& state)
+{
+    close();
+    checkpoint = state;
+    file_index = state.file_index;
+    file_events = state.file_events;
+    file_generated = state.file_generated;
+    file_accepted = state.file_accepted;
+    total_events = state.events_written;
+    generated_events = state.events_generated;
+    random_pending = true;
+
+    // A full file is left closed, the next event starts a new one
+    if (file_index == 0 || file_generated == 0
+        || (events_per_file > 0 && file_events >= events_per_file)) {
+        return true;
+    }
+
+    std::string path = filePath(file_index);
+    if (!RunCheckpoint::truncateTree(path, "data", file_events)) return false;
+    output_file = new TFile(path.c_str(), "UPDATE");
+    if (output_file->IsOpen()) output_file->GetObject("data", tree);
+    if (tree == NULL) {
+        std::cerr << "Failed to reopen file: " << path << std::endl;
+        delete output_file;
+        output_file = NULL;
+        return false;
+    }
+    attachTree();
+
+    std::cout << "Continuing " << path << " after " << file_events
+              << " events" << std::endl;
+    return true;
+}
+
+bool PlutoFileRoller::restoreRandom()
+{
+    if (!random_pending) return true;
+    random_pending = false;
+    return checkpoint.restoreRandom(*gRandom);
+}
+
+void PlutoFileRoller::writeCheckpoint()
+{
+    if (checkpoint_path.empty()) return;
+
+    // Entries are committed once the tree header on disk includes them
+    if (output_file != NULL) tree->AutoSave("SaveSelf");
+    checkpoint.file_index = file_index;
+    checkpoint.file_events = file_events;
+    checkpoint.file_generated = file_generated;
+    checkpoint.file_accepted = file_accepted;
+    checkpoint.events_written = total_events;
+    checkpoint.events_generated = generated_events;
+    checkpoint.commit(checkpoint_path, *gRandom);
+}
+
+void PlutoFileRoller::close()
+{
+    if (output_file == NULL) return;
+
+    output_file->cd();
+    tree->Write("", TObject::kOverwrite);
+    if (acceptance != NULL) {
+        acceptance->writeCounts(output_file, file_generated, file_accepted);
+    }
+    output_file->Close();
+    delete output_file;     // Also deletes the tree owned by the file
+    output_file = NULL;
+    tree = NULL;
+
+    if (with_catalogue) {
+        EventCatalogue::Entry entry = catalogue_run;
+        entry.tree = "data";
+        entry.first_event = generated_events - file_generated;
+        entry.events = file_generated;
+        entry.entries = file_events;
+        EventCatalogue::record(filePath(file_index), entry);
+    }
+    writeCheckpoint();
+}
+
+bool PlutoFileRoller::Modify(PParticle** array, int* decay_done, int* num,
+                             int /*stacksize*/)
+{
+    if (output_file == NULL
+        || (events_per_file > 0 && file_events >= events_per_file)
+        || (max_file_bytes > 0 && output_file->GetEND() >= max_file_bytes)) {
+        openNextFile();
+        if (output_file == NULL) return kFALSE;
+    }
+
+    // Keep only the particles which are still active after the decays
+    particles->Clear("C");
+    npart = 0;
+    Int_t detected = 0;
+    for (int i = 0; i < *num; ++i) {
+        if (decay_done[i] || !array[i]->IsActive()) continue;
+        new ((*particles)[npart++]) PParticle(*array[i]);
+        if (acceptance != NULL
+            && acceptance->isDetected(array[i]->Name(), array[i]->Vect())) {
+            ++detected;
+        }
+    }
+    accepted = (acceptance == NULL || acceptance->isAccepted(detected));
+
+    ++file_generated;
+    ++generated_events;
+    if (accepted) ++file_accepted;
+    if (accepted || !acceptance->dropsEvents()) {
+        tree->Fill();
+        ++file_events;
+        ++total_events;
+    }
+
+    if (checkpoint_interval > 0
+        && generated_events % checkpoint_interval == 0) {
+        writeCheckpoint();
+    }
+
+    return kTRUE;
+}
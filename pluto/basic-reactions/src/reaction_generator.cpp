@@ -2,7 +2,7 @@
  * File:         reaction_generator.cpp
  * Author:       Aleksander Khreptak <aleksander.khreptak@alumni.uj.edu.pl>
  * Created:      25 Jan 2024
- * Last updated: 02 Feb 2024
+ * Last updated: 18 Oct 2026
  * 
  * Description:
  * This file implements the ReactionGenerator class, which is designed to simulate nuclear
@@ -19,24 +19,37 @@
 #include <string>
 #include <PReaction.h>
 #include <PUtils.h>
+#include <TMath.h>
+#include <TRandom.h>
+#include <TSystem.h>
 #include <time.h>
+#include <unistd.h>
 
 const double ReactionGenerator::p_beam_lower = 1.426;
 const double ReactionGenerator::p_beam_upper = 1.635;
 
-ReactionGenerator::ReactionGenerator() : smear(NULL), momentum_function(NULL), 
-    angular_function(NULL) 
+// Largest number of events passed to one PReaction::Loop() call, which
+// takes an Int_t; longer runs loop in blocks of this size
+static const Long64_t max_loop_events = 1000000000;
+
+ReactionGenerator::ReactionGenerator(const std::string& ramp_profile)
+    : smear(NULL), acceptance(NULL), momentum_function(NULL),
+      angular_function(NULL)
 {
-    // Beam Smearing Setup
+    // Beam Smearing Setup: the momentum and angular distributions are
+    // sampled directly by BeamRampFunction, not through TF1 integral tables
+    if (ramp_profile.empty()) {
+        momentum_function = BeamRampFunction::flat(
+            "Uniform", p_beam_lower, p_beam_upper);
+    } else {
+        momentum_function = BeamRampFunction::profile("Profile", ramp_profile);
+        if (momentum_function == NULL) return;
+    }
+    angular_function = BeamRampFunction::gaussian(
+        "Gaussian", 0.0, 0.1, -TMath::Pi(), TMath::Pi());
+
     smear = new PBeamSmearing(const_cast<char*>("beam_smear"),
                               const_cast<char*>("Beam smearing"));
-    momentum_function = new TF1(const_cast<char*>("Uniform"), 
-                                const_cast<char*>("1"), 
-                                p_beam_lower, p_beam_upper);
-    angular_function = new TF1(const_cast<char*>("Gaussian"),
-                               const_cast<char*>("gaus"),
-                               -TMath::Pi(), TMath::Pi());
-    angular_function->SetParameters(1.0, 0.0, 0.1);
     smear->SetReaction(const_cast<char*>("p + d"));
     smear->SetMomentumFunction(momentum_function);
     smear->SetAngularSmearing(angular_function);
@@ -50,30 +63,228 @@ ReactionGenerator::~ReactionGenerator()
     delete angular_function;
 }
 
-void ReactionGenerator::simulate(const std::string& final_products,
-                                 const std::string& file_name, int iter)
+EventCatalogue::Entry ReactionGenerator::catalogueRun(
+    const std::string& reaction, UInt_t seed)
 {
-    unsigned int seed = static_cast<unsigned int>(time(NULL));
-    PUtils::SetSeed(seed);
-    
-    // Define the output file path
-    std::ostringstream oss;
-    oss << "${PLUTO_OUTPUT}/pd-" << file_name << "-" << iter;
-    std::string output_file = oss.str();
-    
-    // Reaction Setup
+    EventCatalogue::Entry run;
+    run.reaction = reaction;
+    run.seed = seed;
+    return run;
+}
+
+std::string ReactionGenerator::checkpointPath(const std::string& file_name)
+{
+    TString path = ("${PLUTO_OUTPUT}/pd-" + file_name + ".ckpt").c_str();
+    gSystem->ExpandPathName(path);
+    return path.Data();
+}
+
+void ReactionGenerator::runReaction(const std::string& final_products,
+                                    Long64_t events, PlutoFileRoller& roller)
+{
+    // Reaction Setup: no PLUTO output file, events are written by the roller
     std::ostringstream par;
     par << "_P1 = " << p_beam_lower;
     std::string param = par.str();
     PReaction my_reaction(const_cast<char*>(param.c_str()),
                           const_cast<char*>("p"), const_cast<char*>("d"),
                           const_cast<char*>(final_products.c_str()),
-                          const_cast<char*>(output_file.c_str()),
-                          1, 0, 0, 0);
+                          NULL, 1, 0, 0, 0);
+    my_reaction.AddBulk(&roller);
     try {
         my_reaction.Print();
-        my_reaction.Loop(1000000);
+        // A resumed run continues the random numbers of its checkpoint
+        if (!roller.restoreRandom()) return;
+        for (Long64_t remaining = events; remaining > 0; ) {
+            Long64_t block = remaining < max_loop_events ? remaining
+                                                         : max_loop_events;
+            my_reaction.Loop(static_cast<Int_t>(block));
+            remaining -= block;
+        }
     } catch (const std::exception& e) {
         std::cerr << "Error during simulation: " << e.what() << std::endl;
     }
 }
+
+bool ReactionGenerator::simulate(const std::string& final_products,
+                                 const std::string& file_name,
+                                 Long64_t total_events,
+                                 Long64_t events_per_file,
+                                 Long64_t max_file_bytes,
+                                 Long64_t checkpoint_interval, RunMode mode,
+                                 UInt_t seed)
+{
+    // Define the output file path (file index and extension are added
+    // by the file roller)
+    std::ostringstream oss;
+    oss << "${PLUTO_OUTPUT}/pd-" << file_name;
+    std::string checkpoint_path = checkpointPath(file_name);
+
+    RunCheckpoint state;
+    if (mode == kNewRun) {
+        if (seed == 0) seed = static_cast<UInt_t>(time(NULL));
+        state.seed = seed;
+        state.total_events = total_events;
+        state.events_per_file = events_per_file;
+        state.max_file_bytes = max_file_bytes;
+        state.options = run_options;
+    } else {
+        if (!state.load(checkpoint_path)) return false;
+        if (mode == kExtendRun) {
+            if (!state.isComplete()) {
+                std::cerr << "The run in " << checkpoint_path
+                          << " is not finished, resume it first." << std::endl;
+                return false;
+            }
+            state.total_events += total_events;
+        } else if (state.isComplete()) {
+            std::cout << "All " << state.total_events << " events of "
+                      << checkpoint_path << " are already written."
+                      << std::endl;
+            return true;
+        }
+        std::cout << "Continuing after event " << state.events_generated
+                  << " of " << state.total_events << std::endl;
+    }
+    if (acceptance != NULL) {
+        std::cout << "Acceptance filter: " << acceptance->label() << std::endl;
+    }
+    PUtils::SetSeed(state.seed);
+
+    PlutoFileRoller roller(oss.str(), state.events_per_file,
+                           state.max_file_bytes);
+    roller.setAcceptance(acceptance);
+    if (mode != kNewRun && !roller.resume(state)) return false;
+    roller.enableCheckpoints(checkpoint_path, checkpoint_interval, state);
+    roller.enableCatalogue(catalogueRun("pd -> " + final_products, state.seed));
+
+    runReaction(final_products, state.total_events - state.events_generated,
+                roller);
+    roller.close();
+
+    std::cout << roller.getNumEvents() << " events written to "
+              << roller.getNumFiles() << " file(s)." << std::endl;
+    if (acceptance != NULL) {
+        std::cout << roller.getNumGenerated() << " events generated."
+                  << std::endl;
+    }
+    return true;
+}
+
+bool ReactionGenerator::simulateCocktail(
+    const std::vector<CocktailChannel>& channels,
+    const std::string& cocktail_name, Long64_t events_per_file,
+    Long64_t max_file_bytes, bool mixed, Long64_t checkpoint_interval,
+    RunMode mode, UInt_t seed)
+{
+    std::string name = "cocktail-" + cocktail_name;
+    std::string checkpoint_path = checkpointPath(name);
+    Long64_t total_events = 0;
+    for (size_t i = 0; i < channels.size(); ++i) {
+        total_events += channels[i].events;
+    }
+
+    RunCheckpoint state;
+    if (mode == kNewRun) {
+        if (seed == 0) seed = static_cast<UInt_t>(time(NULL));
+        state.seed = seed;
+        state.total_events = total_events;
+        state.events_per_file = events_per_file;
+        state.max_file_bytes = max_file_bytes;
+        state.options = run_options;
+    } else {
+        if (!state.load(checkpoint_path)) return false;
+        if (state.total_events != total_events) {
+            std::cerr << "The channels of the cocktail do not match the run"
+                      << " in " << checkpoint_path << std::endl;
+            return false;
+        }
+        if (state.isComplete()) {
+            std::cout << "All " << state.total_events << " events of "
+                      << checkpoint_path << " are already written."
+                      << std::endl;
+            return true;
+        }
+        std::cout << "Continuing after event " << state.events_generated
+                  << " of " << state.total_events << std::endl;
+    }
+    if (acceptance != NULL) {
+        std::cout << "Acceptance filter: " << acceptance->label() << std::endl;
+    }
+
+    if (!mixed) {
+        return simulateChannels(channels, events_per_file, max_file_bytes,
+                                checkpoint_interval, checkpoint_path, state);
+    }
+
+    // The channels follow each other in the mixed files, in the order of
+    // the cocktail; events_generated tells the channel to continue with
+    PUtils::SetSeed(state.seed);
+    PlutoFileRoller roller("${PLUTO_OUTPUT}/pd-" + name, events_per_file,
+                           max_file_bytes, true);
+    roller.setAcceptance(acceptance);
+    if (mode != kNewRun && !roller.resume(state)) return false;
+    roller.enableCheckpoints(checkpoint_path, checkpoint_interval, state);
+    roller.enableCatalogue(catalogueRun("cocktail " + cocktail_name,
+                                        state.seed));
+
+    Long64_t first = 0;
+    for (size_t i = 0; i < channels.size(); ++i) {
+        const CocktailChannel& channel = channels[i];
+        Long64_t end = first + channel.events;
+        std::cout << "Channel " << i << ": " << channel.final_products
+                  << " (" << channel.events << " events)" << std::endl;
+        if (state.events_generated < end) {
+            roller.setChannel(static_cast<Int_t>(i));
+            runReaction(channel.final_products,
+                        end - TMath::Max(first, state.events_generated),
+                        roller);
+        }
+        first = end;
+    }
+    roller.close();
+    std::cout << roller.getNumEvents() << " events written to "
+              << roller.getNumFiles() << " file(s)." << std::endl;
+    return true;
+}
+
+bool ReactionGenerator::simulateChannels(
+    const std::vector<CocktailChannel>& channels, Long64_t events_per_file,
+    Long64_t max_file_bytes, Long64_t checkpoint_interval,
+    const std::string& checkpoint_path, RunCheckpoint& state)
+{
+    // Every channel is a run of its own with the seed of the cocktail
+    // plus the channel index; the checkpoint of the cocktail counts the
+    // events of the finished channels, and file_index - 1 is the channel
+    // being simulated, which is continued from its own checkpoint
+    Long64_t first = 0;
+    for (size_t i = 0; i < channels.size(); ++i) {
+        const CocktailChannel& channel = channels[i];
+        Long64_t end = first + channel.events;
+        std::cout << "Channel " << i << ": " << channel.final_products
+                  << " (" << channel.events << " events)" << std::endl;
+        if (state.events_generated >= end) {
+            first = end;
+            continue;
+        }
+
+        RunMode mode = kNewRun;
+        if (state.file_index == static_cast<Int_t>(i) + 1
+            && access(checkpointPath(channel.file_name).c_str(), R_OK) == 0) {
+            mode = kResumeRun;
+        }
+        state.file_index = static_cast<Int_t>(i) + 1;
+        if (!state.commit(checkpoint_path, *gRandom)) return false;
+
+        if (!simulate(channel.final_products, channel.file_name,
+                      channel.events, events_per_file, max_file_bytes,
+                      checkpoint_interval, mode,
+                      state.seed + static_cast<UInt_t>(i))) {
+            return false;
+        }
+        state.events_generated = end;
+        first = end;
+    }
+    state.file_index = 0;
+    return state.commit(checkpoint_path, *gRandom);
+}
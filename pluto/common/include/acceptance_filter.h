@@ -0,0 +1,228 @@
+/**
+ * @file acceptance_filter.h
+ * @author AK <alex.nuclearboy@gmail.com>
+ * @brief Geometrical acceptance prefilter of the event generators.
+ *
+ * The filter checks the final-state particles of an event against the
+ * acceptance windows of the WASA detector (polar angle and momentum ranges
+ * per detector and particle type, see config/acceptance_<setup>.dat). Events
+ * with fewer than the required number of particles inside a window cannot
+ * be reconstructed; they are either dropped before they reach the output,
+ * so that WMC never simulates them, or kept and flagged.
+ *
+ * For the normalisation the number of generated and accepted events of an
+ * output file is stored in the file as the parameters EventsGenerated and
+ * EventsAccepted, together with the name Acceptance describing the filter.
+ *
+ * The class is header-only as it is shared by the generator projects and
+ * the fast detector simulation (fastsim/), which assigns the particles to
+ * the detectors by the same windows.
+ *
+ * @date 2026-10-18
+ *
+ * @note Distributed under the GNU General Public License version 3.0 (GPLv3).
+ */
+
+#ifndef ACCEPTANCE_FILTER_H
+#define ACCEPTANCE_FILTER_H
+
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "Rtypes.h"
+#include "TDirectory.h"
+#include "TMath.h"
+#include "TNamed.h"
+#include "TObject.h"
+#include "TParameter.h"
+#include "TVector3.h"
+
+class AcceptanceFilter {
+public:
+    enum Mode { kDrop, kFlag };
+
+    AcceptanceFilter() : required_(1), mode_(kDrop) {}
+
+    /**
+     * Reads the acceptance windows from path.
+     *
+     * @param mode_name "drop" to remove rejected events from the output,
+     *                  "flag" to keep them with an Accepted flag.
+     * @return false if the file or the mode is invalid.
+     */
+    bool load(const std::string& path, const std::string& mode_name = "drop")
+    {
+        if (mode_name == "drop") {
+            mode_ = kDrop;
+        } else if (mode_name == "flag") {
+            mode_ = kFlag;
+        } else {
+            std::cerr << "Unknown acceptance mode: " << mode_name << std::endl;
+            return false;
+        }
+
+        std::ifstream in(path.c_str());
+        if (!in.is_open()) {
+            std::cerr << "Failed to open acceptance file: " << path
+                      << std::endl;
+            return false;
+        }
+        windows_.clear();
+        detectors_.clear();
+        required_ = 1;
+        std::string line, key;
+        int line_number = 0;
+        while (std::getline(in, line)) {
+            ++line_number;
+            line = line.substr(0, line.find('#'));
+            std::istringstream iss(line);
+            if (!(iss >> key)) continue;
+
+            bool valid = false;
+            if (key == "window") {
+                Window window;
+                std::string particles;
+                Double_t theta_min, theta_max;
+                valid = static_cast<bool>(iss >> window.detector >> particles
+                                              >> theta_min >> theta_max
+                                              >> window.p_min);
+                if (!(iss >> window.p_max)) window.p_max = 0;
+                window.theta_min = theta_min * TMath::DegToRad();
+                window.theta_max = theta_max * TMath::DegToRad();
+                std::istringstream names(particles);
+                std::string name;
+                while (std::getline(names, name, ',')) {
+                    if (!name.empty()) window.particles.push_back(name);
+                }
+                if (valid) {
+                    window.detector_index = addDetector(window.detector);
+                    windows_.push_back(window);
+                }
+            } else if (key == "require") {
+                valid = static_cast<bool>(iss >> required_) && required_ > 0;
+            }
+            if (!valid) {
+                std::cerr << "Invalid line " << line_number << " in "
+                          << path << ": " << line << std::endl;
+                return false;
+            }
+        }
+        if (windows_.empty()) {
+            std::cerr << "No acceptance windows in " << path << std::endl;
+            return false;
+        }
+
+        path_ = path;
+        std::string name = path.substr(path.find_last_of('/') + 1);
+        std::ostringstream oss;
+        oss << name.substr(0, name.find_last_of('.')) << " ("
+            << modeName() << ", " << windows_.size() << " windows, "
+            << required_ << " particle(s) required)";
+        label_ = oss.str();
+        return true;
+    }
+
+    /**
+     * True if a particle with the given name and LAB momentum [GeV/c] lies
+     * inside one of the windows.
+     */
+    bool isDetected(const std::string& particle, const TVector3& momentum) const
+    {
+        return detectorIndex(particle, momentum) >= 0;
+    }
+
+    /**
+     * Index in detectors() of the first window holding the particle, or -1
+     * if it is outside the acceptance.
+     */
+    Int_t detectorIndex(const std::string& particle,
+                        const TVector3& momentum) const
+    {
+        Double_t p = momentum.Mag();
+        if (p <= 0) return -1;
+        Double_t theta = momentum.Theta();
+        for (size_t i = 0; i < windows_.size(); ++i) {
+            const Window& window = windows_[i];
+            if (theta < window.theta_min || theta > window.theta_max) continue;
+            if (p < window.p_min || (window.p_max > 0 && p > window.p_max)) {
+                continue;
+            }
+            if (window.matches(particle)) return window.detector_index;
+        }
+        return -1;
+    }
+
+    /**
+     * Names of the detectors in the order of their first window.
+     */
+    const std::vector<std::string>& detectors() const { return detectors_; }
+
+    /**
+     * True if the number of detected particles of an event is sufficient.
+     */
+    bool isAccepted(Int_t detected) const { return detected >= required_; }
+
+    bool dropsEvents() const { return mode_ == kDrop; }
+    const char* modeName() const { return mode_ == kDrop ? "drop" : "flag"; }
+    const std::string& path() const { return path_; }
+    const std::string& label() const { return label_; }
+
+    /**
+     * Stores the event counts of an output file for the normalisation of
+     * the acceptance in the directory dir.
+     */
+    void writeCounts(TDirectory* dir, Long64_t generated,
+                     Long64_t accepted) const
+    {
+        TDirectory* previous = gDirectory;
+        dir->cd();
+        TParameter<Long64_t> events_generated("EventsGenerated", generated);
+        TParameter<Long64_t> events_accepted("EventsAccepted", accepted);
+        TNamed acceptance("Acceptance", label_.c_str());
+        events_generated.Write("", TObject::kOverwrite);
+        events_accepted.Write("", TObject::kOverwrite);
+        acceptance.Write("", TObject::kOverwrite);
+        if (previous != NULL) previous->cd();
+    }
+
+private:
+    struct Window {
+        std::string detector;
+        Int_t detector_index;    ///< Position of detector in detectors_.
+        std::vector<std::string> particles;    ///< Empty or "*" - any.
+        Double_t theta_min;    ///< [rad]
+        Double_t theta_max;    ///< [rad]
+        Double_t p_min;        ///< [GeV/c]
+        Double_t p_max;        ///< [GeV/c], 0 - no limit.
+
+        bool matches(const std::string& particle) const
+        {
+            for (size_t i = 0; i < particles.size(); ++i) {
+                if (particles[i] == "*" || particles[i] == particle) {
+                    return true;
+                }
+            }
+            return particles.empty();
+        }
+    };
+
+    Int_t addDetector(const std::string& name)
+    {
+        for (size_t i = 0; i < detectors_.size(); ++i) {
+            if (detectors_[i] == name) return static_cast<Int_t>(i);
+        }
+        detectors_.push_back(name);
+        return static_cast<Int_t>(detectors_.size()) - 1;
+    }
+
+    std::vector<Window> windows_;
+    std::vector<std::string> detectors_;
+    Int_t required_;
+    Mode mode_;
+    std::string path_;
+    std::string label_;
+};
+
+#endif // ACCEPTANCE_FILTER_H
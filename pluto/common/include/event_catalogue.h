@@ -0,0 +1,265 @@
+/**
+ * @file event_catalogue.h
+ * @author AK <alex.nuclearboy@gmail.com>
+ * @brief Catalogue of the event files written by the generators.
+ *
+ * Every completed output file is recorded in the catalogue of its
+ * directory, <dir>/events.catalogue, so that the files holding a range of
+ * events of a reaction, model, seed or geometry are found without listing
+ * the directory or opening the files. The catalogue is a tab-separated
+ * text file with one line per file and tree:
+ *
+ *     file  tree  first_event  events  entries  bytes  seed  model
+ *     reaction  geometry  md5
+ *
+ * - file: name of the file in the directory of the catalogue;
+ * - first_event, events: generated events [first_event, first_event +
+ *   events) of the run (identified by its seed) stored in the file;
+ * - entries: entries of the tree, fewer than events if an acceptance
+ *   filter dropped events;
+ * - bytes, md5: size and MD5 checksum of the file when it was recorded;
+ * - model: nucleon momentum model ("-" if none), geometry: detector setup
+ *   ($WMC_GEOMETRY, default B009, as for the WMC jobs).
+ *
+ * Lines are only appended (each by a single write), so several jobs can
+ * record their files in the same catalogue. A file written again, e.g. by
+ * a resumed run, gets a new line; the last line of a file and tree is the
+ * valid one. Lines starting with '#' are comments.
+ *
+ * The class is header-only as it is shared by the generator projects and
+ * the catalogue_query tool.
+ *
+ * @date 2026-10-18
+ *
+ * @note Distributed under the GNU General Public License version 3.0 (GPLv3).
+ */
+
+#ifndef EVENT_CATALOGUE_H
+#define EVENT_CATALOGUE_H
+
+#include <algorithm>
+#include <cstdlib>
+#include <fcntl.h>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+#include "Rtypes.h"
+#include "TMD5.h"
+
+class EventCatalogue {
+public:
+    struct Entry {
+        std::string file;
+        std::string tree;
+        Long64_t first_event;
+        Long64_t events;
+        Long64_t entries;
+        Long64_t bytes;
+        UInt_t seed;
+        std::string model;
+        std::string reaction;
+        std::string geometry;
+        std::string md5;
+
+        Entry()
+            : tree("data"), first_event(0), events(0), entries(0), bytes(0),
+              seed(0), model("-"), geometry(defaultGeometry()) {}
+    };
+
+    /// Range of tree entries of a file selected by a query.
+    struct Range {
+        std::string path;
+        std::string tree;
+        Long64_t first_entry;
+        Long64_t entries;
+        size_t index;       ///< Position of the file in entries().
+    };
+
+    /// Selection of files; empty strings and negative numbers match all.
+    struct Query {
+        std::string tree;
+        std::string reaction;
+        std::string model;
+        std::string geometry;
+        Long64_t seed;
+        Long64_t first_event;   ///< First generated event wanted.
+        Long64_t last_event;    ///< Generated event after the last one wanted.
+
+        Query() : seed(-1), first_event(-1), last_event(-1) {}
+    };
+
+    /**
+     * Path of the catalogue of the directory holding file.
+     */
+    static std::string catalogueOf(const std::string& file)
+    {
+        std::string::size_type slash = file.find_last_of('/');
+        std::string dir = (slash == std::string::npos) ? "." : file.substr(0, slash);
+        return dir + "/events.catalogue";
+    }
+
+    static std::string defaultGeometry()
+    {
+        const char* geometry = getenv("WMC_GEOMETRY");
+        return (geometry != NULL && *geometry != '\0') ? geometry : "B009";
+    }
+
+    /**
+     * Records a completed file: the description of entry is completed by
+     * the name, size and checksum of the file and appended to the
+     * catalogue of its directory.
+     *
+     * @return false if the file or the catalogue cannot be accessed.
+     */
+    static bool record(const std::string& path, Entry entry)
+    {
+        struct stat info;
+        TMD5* checksum = TMD5::FileChecksum(path.c_str());
+        if (checksum == NULL || stat(path.c_str(), &info) != 0) {
+            std::cerr << "Cannot record " << path << " in the catalogue."
+                      << std::endl;
+            delete checksum;
+            return false;
+        }
+        entry.file = path.substr(path.find_last_of('/') + 1);
+        entry.bytes = info.st_size;
+        entry.md5 = checksum->AsString();
+        delete checksum;
+
+        std::string catalogue = catalogueOf(path);
+        std::ostringstream line;
+        if (access(catalogue.c_str(), F_OK) != 0) {
+            line << "# file\ttree\tfirst_event\tevents\tentries\tbytes\tseed"
+                 << "\tmodel\treaction\tgeometry\tmd5\n";
+        }
+        line << entry.file << "\t" << entry.tree << "\t" << entry.first_event
+             << "\t" << entry.events << "\t" << entry.entries << "\t"
+             << entry.bytes << "\t" << entry.seed << "\t"
+             << field(entry.model) << "\t" << field(entry.reaction) << "\t"
+             << field(entry.geometry) << "\t" << entry.md5 << "\n";
+
+        // One write in append mode is not interleaved with other writers
+        std::string text = line.str();
+        int fd = open(catalogue.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+        bool written = fd >= 0 &&
+            write(fd, text.data(), text.size()) == static_cast<ssize_t>(text.size());
+        if (fd >= 0 && close(fd) != 0) written = false;
+        if (!written) {
+            std::cerr << "Failed to write catalogue: " << catalogue << std::endl;
+        }
+        return written;
+    }
+
+    /**
+     * Reads a catalogue; the entries of several catalogues can be loaded
+     * one after the other.
+     */
+    bool load(const std::string& catalogue)
+    {
+        std::ifstream in(catalogue.c_str());
+        if (!in.is_open()) {
+            std::cerr << "No catalogue found: " << catalogue << std::endl;
+            return false;
+        }
+        std::string dir = catalogue.substr(0, catalogue.find_last_of('/') + 1);
+        std::string line;
+        Int_t line_number = 0;
+        while (std::getline(in, line)) {
+            ++line_number;
+            if (line.empty() || line[0] == '#') continue;
+            std::istringstream iss(line);
+            Entry entry;
+            std::string fields[4];
+            getline(iss, entry.file, '\t');
+            getline(iss, entry.tree, '\t');
+            iss >> entry.first_event >> entry.events >> entry.entries
+                >> entry.bytes >> entry.seed;
+            iss.ignore(1);
+            for (int i = 0; i < 4; ++i) getline(iss, fields[i], '\t');
+            if (iss.fail() || fields[3].empty()) {
+                std::cerr << "Invalid line " << line_number << " in "
+                          << catalogue << ": " << line << std::endl;
+                return false;
+            }
+            entry.model = fields[0];
+            entry.reaction = fields[1];
+            entry.geometry = fields[2];
+            entry.md5 = fields[3];
+
+            // A later line of the same file and tree replaces the earlier one
+            std::string key = dir + entry.file + "\t" + entry.tree;
+            if (index_.count(key) == 0) {
+                index_[key] = entries_.size();
+                entries_.push_back(entry);
+                paths_.push_back(dir + entry.file);
+            } else {
+                entries_[index_[key]] = entry;
+            }
+        }
+        return true;
+    }
+
+    const std::vector<Entry>& entries() const { return entries_; }
+
+    /**
+     * Returns the files and tree entries holding the events selected by
+     * query, in the order of the catalogue. The entries of a file from
+     * which events were dropped cannot be mapped to events; such files are
+     * returned whole if they overlap the event range.
+     */
+    std::vector<Range> query(const Query& query) const
+    {
+        std::vector<Range> ranges;
+        for (size_t i = 0; i < entries_.size(); ++i) {
+            const Entry& entry = entries_[i];
+            if (!matches(query.tree, entry.tree) ||
+                !matches(query.reaction, entry.reaction) ||
+                !matches(query.model, entry.model) ||
+                !matches(query.geometry, entry.geometry) ||
+                (query.seed >= 0 && query.seed != entry.seed)) {
+                continue;
+            }
+            Long64_t first = entry.first_event;
+            Long64_t last = entry.first_event + entry.events;
+            if (query.first_event >= 0) first = std::max(first, query.first_event);
+            if (query.last_event >= 0) last = std::min(last, query.last_event);
+            if (first >= last) continue;
+
+            Range range;
+            range.index = i;
+            range.path = paths_[i];
+            range.tree = entry.tree;
+            if (entry.entries == entry.events) {
+                range.first_entry = first - entry.first_event;
+                range.entries = last - first;
+            } else {
+                range.first_entry = 0;
+                range.entries = entry.entries;
+            }
+            ranges.push_back(range);
+        }
+        return ranges;
+    }
+
+private:
+    static std::string field(const std::string& value)
+    {
+        return value.empty() ? "-" : value;
+    }
+
+    static bool matches(const std::string& wanted, const std::string& value)
+    {
+        return wanted.empty() || wanted == value;
+    }
+
+    std::vector<Entry> entries_;
+    std::vector<std::string> paths_;        ///< Paths of the entries' files.
+    std::map<std::string, size_t> index_;   ///< Path and tree -> entry.
+};
+
+#endif // EVENT_CATALOGUE_H
@@ -0,0 +1,275 @@
+/**
+ * @file run_checkpoint.h
+ * @author AK <alex.nuclearboy@gmail.com>
+ * @brief Checkpoints of long event generator runs (pluto_run, run_simulate).
+ *
+ * A checkpoint records the state needed to continue an interrupted run
+ * exactly where it stopped: the seed, the number of events requested,
+ * generated and written (fewer than generated if an acceptance filter drops
+ * events), the file being written with its committed tree entries (and
+ * the committed bytes of a side output) and a ROOT file holding the
+ * random number generator state after the last committed event.
+ *
+ * The configuration of the run is recorded as the command-line options
+ * that define it ("option <name> [<value>]" lines); a resumed or extended
+ * run is set up again from these options, so an option of the generators
+ * needs no entry of its own here.
+ *
+ * The checkpoint is a small text file ("key value" per line) replaced
+ * atomically by a rename. The generator state is written to a new file
+ * <checkpoint>.rng-<events>.root before the checkpoint naming it, so a job
+ * killed at any moment leaves a consistent pair behind; entries filled
+ * after the last checkpoint are cut from the trees when the run resumes.
+ *
+ * The class is header-only as it is shared by the generator projects.
+ *
+ * @date 2026-10-18
+ *
+ * @note Distributed under the GNU General Public License version 3.0 (GPLv3).
+ */
+
+#ifndef RUN_CHECKPOINT_H
+#define RUN_CHECKPOINT_H
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <set>
+#include <sstream>
+#include <string>
+#include <unistd.h>
+#include <vector>
+#include "Rtypes.h"
+#include "TFile.h"
+#include "TKey.h"
+#include "TList.h"
+#include "TRandom.h"
+#include "TTree.h"
+
+struct RunCheckpoint {
+    /// Options of the run configuration: name ("--acceptance") -> value
+    /// (empty for flags).
+    typedef std::map<std::string, std::string> Options;
+
+    UInt_t seed;                ///< Seed of the random number generator.
+    Long64_t total_events;      ///< Events requested, including extensions.
+    Long64_t events_generated;  ///< Events generated, including dropped ones.
+    Long64_t events_written;    ///< Events committed to all files.
+    Long64_t events_per_file;   ///< Output layout (0 - no event limit).
+    Long64_t max_file_bytes;    ///< Output layout (0 - no size limit).
+    Int_t file_index;           ///< File being written (1, 2, ...; 0 - none).
+    Long64_t file_events;       ///< Tree entries committed to that file.
+    Long64_t file_generated;    ///< Events generated for that file.
+    Long64_t file_accepted;     ///< Events of that file in the acceptance.
+    Long64_t text_offset;       ///< Bytes committed to its side output.
+    Long64_t arrow_offset;      ///< Bytes committed to its Arrow file.
+    std::string random_state;   ///< ROOT file with the generator state.
+    Options options;            ///< Command-line options of the run.
+
+    RunCheckpoint()
+        : seed(0), total_events(0), events_generated(0), events_written(0),
+          events_per_file(0), max_file_bytes(0), file_index(0),
+          file_events(0), file_generated(0), file_accepted(0),
+          text_offset(0), arrow_offset(0) {}
+
+    /**
+     * Returns the recorded options as command-line arguments, to be parsed
+     * like those of the first run.
+     */
+    std::vector<std::string> arguments() const
+    {
+        std::vector<std::string> args;
+        for (Options::const_iterator it = options.begin();
+             it != options.end(); ++it) {
+            args.push_back(it->first);
+            if (!it->second.empty()) args.push_back(it->second);
+        }
+        return args;
+    }
+
+    bool isComplete() const { return events_generated >= total_events; }
+
+    /**
+     * Writes the checkpoint to path through a temporary file and a rename.
+     */
+    bool save(const std::string& path) const
+    {
+        std::string tmp_path = path + ".tmp";
+        std::ofstream out(tmp_path.c_str());
+        if (!out.is_open()) {
+            std::cerr << "Failed to write checkpoint: " << tmp_path
+                      << std::endl;
+            return false;
+        }
+        out << "seed " << seed << "\n"
+            << "total_events " << total_events << "\n"
+            << "events_generated " << events_generated << "\n"
+            << "events_written " << events_written << "\n"
+            << "events_per_file " << events_per_file << "\n"
+            << "max_file_bytes " << max_file_bytes << "\n"
+            << "file_index " << file_index << "\n"
+            << "file_events " << file_events << "\n"
+            << "file_generated " << file_generated << "\n"
+            << "file_accepted " << file_accepted << "\n"
+            << "text_offset " << text_offset << "\n"
+            << "arrow_offset " << arrow_offset << "\n"
+            << "random_state " << random_state << "\n";
+        for (Options::const_iterator it = options.begin();
+             it != options.end(); ++it) {
+            out << "option " << it->first;
+            if (!it->second.empty()) out << " " << it->second;
+            out << "\n";
+        }
+        out.close();
+        if (out.fail() || rename(tmp_path.c_str(), path.c_str()) != 0) {
+            std::cerr << "Failed to write checkpoint: " << path << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    /**
+     * Reads a checkpoint written by save(). Checkpoints written before the
+     * acceptance filter existed count every generated event as written;
+     * checkpoints with entries of another layout are rejected, as the run
+     * could not be continued with the same configuration.
+     */
+    bool load(const std::string& path)
+    {
+        std::ifstream in(path.c_str());
+        if (!in.is_open()) {
+            std::cerr << "No checkpoint found: " << path << std::endl;
+            return false;
+        }
+        std::string line, key;
+        events_generated = file_generated = file_accepted = -1;
+        options.clear();
+        while (std::getline(in, line)) {
+            std::istringstream iss(line);
+            if (!(iss >> key)) continue;
+            if (key == "seed") iss >> seed;
+            else if (key == "total_events") iss >> total_events;
+            else if (key == "events_generated") iss >> events_generated;
+            else if (key == "events_written") iss >> events_written;
+            else if (key == "events_per_file") iss >> events_per_file;
+            else if (key == "max_file_bytes") iss >> max_file_bytes;
+            else if (key == "file_index") iss >> file_index;
+            else if (key == "file_events") iss >> file_events;
+            else if (key == "file_generated") iss >> file_generated;
+            else if (key == "file_accepted") iss >> file_accepted;
+            else if (key == "text_offset") iss >> text_offset;
+            else if (key == "arrow_offset") iss >> arrow_offset;
+            else if (key == "random_state") iss >> random_state;
+            else if (key == "option") {
+                std::string name, value;
+                iss >> name;
+                std::getline(iss >> std::ws, value);
+                options[name] = value;
+            } else {
+                std::cerr << "Unknown entry \"" << key << "\" in checkpoint "
+                          << path << std::endl;
+                return false;
+            }
+        }
+        if (events_generated < 0) events_generated = events_written;
+        if (file_generated < 0) file_generated = file_events;
+        if (file_accepted < 0) file_accepted = file_events;
+        if (random_state.empty() || access(random_state.c_str(), R_OK) != 0) {
+            std::cerr << "Invalid checkpoint (no generator state): " << path
+                      << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    /**
+     * Stores the state of rng and commits the checkpoint; the generator
+     * state of the previous checkpoint is removed afterwards.
+     */
+    bool commit(const std::string& path, TRandom& rng)
+    {
+        std::ostringstream oss;
+        oss << path << ".rng-" << events_generated << ".root";
+        std::string previous = random_state;
+        random_state = oss.str();
+        rng.WriteRandom(random_state.c_str());
+        if (!save(path)) return false;
+        if (!previous.empty() && previous != random_state) {
+            unlink(previous.c_str());
+        }
+        return true;
+    }
+
+    /**
+     * Restores the generator state recorded by the checkpoint into rng.
+     */
+    bool restoreRandom(TRandom& rng) const
+    {
+        if (access(random_state.c_str(), R_OK) != 0) {
+            std::cerr << "Generator state not found: " << random_state
+                      << std::endl;
+            return false;
+        }
+        rng.ReadRandom(random_state.c_str());
+        return true;
+    }
+
+    /**
+     * Cuts the tree tree_name in file_name to its first entries entries,
+     * dropping events filled after the last checkpoint; the other objects
+     * of the file (e.g. a second tree) are kept. Fails if the tree holds
+     * fewer entries than were committed.
+     */
+    static bool truncateTree(const std::string& file_name,
+                             const char* tree_name, Long64_t entries)
+    {
+        TFile* file = TFile::Open(file_name.c_str(), "READ");
+        TTree* tree = NULL;
+        if (file != NULL) file->GetObject(tree_name, tree);
+        if (tree == NULL || tree->GetEntries() < entries) {
+            std::cerr << "Cannot resume " << file_name << ": fewer than "
+                      << entries << " entries in tree " << tree_name
+                      << std::endl;
+            delete file;
+            return false;
+        }
+        if (tree->GetEntries() == entries) {
+            delete file;
+            return true;
+        }
+
+        std::cout << "Dropping " << (tree->GetEntries() - entries)
+                  << " uncommitted entries from " << file_name << std::endl;
+        std::string tmp_name = file_name + ".tmp";
+        TFile copy(tmp_name.c_str(), "RECREATE");
+        TTree* kept = tree->CloneTree(entries);
+        kept->Write();
+
+        // Latest cycle of every other key, trees copied without unzipping
+        std::set<std::string> copied;
+        copied.insert(tree_name);
+        TIter next(file->GetListOfKeys());
+        while (TKey* key = static_cast<TKey*>(next())) {
+            if (!copied.insert(key->GetName()).second) continue;
+            TObject* object = key->ReadObj();
+            copy.cd();
+            TTree* other = dynamic_cast<TTree*>(object);
+            if (other != NULL) {
+                other->CloneTree(-1, "fast")->Write();
+            } else if (object != NULL) {
+                object->Write(key->GetName());
+            }
+        }
+        copy.Close();
+        delete file;
+        if (rename(tmp_name.c_str(), file_name.c_str()) != 0) {
+            std::cerr << "Failed to replace " << file_name << std::endl;
+            return false;
+        }
+        return true;
+    }
+};
+
+#endif // RUN_CHECKPOINT_H
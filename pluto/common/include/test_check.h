@@ -0,0 +1,40 @@
+/**
+ * @file test_check.h
+ * @author AK <alex.nuclearboy@gmail.com>
+ * @brief Checks of the test programs run by ctest.
+ *
+ * A test program calls check() for every condition it tests, which prints
+ * a PASS or FAIL line, and returns testResult() from main().
+ *
+ * @date 2026-10-18
+ *
+ * @note Distributed under the GNU General Public License version 3.0 (GPLv3).
+ */
+
+#ifndef TEST_CHECK_H
+#define TEST_CHECK_H
+
+#include <iostream>
+#include <string>
+
+/// Number of failed checks of the test program.
+inline int& testFailures()
+{
+    static int failures = 0;
+    return failures;
+}
+
+/// Prints the result of a check and counts it if it failed.
+inline void check(bool condition, const std::string& what)
+{
+    std::cout << (condition ? "PASS: " : "FAIL: ") << what << std::endl;
+    if (!condition) ++testFailures();
+}
+
+/// Exit code of the test program: 0 if all checks passed.
+inline int testResult()
+{
+    return testFailures() == 0 ? 0 : 1;
+}
+
+#endif // TEST_CHECK_H
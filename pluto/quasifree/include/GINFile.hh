@@ -20,6 +20,7 @@ public:
     int AddParticle(int type, const TLorentzVector *);
     int WriteHeader(const char *, int reac, float pz, int nev);
     int WriteEvent(float );
+    void SetBeamPz(float pz) {fBeamPz = pz;};  ///< Beam momentum of the next events
     int Close();    ///< Close output file
     void Reset() {fPart = 0;};  ///< Reset the particle counter for the next event
 };
@@ -0,0 +1,140 @@
+/**
+ * @file arrow_writer.h
+ * @author AK <alex.nuclearboy@gmail.com>
+ * @brief Declaration of the ArrowWriter class, which streams a selection of
+ *        the calculated values to an Apache Arrow IPC (Feather) file.
+ *
+ * Python tools read the calculated values much faster from an Arrow file
+ * than from the "values" tree. The writer collects the selected columns of
+ * the events and writes them as record batches of up to 65536 rows while
+ * the events are generated. The file is an uncompressed Arrow IPC file
+ * (Feather version 2) with one non-nullable float64 column per value, so
+ * it can be memory-mapped and read without copying, e.g.
+ *
+ *     import pyarrow as pa
+ *     table = pa.ipc.open_file(pa.memory_map(path)).read_all()
+ *
+ * or with pandas.read_feather(path). The format is written by the class
+ * itself (the metadata are FlatBuffers built by hand), so no Arrow library
+ * is needed to generate the files.
+ *
+ * The footer listing the record batches is written by close(). The file of
+ * an interrupted run is still readable as an Arrow stream after the first
+ * 8 bytes; a resumed run cuts it to the batches of its last checkpoint.
+ *
+ * @date 2026-10-18
+ *
+ * @note Distributed under the GNU General Public License version 3.0 (GPLv3).
+ */
+
+#ifndef ARROW_WRITER_H
+#define ARROW_WRITER_H
+
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "Rtypes.h"
+
+/**
+ * @class ArrowWriter
+ * @brief Buffered writer of calculated values to an Arrow IPC file.
+ */
+class ArrowWriter {
+public:
+    ArrowWriter();
+    ~ArrowWriter();     ///< Closes an open file.
+
+    /**
+     * Splits a comma-separated list of column names; "all" selects every
+     * column (an empty list).
+     *
+     * @return false if the list holds an empty name.
+     */
+    static Bool_t parseColumns(const std::string& list,
+                               std::vector<std::string>& columns);
+
+    /**
+     * Selects the columns written, in this order (empty - every column
+     * bound, in the order of binding).
+     */
+    void select(const std::vector<std::string>& columns);
+
+    /**
+     * Binds a column of calculated values; it is written if selected. The
+     * column holds the value of the current event when fill() is called.
+     */
+    void bind(const std::string& name, const std::vector<Double_t>* column);
+
+    /**
+     * Checks that every selected column is bound.
+     */
+    Bool_t isBound() const;
+
+    /**
+     * Opens the file and writes the schema of the bound columns.
+     *
+     * @param file_name Path to the file.
+     * @param offset Bytes of an existing file to keep (resumed runs, see
+     *               offset()); 0 overwrites the file.
+     * @return true if the file is open.
+     */
+    Bool_t open(const std::string& file_name, Long64_t offset = 0);
+
+    /**
+     * Appends the values of the current event, writing a record batch when
+     * the batch is full.
+     */
+    void fill();
+
+    /**
+     * Writes the buffered rows as a record batch.
+     *
+     * @return false on a write error.
+     */
+    Bool_t flush();
+
+    /**
+     * Flushes the buffered rows and writes the footer of the file.
+     *
+     * @return false on a write error.
+     */
+    Bool_t close();
+
+    Bool_t isOpen() const { return file_ != NULL; }
+
+    /**
+     * Returns the number of bytes of the schema and the written record
+     * batches; after flush() the bytes holding all rows.
+     */
+    Long64_t offset() const { return offset_; }
+
+    /// Rows written to the file, excluding the buffer.
+    Long64_t rows() const { return rows_; }
+
+private:
+    /// Position of a record batch in the file (Block of the footer).
+    struct Block {
+        Long64_t offset;
+        Int_t metadata_length;
+        Long64_t body_length;
+    };
+
+    Bool_t writeBytes(const void* data, size_t size);
+    Bool_t writeMessage(const std::vector<unsigned char>& metadata);
+    Bool_t scan(Long64_t offset);   ///< Reads the batches of a resumed file.
+
+    std::vector<std::string> selected_;     ///< Empty - all columns.
+    std::vector<std::string> names_;        ///< Columns of the file.
+    std::vector<const std::vector<Double_t>*> columns_;
+    std::vector<std::vector<Double_t> > buffers_;   ///< Rows of the batch.
+    size_t used_;           ///< Rows in the buffers.
+
+    FILE* file_;
+    std::string file_name_;
+    std::vector<Block> blocks_;
+    Long64_t offset_;       ///< Bytes written to the file.
+    Long64_t rows_;         ///< Rows written to the file.
+    Bool_t failed_;         ///< A write error occurred.
+};
+
+#endif // ARROW_WRITER_H
@@ -24,6 +24,7 @@ namespace Constants {
     static const Double_t ETA_MASS = 0.547862;          ///< Eta meson mass in GeV/c^2.
     static const Double_t BEAM_MOMENTUM_MIN = 1.426;    ///< Lower limit of proton beam momentum in the experiment in GeV/c.
     static const Double_t BEAM_MOMENTUM_MAX = 1.635;    ///< Upper limit of proton beam momentum in the experiment in GeV/c.
+    static const Int_t GIN_REACTION_ID = 1;             ///< Reaction number written to the WMC input (GINFile) records.
 }
 
 #endif // CONSTANTS_H
@@ -18,6 +18,8 @@
 #ifndef DATA_WRITER_H
 #define DATA_WRITER_H
 
+#include "output_profile.h"
+#include "proton_data_writer.h"
 #include <string>
 #include <vector>
 #include "TFile.h"
@@ -36,6 +38,13 @@ public:
     DataWriter();   ///< Default constructor.
     ~DataWriter();  ///< Destructor.
 
+    /**
+     * Sets the compression and basket layout of the files and trees
+     * created afterwards (ROOT defaults if not set).
+     */
+    void setProfile(const OutputProfile& profile) { profile_ = profile; }
+    const OutputProfile& getProfile() const { return profile_; }
+
     /**
      * Constructs the file path for the PLUTO simulation output file.
      *
@@ -56,43 +65,89 @@ public:
     static std::string getDataFilePath(
         const std::string& model_name, Int_t iteration);
 
+    /**
+     * Constructs the path of the file holding both the PLUTO tree and the
+     * calculated values (single-file output).
+     *
+     * @param model_name Name of the model used in the simulation.
+     * @param iteration Iteration number of the simulation run.
+     * @return String representing the absolute file path for the combined file.
+     */
+    static std::string getCombinedFilePath(
+        const std::string& model_name, Int_t iteration);
+
     /**
      * Constructs the file path for storing proton momentum and scattering angle data.
      *
      * @param model_name Name of the model used in the simulation.
      * @param iteration Iteration number of the simulation run.
+     * @param format Format of the file, which selects its extension.
      * @return String representing the absolute file path for the proton data file.
      */
     static std::string getProtonFilePath(
+        const std::string& model_name, Int_t iteration,
+        ProtonDataWriter::Format format = ProtonDataWriter::kText);
+
+    /**
+     * Constructs the path of the Arrow IPC file of the calculated values.
+     *
+     * @param model_name Name of the model used in the simulation.
+     * @param iteration Iteration number of the simulation run.
+     * @return String representing the absolute file path for the Arrow file.
+     */
+    static std::string getArrowFilePath(
         const std::string& model_name, Int_t iteration);
 
     /**
-     * Writes a TTree structure to a ROOT file.
+     * Constructs the path for the histograms of the calculated values.
      *
-     * The function creates a ROOT file in "RECREATE" mode, ensuring that any 
-     * existing file with the same name is overwritten.
+     * @param model_name Name of the model used in the simulation.
+     * @param iteration Iteration number of the simulation run.
+     * @return String representing the absolute file path for the histogram file.
+     */
+    static std::string getHistogramFilePath(
+        const std::string& model_name, Int_t iteration);
+
+    /**
+     * Constructs the path of the checkpoint of the simulation runs of a model.
      *
-     * @param tree Pointer to the ROOT TTree structure to be written.
-     * @param file_name Path to the file where the TTree should be written.
+     * @param model_name Name of the model used in the simulation.
+     * @return String representing the absolute path of the checkpoint file.
      */
-    void writeTreeToFile(TTree* tree, const std::string& file_name);
+    static std::string getCheckpointPath(const std::string& model_name);
 
     /**
-     * Writes proton momentum and scattering angle data to a plain text file.
+     * Opens a ROOT file for a tree filled event by event.
      *
-     * This function exports a vector of pairs, where each pair represents effective
-     * proton momentum and scattering angle, to a specified text file. 
-     * The data is written in a tab-separated format, with each pair on a new line.
+     * The file is created in "RECREATE" mode, overwriting any existing file
+     * with the same name, or opened in "UPDATE" mode to append to the tree
+     * of a resumed run. Trees created afterwards are written to this file.
+     * New files are compressed according to the output profile; resumed
+     * files keep their settings.
      *
-     * @param data Vector of pairs, where the first element represents the proton 
-     *             momentum and the second element represents the scattering angle.
-     * @param file_name Path to the text file to which the data should be written.
+     * @param file_name Path to the file.
+     * @param resume Open the existing file for appending.
+     * @return Pointer to the open file, or NULL on failure.
      */
-    void writeProtonData(
-        const std::vector<std::pair<Double_t, Double_t> >& data, 
-        const std::string& file_name);
+    TFile* openTreeFile(const std::string& file_name, Bool_t resume = false);
+
+    /**
+     * Writes the tree to its file and closes the file.
+     *
+     * @param file Pointer to the file opened by openTreeFile(); set to NULL.
+     * @param tree Pointer to the tree owned by the file.
+     */
+    void closeTreeFile(TFile*& file, TTree* tree);
+
+    /**
+     * Sets the basket and cluster size of the output profile for a new tree
+     * once its branches are created.
+     */
+    void configureTree(TTree* tree) const { profile_.apply(tree); }
 
 private:
+    OutputProfile profile_;
+
     /**
      * Converts a relative file path to an absolute path.
      *
@@ -29,10 +29,22 @@
 #ifndef EVENT_GENERATOR_H
 #define EVENT_GENERATOR_H
 
+#include "acceptance_filter.h"
+#include "arrow_writer.h"
 #include "data_writer.h"
+#include "event_catalogue.h"
+#include "GINFile.hh"
+#include "histogram_bank.h"
+#include "precision_spec.h"
+#include "proton_data_writer.h"
+#include "run_checkpoint.h"
+#include "simulation_options.h"
+#include "spsc_ring.h"
+#include <pthread.h>
 #include <string>
 #include <vector>
 #include "Rtypes.h"
+#include "TStopwatch.h"
 #include "TGraph.h"
 #include "TTree.h"
 #include "TClonesArray.h"
@@ -54,6 +66,39 @@ struct ParticleData {
         : name(n), vector(v) {}
 };
 
+/**
+ * @struct EventRecord
+ * @brief Outgoing particles and calculated values of one generated event,
+ *        handed from the generation to the output.
+ */
+struct EventRecord {
+    std::vector<ParticleData> particles;
+    Int_t accepted;     ///< Event inside the acceptance (1 without a filter).
+    Bool_t passed;      ///< Event passed to WMC (PLUTO file or WMC input).
+    Double_t beam_momentum_lab;
+    Double_t beam_energy_lab;
+    Double_t beam_momentum_cm;
+    Double_t beam_energy_cm;
+    Double_t inv_mass_pd;
+    Double_t target_neutron_momentum_cm;
+    Double_t target_neutron_theta_cm;
+    Double_t target_neutron_phi_cm;
+    Double_t target_proton_momentum_cm;
+    Double_t target_proton_theta_cm;
+    Double_t target_proton_phi_cm;
+    Double_t proton_proton_angle;
+    Double_t inv_mass_pp;
+    Double_t effective_proton_mass;
+    Double_t effective_proton_momentum;
+    Double_t beam_proton_momentum_pp;
+    Double_t target_proton_momentum_pp;
+    Double_t beam_proton_theta_scat_cm;
+    Double_t beam_proton_phi_scat_cm;
+    Double_t target_proton_theta_scat_cm;
+    Double_t target_proton_phi_scat_cm;
+    Double_t target_proton_energy_cm;
+};
+
 /**
  * @class EventGenerator
  * @brief Manages the generation of simulation events for the quasi-elastic 
@@ -77,25 +122,114 @@ public:
      *                           values should be stored.
      * @param proton_data_file Path for saving proton data, including
      *        effective momentum and scattering angles.
+     * @param gin_file Optional open WMC input file (GINFile format). If set,
+     *                 the outgoing particles are written to it event by event
+     *                 instead of to the PLUTO file.
      */
     EventGenerator(
         TGraph* graph, DataWriter& writer, 
         const std::string& pluto_data_file, 
         const std::string& analysis_data_file, 
-        const std::string& proton_data_file);
+        const std::string& proton_data_file,
+        GINFile* gin_file = NULL);
 
     /**
      * Destructs an EventGenerator instance
      */
     ~EventGenerator();
 
+    /**
+     * Enables checkpoints of the run every interval events and at the end
+     * of the output files of this generator.
+     *
+     * @param checkpoint State of the run, updated as events are committed.
+     * @param path Path of the checkpoint file.
+     * @param interval Number of events between checkpoints (0 - only at
+     *                 the end of the files).
+     */
+    void enableCheckpoints(RunCheckpoint* checkpoint, const std::string& path,
+                           Long64_t interval);
+
+    /**
+     * Checks the outgoing particles of every event against the acceptance
+     * windows of filter (not owned, NULL - all events are passed to WMC).
+     * Rejected events are left out of the PLUTO file and the WMC input, or
+     * flagged in its Accepted branch; the calculated values keep every
+     * generated event and get an "accepted" column.
+     */
+    void setAcceptance(const AcceptanceFilter* filter) { acceptance_ = filter; }
+
+    /**
+     * Fills the histograms of bank (not owned) with the calculated values
+     * of every generated event and writes them to file_name with each
+     * checkpoint and at the end of the files.
+     */
+    void setHistograms(HistogramBank* bank, const std::string& file_name);
+
+    /**
+     * Enables or disables the per-event output of the calculated values
+     * (the "values" tree and the proton data text file); enabled by default.
+     */
+    void setValuesTree(Bool_t enabled) { values_tree_ = enabled; }
+
+    /**
+     * Stores the columns of spec (not owned, NULL - all in full precision)
+     * with reduced precision in the "values" tree. The histograms are
+     * filled with the full-precision values.
+     */
+    void setPrecision(PrecisionSpec* spec) { precision_ = spec; }
+
+    /**
+     * Writes the calculated values of columns (empty - all) of every
+     * generated event to the Arrow IPC file file_name, independently of
+     * the "values" tree.
+     */
+    void setArrowOutput(const std::string& file_name,
+                        const std::vector<std::string>& columns);
+
+    /**
+     * Selects the format of the proton data file (text by default).
+     */
+    void setProtonFormat(ProtonDataWriter::Format format) { proton_format_ = format; }
+
+    /**
+     * Writes the calculated values as the tree "values" into the PLUTO file
+     * (the same path is then given for both), with the PLUTO tree "data" as
+     * its friend and both trees flushed in clusters of the same entries.
+     * Every generated event must be written to the PLUTO tree.
+     */
+    void setSingleFile(Bool_t enabled) { single_file_ = enabled; }
+
+    /**
+     * Records the completed output files in the catalogues of their
+     * directories with the description of run, whose first_event is the
+     * first generated event of the files in the run.
+     */
+    void setCatalogue(const EventCatalogue::Entry& run)
+    {
+        with_catalogue_ = true;
+        catalogue_run_ = run;
+    }
+
+    /**
+     * Writes the events by a separate thread, so that the generation is not
+     * stalled by the compression of the output. The events are handed over
+     * in a ring of preallocated slots; the generation waits while it is
+     * full. The output is the same as when written inline (0 slots, the
+     * default). ROOT must have been initialised for threads.
+     */
+    void setAsyncOutput(Int_t slots) { async_slots_ = slots; }
+
     /**
      * Generates a specified number of simulation events for the quasi-elastic 
      * proton-deuteron scattering reaction.
      *
      * @param num_events Number of events to generate. Defaults to 1000.
+     * @param first_event Number of events already generated for the output
+     *                    files; they are appended to if not 0.
+     * @return false if the output files could not be opened.
      */
-    void generateEvents(Int_t num_events = 1000);
+    Bool_t generateEvents(Int_t num_events = 1000, Long64_t first_event = 0);
 
     /**
     * Manages the simulation runs for a specific potential model.
@@ -104,21 +238,64 @@ public:
     * generation of event data and its output to designated files, thus using 
     * the capabilities of the EventGenerator and DataWriter classes.
     *
-    * @param model_name Name of the nucleon-nucleon potential model used 
-    *                   in the simulation.
+    * The run is checkpointed (see DataWriter::getCheckpointPath), so that an
+    * interrupted run can be resumed and a finished run can be extended by
+    * more events with the random number stream continuing. Extended runs
+    * fill the last file up to the number of events per iteration and
+    * continue with new files. With an acceptance filter the number of
+    * events counts the generated events, including the rejected ones.
+    *
+    * @param options Model, number of events and iterations, WMC input file
+    *                (e.g. a named pipe read by WMC as fort.31 receiving the
+    *                events of all iterations in the GINFile format) and the
+    *                checkpoint settings.
     * @param graph Pointer to a TGraph object containing the nucleon momentum 
     *              distribution data for the specified model.
-    * @param num_events Number of events generated per each simulation iteration.
-    *                   Defaults to 1000.
-    * @param num_iterations Total number of iterations to run. Defaults to 1.
+    * @return true on success, false if the output could not be opened or
+    *         the run could not be continued.
     */
-    static void runSimulations(
-        const std::string& model_name, TGraph* graph, 
-        Int_t num_events = 1000, Int_t num_iterations = 1);
+    static Bool_t runSimulations(
+        const SimulationOptions& options, TGraph* graph);
+
+    /**
+     * Returns the GEANT particle code used by WMC for a PLUTO particle name,
+     * or 0 if the particle is not known.
+     */
+    static Int_t getGeantId(const std::string& name);
 
 private:
-    void setupTree();   ///< Initialises tree structures for data storage.
-    void cleanup();     ///< Frees allocated resources.
+    /**
+     * Opens the output files and initialises the tree structures for data
+     * storage; resumed files are cut to their committed events.
+     *
+     * @param first_event Number of generated events committed to the
+     *                    files (0 - new files).
+     * @return false if a file could not be opened.
+     */
+    Bool_t setupTree(Long64_t first_event);
+
+    /**
+     * Checks that every column of the precision specification is a column
+     * of the "values" tree.
+     */
+    Bool_t isPrecisionBound() const;
+    void attachColumn(const char* name, std::vector<Double_t>& column,
+                      Bool_t resume);
+    void saveCheckpoint();  ///< Commits the events written so far.
+    void writeEvent(const EventRecord& record);  ///< Fills all outputs.
+
+    /**
+     * Returns the record for the next event: a free slot of the ring (waiting
+     * while it is full) or the record written inline.
+     */
+    EventRecord* claimRecord();
+    void commitRecord();    ///< Writes the claimed record or queues it.
+    void drainRecords();    ///< Waits until the writer thread is idle.
+    Bool_t startWriter();   ///< Starts the writer thread if enabled.
+    void stopWriter();      ///< Writes the queued records and joins the thread.
+    static void* writerLoop(void* generator);
+    void cleanup();     ///< Writes the trees and frees allocated resources.
+    void catalogueFiles();  ///< Records the closed output files.
 
     /**
      * Sets the particle data for the current simulation event.
@@ -135,9 +312,51 @@ private:
         TClonesArray* particles_array, 
         const std::vector<ParticleData>& particles_data);
 
+    /**
+     * Writes the outgoing particles of the current event to the WMC input.
+     */
+    void writeGinEvent(
+        const std::vector<ParticleData>& particles_data, 
+        Double_t beam_momentum);
+
     DataWriter& writer_;   ///< Manages output of simulation data.
+    GINFile* gin_file_;    ///< WMC input file, or NULL if not streamed.
+
+    ProtonDataWriter proton_data_; ///< Proton data (momentum and scattering angle).
+    ProtonDataWriter::Format proton_format_;
+
+    ArrowWriter arrow_;            ///< Calculated values as Arrow batches.
+    std::string arrow_data_file_;  ///< Empty - no Arrow file.
+
+    RunCheckpoint* checkpoint_;    ///< Run state, or NULL without checkpoints.
+    std::string checkpoint_path_;
+    Long64_t checkpoint_interval_;
+    Long64_t file_events_;         ///< Events written to the PLUTO file.
+    Long64_t file_generated_;      ///< Events generated for the current files.
+    Long64_t file_accepted_;       ///< Generated events in the acceptance.
 
-    std::vector<std::pair<Double_t, Double_t> > proton_data;  ///< Stores proton data (momentum and scattering angle).
+    const AcceptanceFilter* acceptance_;   ///< NULL - no acceptance filter.
+    HistogramBank* histograms_;    ///< NULL - no histograms are filled.
+    std::string histogram_file_;
+    Bool_t values_tree_;           ///< Per-event calculated values are written.
+    PrecisionSpec* precision_;     ///< NULL - all columns in full precision.
+    /// Reduced columns and the vectors holding their values.
+    std::vector<std::pair<PrecisionSpec::Column*, const std::vector<Double_t>*> >
+        reduced_columns_;
+
+    Bool_t single_file_;           ///< Both trees in the PLUTO file.
+    Bool_t with_catalogue_;        ///< Completed files are catalogued.
+    EventCatalogue::Entry catalogue_run_;
+
+    EventRecord record_;           ///< Record of an event written inline.
+    Int_t async_slots_;            ///< Ring slots, 0 - no writer thread.
+    SpscRing<EventRecord>* ring_;  ///< Events queued for the writer thread.
+    pthread_t writer_thread_;
+    volatile Bool_t writer_stop_;  ///< No further events are queued.
+    Long64_t ring_stalls_;         ///< Events which waited for a free slot.
+    Long64_t writer_waits_;        ///< Polls of the writer on an empty ring.
+    size_t ring_peak_;             ///< Maximum number of queued events.
+    TStopwatch stall_timer_;       ///< Time the generation waited.
 
     std::string pluto_data_file_;
     std::string analysis_data_file_;
@@ -145,13 +364,17 @@ private:
 
     TGraph* graph_;
 
+    TFile* pluto_file_;        ///< PLUTO output, NULL if streamed to WMC.
+    TFile* data_file_;         ///< Output of the calculated values, or NULL.
+
     TTree* particles_tree_;    ///< Stores data about the outgoing particles.
     Int_t   Npart_;    ///< Number of outgoing particles per event.
     Float_t Impact_;
     Float_t Phi_;
+    Int_t Accepted_;   ///< Acceptance flag of the event (flag mode).
     TClonesArray* particles_;    ///< Array of the outgoing particles per event.
 
-    TTree* data_tree_;    ///< Stores calculated values.
+    TTree* data_tree_;    ///< Stores calculated values (NULL - not written).
     std::vector<Double_t> beam_momentum_lab_;
     std::vector<Double_t> beam_energy_lab_;
     std::vector<Double_t> beam_momentum_cm_;
@@ -174,6 +397,7 @@ private:
     std::vector<Double_t> beam_proton_phi_scat_cm_;
     std::vector<Double_t> target_proton_theta_scat_cm_;
     std::vector<Double_t> target_proton_phi_scat_cm_;
+    std::vector<Double_t> accepted_;
 
 
 void clearVectors();
@@ -0,0 +1,96 @@
+/**
+ * @file histogram_bank.h
+ * @author AK <alex.nuclearboy@gmail.com>
+ * @brief Declaration of the HistogramBank class, which fills histograms of
+ *        the calculated values during the event generation.
+ *
+ * Most of the "values" tree ends up in a few dozen histograms. The bank
+ * fills a configurable set of 1D and 2D histograms of the calculated values
+ * event by event, so that the per-event tree can be left out and the
+ * analysis does not need to read the events again. The histograms are
+ * defined in a text file, one per line:
+ *
+ *     h1 <name> <variable> <bins> <min> <max>
+ *     h2 <name> <x variable> <bins> <min> <max> <y variable> <bins> <min> <max>
+ *
+ * where the variables are the column names of the "values" tree (angles in
+ * rad, momenta in GeV/c); lines starting with '#' are comments.
+ *
+ * Every generator fills its own bank; the banks of several generators (or
+ * of a run before it was interrupted) are added with merge() or hadd.
+ *
+ * @date 2026-10-18
+ *
+ * @note Distributed under the GNU General Public License version 3.0 (GPLv3).
+ */
+
+#ifndef HISTOGRAM_BANK_H
+#define HISTOGRAM_BANK_H
+
+#include <string>
+#include <vector>
+#include "Rtypes.h"
+#include "TH1.h"
+
+/**
+ * @class HistogramBank
+ * @brief Configurable set of histograms filled from the calculated values.
+ */
+class HistogramBank {
+public:
+    HistogramBank();
+    ~HistogramBank();
+
+    /**
+     * Reads the histogram definitions.
+     *
+     * @param config_file Path to the definition file.
+     * @return false if the file cannot be read or holds an invalid line.
+     */
+    Bool_t load(const std::string& config_file);
+
+    /**
+     * Binds a column of calculated values to the histograms using it.
+     * The column holds the value of the current event when fill() is called.
+     */
+    void bind(const std::string& variable, const std::vector<Double_t>* column);
+
+    /**
+     * Checks that every variable of the definitions is bound to a column.
+     */
+    Bool_t isBound() const;
+
+    /**
+     * Fills all histograms with the values of the current event.
+     */
+    void fill();
+
+    /**
+     * Adds the histograms stored in a file by write() to the bank.
+     *
+     * @return Number of events filled into the stored histograms, or -1 if
+     *         the file or one of the histograms is missing.
+     */
+    Long64_t merge(const std::string& file_name);
+
+    /**
+     * Writes all histograms and the number of events filled into them
+     * ("EventsFilled") to a file, replacing it through a rename.
+     *
+     * @return false if the file cannot be written.
+     */
+    Bool_t write(const std::string& file_name, Long64_t events) const;
+
+private:
+    struct Histogram {
+        TH1* histogram;
+        std::string x_variable;
+        std::string y_variable;    ///< Empty for 1D histograms.
+        const std::vector<Double_t>* x_column;
+        const std::vector<Double_t>* y_column;
+    };
+
+    std::vector<Histogram> histograms_;
+};
+
+#endif // HISTOGRAM_BANK_H
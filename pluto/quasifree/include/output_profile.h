@@ -0,0 +1,73 @@
+/**
+ * @file output_profile.h
+ * @author AK <alex.nuclearboy@gmail.com>
+ * @brief Compression and basket layout of the ROOT output files.
+ *
+ * The generator writes the same trees millions of times, so the storage
+ * and the read speed of the files matter more than the ROOT defaults. An
+ * output profile sets the compression of the file and the basket size and
+ * cluster size (AutoFlush) of its trees:
+ * - default: ROOT defaults, as written by the earlier versions;
+ * - none:    no compression, for files read once and deleted;
+ * - fast:    LZ4 (ZLIB level 1 before ROOT 6.12), fast to write and read;
+ * - archive: ZSTD (LZMA before ROOT 6.20), for files kept long term.
+ * compression_benchmark measures the profiles on the actual output trees.
+ *
+ * @date 2026-10-18
+ *
+ * @note Distributed under the GNU General Public License version 3.0 (GPLv3).
+ */
+
+#ifndef OUTPUT_PROFILE_H
+#define OUTPUT_PROFILE_H
+
+#include <string>
+#include <vector>
+#include "Rtypes.h"
+#include "TFile.h"
+#include "TTree.h"
+
+/**
+ * @struct OutputProfile
+ * @brief Compression and basket settings of the output files and trees.
+ */
+struct OutputProfile {
+    std::string name;
+    Int_t compression;      ///< 100 * algorithm + level, -1 - ROOT default.
+    Int_t basket_size;      ///< Bytes per branch basket, 0 - ROOT default.
+    Long64_t auto_flush;    ///< TTree::SetAutoFlush (< 0 bytes, > 0 entries),
+                            ///< 0 - ROOT default.
+
+    OutputProfile()
+        : name("default"), compression(-1), basket_size(0), auto_flush(0) {}
+
+    /**
+     * Looks up a profile by its name.
+     *
+     * @return false if the name is not known.
+     */
+    static Bool_t get(const std::string& name, OutputProfile& profile);
+
+    /**
+     * Returns the names of all profiles.
+     */
+    static std::vector<std::string> names();
+
+    /**
+     * Sets the compression of a newly created file.
+     */
+    void apply(TFile* file) const;
+
+    /**
+     * Sets the basket and cluster size of a new tree; called after its
+     * branches were created.
+     */
+    void apply(TTree* tree) const;
+
+    /**
+     * Returns a readable description, e.g. "fast (LZ4 level 4, ...)".
+     */
+    std::string describe() const;
+};
+
+#endif // OUTPUT_PROFILE_H
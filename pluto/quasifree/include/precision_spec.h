@@ -0,0 +1,99 @@
+/**
+ * @file precision_spec.h
+ * @author AK <alex.nuclearboy@gmail.com>
+ * @brief Reduced-precision storage of the columns of the "values" tree.
+ *
+ * The calculated values are stored as double precision vectors by
+ * default, although angles and momenta need far less than 1e-15 relative
+ * precision. A precision specification lists the columns to be stored with
+ * fewer bits, one per line:
+ *
+ *     <column> float
+ *     <column> float16  <min> <max> <bits>
+ *     <column> double32 <min> <max> <bits>
+ *
+ * "float" stores a 32-bit float. "float16" and "double32" store the value
+ * truncated by ROOT (Float16_t, Double32_t): with min < max as an integer
+ * of <bits> bits (up to 32) over the range (values outside are clipped),
+ * or with min = max = 0 as a float with a mantissa of <bits> bits (up to
+ * 14) in 3 bytes. Float16_t and
+ * Double32_t leaves need ROOT 6.16 or newer. Lines starting with '#' are
+ * comments; columns not listed keep full precision. The generator fails if
+ * a listed name is not a column of the tree.
+ *
+ * Reduced columns are scalar leaves (one value per entry) instead of the
+ * vectors of the full-precision columns. precision_report measures the
+ * precision lost on the output of a full-precision run.
+ *
+ * @date 2026-10-18
+ *
+ * @note Distributed under the GNU General Public License version 3.0 (GPLv3).
+ */
+
+#ifndef PRECISION_SPEC_H
+#define PRECISION_SPEC_H
+
+#include <string>
+#include <vector>
+#include "Rtypes.h"
+#include "TTree.h"
+
+/**
+ * @class PrecisionSpec
+ * @brief Storage types of the columns of the "values" tree.
+ */
+class PrecisionSpec {
+public:
+    enum Type { kDouble, kFloat, kFloat16, kDouble32 };
+
+    struct Column {
+        std::string name;
+        Type type;
+        Double_t min;
+        Double_t max;
+        Int_t bits;
+        Float_t float_value;    ///< Buffer of the float leaves.
+        Double_t double_value;  ///< Buffer of the double leaves.
+    };
+
+    /**
+     * Reads the specification.
+     *
+     * @return false if the file cannot be read or holds an invalid line.
+     */
+    Bool_t load(const std::string& file_name);
+
+    /**
+     * Returns the column of a name, or NULL if it keeps full precision.
+     * The column stays valid until the next load().
+     */
+    Column* find(const std::string& name);
+
+    const std::vector<Column>& columns() const { return columns_; }
+
+    /**
+     * Creates the branch of a reduced column, or connects it to the buffer
+     * of the column if the tree is read or continued.
+     */
+    static void branch(TTree* tree, Column& column, Bool_t exists);
+
+    /**
+     * Stores a value in the buffer of the column, filled by TTree::Fill.
+     */
+    static void set(Column& column, Double_t value);
+
+    /**
+     * Returns the value in the buffer of the column (after TTree::GetEntry).
+     */
+    static Double_t get(const Column& column);
+
+    /**
+     * Returns the storage type, e.g. "float16[0,3.1416,12]".
+     */
+    static std::string describe(const Column& column);
+
+private:
+    std::vector<Column> columns_;
+};
+
+#endif // PRECISION_SPEC_H
@@ -0,0 +1,107 @@
+/**
+ * @file proton_data_writer.h
+ * @author AK <alex.nuclearboy@gmail.com>
+ * @brief Declaration of the ProtonDataWriter class, which streams the proton
+ *        momentum and scattering angle of every event to a file.
+ *
+ * The proton data are written in large blocks while the events are
+ * generated, so the memory used does not grow with the number of events.
+ * Two formats are supported:
+ * - text:   one tab-separated "momentum theta" pair per line (6 significant
+ *           digits), as written by the earlier versions;
+ * - binary: a 16-byte header followed by fixed-size records of two 32-bit
+ *           floats (effective proton momentum [GeV/c], beam proton
+ *           scattering angle in the pp CM frame [rad]) in the byte order of
+ *           the generating machine (little-endian on x86). The header holds
+ *           the magic "PPNP", the format version, the record size in bytes
+ *           and a reserved word, all as 32-bit integers after the magic.
+ *
+ * The binary file is read e.g. with numpy:
+ *     numpy.fromfile(path, dtype='<f4', offset=16).reshape(-1, 2)
+ *
+ * @date 2026-10-18
+ *
+ * @note Distributed under the GNU General Public License version 3.0 (GPLv3).
+ */
+
+#ifndef PROTON_DATA_WRITER_H
+#define PROTON_DATA_WRITER_H
+
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "Rtypes.h"
+
+/**
+ * @class ProtonDataWriter
+ * @brief Buffered writer of the proton data in the text or binary format.
+ */
+class ProtonDataWriter {
+public:
+    enum Format { kText, kBinary };
+
+    ProtonDataWriter();
+    ~ProtonDataWriter();    ///< Flushes and closes an open file.
+
+    /**
+     * Converts a format name ("text" or "binary") to the format.
+     *
+     * @return false if the name is not known.
+     */
+    static Bool_t parseFormat(const std::string& name, Format& format);
+
+    /**
+     * Returns the file name extension of a format (".txt" or ".bin").
+     */
+    static const char* extension(Format format);
+
+    /**
+     * Opens the file for writing.
+     *
+     * @param file_name Path to the file.
+     * @param format Format of the file.
+     * @param offset Number of bytes of an existing file to keep (resumed
+     *               runs); 0 overwrites the file.
+     * @return true if the file is open.
+     */
+    Bool_t open(const std::string& file_name, Format format, Long64_t offset = 0);
+
+    /**
+     * Appends the proton data of an event to the buffer, writing the buffer
+     * to the file when it is full.
+     */
+    void write(Double_t momentum, Double_t theta);
+
+    /**
+     * Writes the buffered records to the file.
+     *
+     * @return false on a write error.
+     */
+    Bool_t flush();
+
+    /**
+     * Flushes the buffer and closes the file.
+     *
+     * @return false on a write error.
+     */
+    Bool_t close();
+
+    Bool_t isOpen() const { return file_ != NULL; }
+
+    /**
+     * Returns the number of bytes written to the file, excluding the buffer;
+     * after flush() the size of the complete file.
+     */
+    Long64_t offset() const { return offset_; }
+
+private:
+    FILE* file_;
+    std::string file_name_;
+    Format format_;
+    std::vector<char> buffer_;
+    size_t used_;           ///< Bytes used in the buffer.
+    Long64_t offset_;       ///< Bytes written to the file.
+    Bool_t failed_;         ///< A write error occurred.
+};
+
+#endif // PROTON_DATA_WRITER_H
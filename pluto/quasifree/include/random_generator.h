@@ -56,6 +56,16 @@ public:
         rng.SetSeed(seed);
     }
 
+    /**
+     * Gives access to the underlying engine, e.g. to save and restore its
+     * state in a run checkpoint.
+     *
+     * @return Reference to the TRandom3 engine.
+     */
+    TRandom3& getEngine() {
+        return rng;
+    }
+
 private:
     TRandom3 rng;   ///< Underlying ROOT TRandom3 random number generator.
 };
@@ -0,0 +1,71 @@
+/**
+ * @file simulation_options.h
+ * @author AK <alex.nuclearboy@gmail.com>
+ * @brief Settings of a simulation run taken from the command line.
+ *
+ * The options defining the output of a run are recorded in its checkpoint
+ * (see run_checkpoint.h); a resumed or extended run parses them again
+ * instead of taking them from its own command line.
+ *
+ * @date 2026-10-18
+ *
+ * @note Distributed under the GNU General Public License version 3.0 (GPLv3).
+ */
+
+#ifndef SIMULATION_OPTIONS_H
+#define SIMULATION_OPTIONS_H
+
+#include <map>
+#include <string>
+#include <vector>
+#include "Rtypes.h"
+
+// Defaults of the simulation
+const Int_t NUM_EVENTS = 1000;
+const Int_t NUM_ITERATIONS = 2;
+const Long64_t CHECKPOINT_INTERVAL = 100000;
+
+/**
+ * @struct SimulationOptions
+ * @brief Settings of a simulation run taken from the command line.
+ */
+struct SimulationOptions {
+    std::string model_name;     ///< Nucleon momentum distribution model.
+    Int_t num_events;           ///< Events per iteration.
+    Int_t num_iterations;       ///< Number of iterations (output files).
+    std::string gin_file;       ///< WMC input file or pipe, empty if unused.
+    Long64_t checkpoint_interval;   ///< Events between checkpoints.
+    Bool_t resume;              ///< Continue the run of the checkpoint.
+    Long64_t extend_events;     ///< Events appended to a finished run.
+    UInt_t seed;                ///< Seed of a new run, 0 - system clock.
+    std::string acceptance_file;    ///< Acceptance windows, empty if unused.
+    std::string acceptance_mode;    ///< "drop" or "flag" rejected events.
+    std::string histogram_file;     ///< Histogram definitions, empty if unused.
+    Bool_t values_tree;         ///< Write the per-event calculated values.
+    std::string proton_format;  ///< "text" or "binary", empty - binary.
+    Int_t async_slots;          ///< Slots of the writer thread, 0 - inline.
+    std::string output_profile; ///< Compression profile, empty - ROOT default.
+    Bool_t single_file;         ///< PLUTO and values trees in one file.
+    std::string precision_file; ///< Reduced-precision columns, empty if unused.
+    std::string arrow_columns;  ///< Columns of the Arrow file, empty if unused.
+
+    /// Options of the run configuration as given ("--name" -> value, empty
+    /// for flags); all but the model and the options of a single session
+    /// (--resume, --extend, --checkpoint, --async).
+    std::map<std::string, std::string> recorded;
+
+    SimulationOptions()
+        : num_events(NUM_EVENTS), num_iterations(NUM_ITERATIONS),
+          checkpoint_interval(CHECKPOINT_INTERVAL), resume(false),
+          extend_events(0), seed(0), acceptance_mode("drop"),
+          values_tree(true), async_slots(0), single_file(false) {}
+
+    /**
+     * Parses command-line arguments (without the program name).
+     *
+     * @return true if the arguments are valid, false otherwise.
+     */
+    Bool_t parse(const std::vector<std::string>& args);
+};
+
+#endif // SIMULATION_OPTIONS_H
@@ -0,0 +1,91 @@
+/**
+ * @file spsc_ring.h
+ * @author AK <alex.nuclearboy@gmail.com>
+ * @brief Bounded lock-free ring buffer between one producer and one consumer
+ *        thread.
+ *
+ * The slots are allocated once and reused: the producer claims the next free
+ * slot, fills it in place and publishes it; the consumer reads the oldest
+ * published slot and releases it. Neither side blocks, claim() and front()
+ * return NULL if the ring is full or empty and the caller decides how to
+ * wait. The indices are only written by their own side, ordered by full
+ * memory barriers (GCC builtins, as C++98 has no atomics).
+ *
+ * @date 2026-10-18
+ *
+ * @note Distributed under the GNU General Public License version 3.0 (GPLv3).
+ */
+
+#ifndef SPSC_RING_H
+#define SPSC_RING_H
+
+#include <cstddef>
+#include <vector>
+
+template <class T>
+class SpscRing {
+public:
+    explicit SpscRing(size_t capacity)
+        : slots_(capacity + 1), head_(0), tail_(0) {}
+
+    size_t capacity() const { return slots_.size() - 1; }
+
+    /**
+     * Returns the number of published slots not yet released.
+     */
+    size_t size() const
+    {
+        size_t head = head_;
+        size_t tail = tail_;
+        return (head + slots_.size() - tail) % slots_.size();
+    }
+
+    /**
+     * Producer: returns the next free slot, or NULL if the ring is full.
+     */
+    T* claim()
+    {
+        size_t next = (head_ + 1) % slots_.size();
+        if (next == tail_) return NULL;
+        __sync_synchronize();   // The consumer is done with the slot
+        return &slots_[head_];
+    }
+
+    /**
+     * Producer: hands the slot returned by claim() to the consumer.
+     */
+    void publish()
+    {
+        __sync_synchronize();   // The slot is filled before it is published
+        head_ = (head_ + 1) % slots_.size();
+    }
+
+    /**
+     * Consumer: returns the oldest published slot, or NULL if none.
+     */
+    T* front()
+    {
+        if (tail_ == head_) return NULL;
+        __sync_synchronize();   // The slot is read after it was published
+        return &slots_[tail_];
+    }
+
+    /**
+     * Consumer: returns the slot returned by front() to the producer.
+     */
+    void release()
+    {
+        __sync_synchronize();   // The slot is read before it is reused
+        tail_ = (tail_ + 1) % slots_.size();
+    }
+
+private:
+    SpscRing(const SpscRing&);
+    SpscRing& operator=(const SpscRing&);
+
+    std::vector<T> slots_;
+    volatile size_t head_;  ///< Next slot to fill, written by the producer.
+    volatile size_t tail_;  ///< Next slot to read, written by the consumer.
+};
+
+#endif // SPSC_RING_H
@@ -4,13 +4,16 @@ GINFile::GINFile(char *conf)
     fMaxPart = 30;
     fPart = 0;
     fEvent = 0;
+    fout = 0;
     if (conf) printf("Configuretion from: %s\n", conf);
     return;
 }
 int GINFile::Close()
 {
     // Close the output file
+    if (!fout) return 1;
     fclose(fout);
+    fout = 0;
     return 0;
 }
 int GINFile::AddParticle(int type, const TLorentzVector *p)
@@ -37,7 +40,10 @@ int GINFile::WriteEvent(float weight)
 }
 int GINFile::WriteHeader(const char *fnam, int reac, float pz, int nev)
 {
+    // The output may also be a named pipe read by WMC as fort.31;
+    // fopen then waits until WMC opens it
     fout = fopen(fnam, "w");
+    if (!fout) return 1;
     fReac = reac;
     fBeamPz = pz;
     int fform = 10000000 + reac;
@@ -0,0 +1,471 @@
+/**
+ * @file arrow_writer.cpp
+ * @author AK <alex.nuclearboy@gmail.com>
+ * @brief Implementation of the ArrowWriter class.
+ *
+ * Layout of the file (Arrow columnar format, IPC file format, metadata
+ * version 5):
+ *
+ *     "ARROW1\0\0"
+ *     schema message
+ *     record batch messages
+ *     end-of-stream marker (0xFFFFFFFF 0x00000000)
+ *     footer (FlatBuffer), footer size (int32), "ARROW1"
+ *
+ * Every message is a continuation marker 0xFFFFFFFF, the size of its
+ * metadata (int32), the metadata (FlatBuffer "Message", padded to 8 bytes)
+ * and the body. The body of a record batch holds the values of every
+ * column one after the other (no validity bitmaps, no compression).
+ *
+ * @date 2026-10-18
+ *
+ * @note Distributed under the GNU General Public License version 3.0 (GPLv3).
+ */
+
+#include "arrow_writer.h"
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <unistd.h>
+
+namespace {
+    const size_t BATCH_ROWS = 65536;    ///< Rows per record batch.
+    const char MAGIC[8] = { 'A', 'R', 'R', 'O', 'W', '1', 0, 0 };
+    const UInt_t CONTINUATION = 0xFFFFFFFF;
+
+    // Enumerations of the Arrow schema (format/Schema.fbs, Message.fbs)
+    const Int_t METADATA_V5 = 4;
+    const Int_t HEADER_SCHEMA = 1;
+    const Int_t HEADER_RECORD_BATCH = 3;
+    const Int_t TYPE_FLOATING_POINT = 3;
+    const Int_t PRECISION_DOUBLE = 2;
+
+    /**
+     * Minimal FlatBuffer builder. Objects are appended front to back, a
+     * table before the objects it refers to (offsets point forward), and
+     * the references are set once the objects are written. Scalars are
+     * stored little-endian, as FlatBuffers require.
+     */
+    class FlatBuilder {
+    public:
+        FlatBuilder() : data_(4, 0) {}     // Offset of the root table
+
+        const std::vector<unsigned char>& data() const { return data_; }
+
+        /**
+         * Appends a table with fields of the given sizes in bytes (0 -
+         * absent) and returns its position; fields receives the position
+         * of every field.
+         */
+        size_t table(const Int_t* sizes, Int_t count, size_t* fields)
+        {
+            // Largest fields first, none needs padding after the 4-byte
+            // vtable offset if the table starts at 4 modulo 8
+            std::vector<UShort_t> offsets(count, 0);
+            size_t inline_size = 4;
+            for (Int_t size = 8; size >= 1; size /= 2) {
+                for (Int_t i = 0; i < count; ++i) {
+                    if (sizes[i] != size) continue;
+                    offsets[i] = static_cast<UShort_t>(inline_size);
+                    inline_size += size;
+                }
+            }
+
+            pad(2);
+            size_t vtable = data_.size();
+            data_.resize(vtable + 4 + 2 * count);
+            put(vtable, 4 + 2 * count, 2);
+            put(vtable + 2, inline_size, 2);
+            for (Int_t i = 0; i < count; ++i) put(vtable + 4 + 2 * i, offsets[i], 2);
+
+            while (data_.size() % 8 != 4) data_.push_back(0);
+            size_t table = data_.size();
+            data_.resize(table + inline_size);
+            put(table, table - vtable, 4);
+            for (Int_t i = 0; i < count; ++i) {
+                fields[i] = offsets[i] ? table + offsets[i] : 0;
+            }
+            return table;
+        }
+
+        /**
+         * Appends a vector of count elements of size bytes aligned to align
+         * and returns its position; the elements follow the 4-byte length.
+         */
+        size_t vector(size_t count, size_t size, size_t align)
+        {
+            if (align < 4) align = 4;
+            while ((data_.size() + 4) % align != 0) data_.push_back(0);
+            size_t position = data_.size();
+            data_.resize(position + 4 + count * size);
+            put(position, count, 4);
+            return position;
+        }
+
+        size_t string(const std::string& text)
+        {
+            size_t position = vector(text.size() + 1, 1, 4);
+            put(position, text.size(), 4);
+            memcpy(&data_[position + 4], text.data(), text.size());
+            return position;
+        }
+
+        /// Sets a little-endian scalar of size bytes.
+        void put(size_t position, ULong64_t value, Int_t size)
+        {
+            for (Int_t i = 0; i < size; ++i) {
+                data_[position + i] = static_cast<unsigned char>(value >> (8 * i));
+            }
+        }
+
+        /// Sets the reference of a field to a later object.
+        void refer(size_t field, size_t object) { put(field, object - field, 4); }
+
+        /// Sets the root table and pads the buffer to 8 bytes.
+        void finish(size_t root)
+        {
+            refer(0, root);
+            pad(8);
+        }
+
+    private:
+        void pad(size_t align)
+        {
+            while (data_.size() % align != 0) data_.push_back(0);
+        }
+
+        std::vector<unsigned char> data_;
+    };
+
+    ULong64_t get(const std::vector<unsigned char>& data, size_t position,
+                  Int_t size)
+    {
+        ULong64_t value = 0;
+        for (Int_t i = size - 1; i >= 0; --i) value = (value << 8) | data[position + i];
+        return value;
+    }
+
+    /**
+     * Returns the position of field id of the table at position, 0 if the
+     * field is absent.
+     */
+    size_t fieldOf(const std::vector<unsigned char>& data, size_t table, Int_t id)
+    {
+        size_t vtable = table - static_cast<Int_t>(get(data, table, 4));
+        if (4 + 2 * static_cast<size_t>(id) >= get(data, vtable, 2)) return 0;
+        size_t offset = get(data, vtable + 4 + 2 * id, 2);
+        return offset ? table + offset : 0;
+    }
+
+    /// Arrow schema (table Schema) of float64 columns.
+    size_t writeSchema(FlatBuilder& builder, const std::vector<std::string>& names)
+    {
+        const UInt_t one = 1;
+        Bool_t big_endian = (*reinterpret_cast<const unsigned char*>(&one) == 0);
+
+        const Int_t schema_sizes[] = { 2, 4 };     // endianness, fields
+        size_t schema_fields[2];
+        size_t schema = builder.table(schema_sizes, 2, schema_fields);
+        builder.put(schema_fields[0], big_endian ? 1 : 0, 2);
+        size_t fields = builder.vector(names.size(), 4, 4);
+        builder.refer(schema_fields[1], fields);
+
+        for (size_t i = 0; i < names.size(); ++i) {
+            // name, nullable, type_type, type, dictionary, children
+            const Int_t field_sizes[] = { 4, 1, 1, 4, 0, 4 };
+            size_t field_fields[6];
+            size_t field = builder.table(field_sizes, 6, field_fields);
+            builder.refer(fields + 4 + 4 * i, field);
+            builder.put(field_fields[1], 0, 1);
+            builder.put(field_fields[2], TYPE_FLOATING_POINT, 1);
+            builder.refer(field_fields[0], builder.string(names[i]));
+
+            const Int_t type_sizes[] = { 2 };      // precision
+            size_t type_fields[1];
+            size_t type = builder.table(type_sizes, 1, type_fields);
+            builder.put(type_fields[0], PRECISION_DOUBLE, 2);
+            builder.refer(field_fields[3], type);
+            builder.refer(field_fields[5], builder.vector(0, 4, 4));
+        }
+        return schema;
+    }
+
+    /**
+     * Appends the table Message with a header of the given type and
+     * returns its position; header receives the position of the header
+     * field.
+     */
+    size_t messageTable(FlatBuilder& builder, Int_t header_type,
+                        Long64_t body_length, size_t& header)
+    {
+        // version, header_type, header, bodyLength
+        const Int_t sizes[] = { 2, 1, 4, 8 };
+        size_t fields[4];
+        size_t message = builder.table(sizes, 4, fields);
+        builder.put(fields[0], METADATA_V5, 2);
+        builder.put(fields[1], header_type, 1);
+        builder.put(fields[3], body_length, 8);
+        header = fields[2];
+        return message;
+    }
+}
+
+ArrowWriter::ArrowWriter()
+    : used_(0), file_(NULL), offset_(0), rows_(0), failed_(false) {}
+
+ArrowWriter::~ArrowWriter()
+{
+    close();
+}
+
+Bool_t ArrowWriter::parseColumns(const std::string& list,
+                                 std::vector<std::string>& columns)
+{
+    columns.clear();
+    if (list == "all") return true;
+    std::istringstream iss(list);
+    std::string name;
+    while (std::getline(iss, name, ',')) {
+        if (name.empty()) break;
+        columns.push_back(name);
+    }
+    if (columns.empty() || name.empty() || list[list.size() - 1] == ',') {
+        std::cerr << "Invalid Arrow column list: " << list << std::endl;
+        return false;
+    }
+    return true;
+}
+
+void ArrowWriter::select(const std::vector<std::string>& columns)
+{
+    selected_ = columns;
+    names_ = columns;
+    columns_.assign(columns.size(), NULL);
+}
+
+void ArrowWriter::bind(const std::string& name,
+                       const std::vector<Double_t>* column)
+{
+    if (selected_.empty()) {
+        names_.push_back(name);
+        columns_.push_back(column);
+        return;
+    }
+    for (size_t i = 0; i < selected_.size(); ++i) {
+        if (selected_[i] == name) columns_[i] = column;
+    }
+}
+
+Bool_t ArrowWriter::isBound() const
+{
+    Bool_t bound = true;
+    for (size_t i = 0; i < columns_.size(); ++i) {
+        if (!columns_[i]) {
+            std::cerr << "Unknown Arrow column: " << names_[i] << std::endl;
+            bound = false;
+        }
+    }
+    return bound;
+}
+
+Bool_t ArrowWriter::writeBytes(const void* data, size_t size)
+{
+    if (failed_) return false;
+    if (fwrite(data, 1, size, file_) != size) {
+        std::cerr << "Failed to write Arrow file: " << file_name_ << std::endl;
+        failed_ = true;
+        return false;
+    }
+    offset_ += size;
+    return true;
+}
+
+Bool_t ArrowWriter::writeMessage(const std::vector<unsigned char>& metadata)
+{
+    unsigned char prefix[8];
+    for (Int_t i = 0; i < 4; ++i) {
+        prefix[i] = static_cast<unsigned char>(CONTINUATION >> (8 * i));
+        prefix[4 + i] = static_cast<unsigned char>(metadata.size() >> (8 * i));
+    }
+    return writeBytes(prefix, sizeof(prefix)) &&
+           writeBytes(&metadata[0], metadata.size());
+}
+
+Bool_t ArrowWriter::open(const std::string& file_name, Long64_t offset)
+{
+    close();
+    file_name_ = file_name;
+    failed_ = false;
+    blocks_.clear();
+    offset_ = 0;
+    rows_ = 0;
+    used_ = 0;
+    buffers_.assign(columns_.size(), std::vector<Double_t>(BATCH_ROWS));
+
+    // The committed batches of a resumed run are kept
+    if (offset > 0) {
+        if (truncate(file_name.c_str(), offset) != 0 || !scan(offset)) {
+            std::cerr << "Cannot resume Arrow file: " << file_name << std::endl;
+            return false;
+        }
+        file_ = fopen(file_name.c_str(), "ab");
+    } else {
+        file_ = fopen(file_name.c_str(), "wb");
+    }
+    if (!file_) {
+        std::cerr << "Failed to open Arrow file for writing: " << file_name
+                  << std::endl;
+        return false;
+    }
+    offset_ = offset;
+    if (offset > 0) return true;
+
+    FlatBuilder builder;
+    size_t header;
+    size_t message = messageTable(builder, HEADER_SCHEMA, 0, header);
+    builder.refer(header, writeSchema(builder, names_));
+    builder.finish(message);
+    return writeBytes(MAGIC, sizeof(MAGIC)) && writeMessage(builder.data());
+}
+
+Bool_t ArrowWriter::scan(Long64_t offset)
+{
+    FILE* file = fopen(file_name_.c_str(), "rb");
+    if (!file) return false;
+    char magic[sizeof(MAGIC)];
+    Bool_t valid = fread(magic, 1, sizeof(magic), file) == sizeof(magic) &&
+                   memcmp(magic, MAGIC, sizeof(MAGIC)) == 0;
+    Long64_t position = sizeof(MAGIC);
+    std::vector<unsigned char> metadata;
+    while (valid && position < offset) {
+        unsigned char prefix[8];
+        valid = fread(prefix, 1, sizeof(prefix), file) == sizeof(prefix);
+        if (!valid) break;
+        metadata.assign(prefix, prefix + sizeof(prefix));
+        size_t length = get(metadata, 4, 4);
+        valid = get(metadata, 0, 4) == CONTINUATION && length > 0;
+        if (!valid) break;
+        metadata.resize(length);
+        valid = fread(&metadata[0], 1, length, file) == length;
+        if (!valid) break;
+
+        size_t message = get(metadata, 0, 4);
+        size_t type = fieldOf(metadata, message, 1);
+        size_t body = fieldOf(metadata, message, 3);
+        Long64_t body_length = body ? get(metadata, body, 8) : 0;
+        if (type && get(metadata, type, 1) == static_cast<ULong64_t>(HEADER_RECORD_BATCH)) {
+            size_t header = fieldOf(metadata, message, 2);
+            size_t batch = header + get(metadata, header, 4);
+            size_t length_field = fieldOf(metadata, batch, 0);
+            Block block;
+            block.offset = position;
+            block.metadata_length = static_cast<Int_t>(8 + length);
+            block.body_length = body_length;
+            blocks_.push_back(block);
+            rows_ += length_field ? get(metadata, length_field, 8) : 0;
+        }
+        position += 8 + length + body_length;
+        valid = fseeko(file, position, SEEK_SET) == 0;
+    }
+    fclose(file);
+    return valid && position == offset;
+}
+
+void ArrowWriter::fill()
+{
+    for (size_t i = 0; i < columns_.size(); ++i) {
+        buffers_[i][used_] = columns_[i]->empty() ? 0 : columns_[i]->front();
+    }
+    if (++used_ == BATCH_ROWS) flush();
+}
+
+Bool_t ArrowWriter::flush()
+{
+    if (!file_) return false;
+    if (used_ == 0 || failed_) return !failed_;
+
+    // Every column is a float64 array without validity bitmap; its values
+    // are a multiple of 8 bytes, so the buffers need no padding
+    Long64_t column_bytes = used_ * sizeof(Double_t);
+    Long64_t body_length = column_bytes * columns_.size();
+    FlatBuilder builder;
+    size_t header;
+    size_t message = messageTable(builder, HEADER_RECORD_BATCH, body_length,
+                                  header);
+    const Int_t sizes[] = { 8, 4, 4 };     // length, nodes, buffers
+    size_t fields[3];
+    size_t batch = builder.table(sizes, 3, fields);
+    builder.refer(header, batch);
+    builder.put(fields[0], used_, 8);
+    size_t nodes = builder.vector(columns_.size(), 16, 8);
+    builder.refer(fields[1], nodes);
+    for (size_t i = 0; i < columns_.size(); ++i) {
+        builder.put(nodes + 4 + 16 * i, used_, 8);      // length
+        builder.put(nodes + 12 + 16 * i, 0, 8);         // null count
+    }
+    size_t buffers = builder.vector(2 * columns_.size(), 16, 8);
+    builder.refer(fields[2], buffers);
+    for (size_t i = 0; i < columns_.size(); ++i) {
+        size_t validity = buffers + 4 + 32 * i;
+        builder.put(validity, i * column_bytes, 8);
+        builder.put(validity + 8, 0, 8);
+        builder.put(validity + 16, i * column_bytes, 8);
+        builder.put(validity + 24, column_bytes, 8);
+    }
+    builder.finish(message);
+
+    Block block;
+    block.offset = offset_;
+    block.metadata_length = static_cast<Int_t>(8 + builder.data().size());
+    block.body_length = body_length;
+    Bool_t written = writeMessage(builder.data());
+    for (size_t i = 0; written && i < columns_.size(); ++i) {
+        written = writeBytes(&buffers_[i][0], column_bytes);
+    }
+    if (written) {
+        blocks_.push_back(block);
+        rows_ += used_;
+    }
+    used_ = 0;
+    return written;
+}
+
+Bool_t ArrowWriter::close()
+{
+    if (!file_) return true;
+    Bool_t written = flush();
+
+    // Footer: the schema again and the positions of the record batches
+    FlatBuilder builder;
+    // version, schema, dictionaries, recordBatches
+    const Int_t sizes[] = { 2, 4, 4, 4 };
+    size_t fields[4];
+    size_t footer = builder.table(sizes, 4, fields);
+    builder.put(fields[0], METADATA_V5, 2);
+    builder.refer(fields[1], writeSchema(builder, names_));
+    builder.refer(fields[2], builder.vector(0, 24, 8));
+    size_t batches = builder.vector(blocks_.size(), 24, 8);
+    builder.refer(fields[3], batches);
+    for (size_t i = 0; i < blocks_.size(); ++i) {
+        size_t block = batches + 4 + 24 * i;
+        builder.put(block, blocks_[i].offset, 8);
+        builder.put(block + 8, blocks_[i].metadata_length, 4);
+        builder.put(block + 16, blocks_[i].body_length, 8);
+    }
+    builder.finish(footer);
+    const std::vector<unsigned char>& data = builder.data();
+    unsigned char end_of_stream[8] = { 0xFF, 0xFF, 0xFF, 0xFF, 0, 0, 0, 0 };
+    unsigned char footer_size[4];
+    for (Int_t i = 0; i < 4; ++i) {
+        footer_size[i] = static_cast<unsigned char>(data.size() >> (8 * i));
+    }
+    Long64_t committed = offset_;
+    written = written && writeBytes(end_of_stream, sizeof(end_of_stream)) &&
+              writeBytes(&data[0], data.size()) &&
+              writeBytes(footer_size, sizeof(footer_size)) &&
+              writeBytes(MAGIC, 6);
+    offset_ = committed;    // A resumed run cuts the footer
+    if (fclose(file_) != 0) written = false;
+    file_ = NULL;
+    return written;
+}
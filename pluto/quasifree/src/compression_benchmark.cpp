@@ -0,0 +1,168 @@
+/**
+ * @file compression_benchmark.cpp
+ * @author AK <alex.nuclearboy@gmail.com>
+ * @brief Compares the output profiles on the trees written by run_simulate.
+ *
+ * Usage: compression_benchmark [--dir DIR] [--profiles a,b,...] <file>...
+ *
+ * The "data" (PLUTO) and "values" trees of every file are copied with each
+ * output profile (default: all) to a scratch file in DIR (default: /tmp),
+ * which is read back and removed. For each tree and profile the program
+ * prints the write and read speed in MB/s of uncompressed data and the
+ * compression ratio. The time spent reading the input tree is measured
+ * once and subtracted from the write time; the read speed is measured with
+ * the file in the page cache, i.e. it shows the decompression cost.
+ *
+ * @date 2026-10-18
+ *
+ * @note Distributed under the GNU General Public License version 3.0 (GPLv3).
+ */
+
+#include "output_profile.h"
+#include <cstdio>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <unistd.h>
+#include <vector>
+#include "TFile.h"
+#include "TMath.h"
+#include "TStopwatch.h"
+#include "TTree.h"
+
+/**
+ * @brief Reads all entries of a tree.
+ *
+ * @return Elapsed wall-clock time [s].
+ */
+Double_t readTree(TTree* tree)
+{
+    TStopwatch timer;
+    Long64_t entries = tree->GetEntries();
+    for (Long64_t i = 0; i < entries; ++i) tree->GetEntry(i);
+    timer.Stop();
+    return timer.RealTime();
+}
+
+/**
+ * @brief Copies a tree with a profile, reads the copy back and prints the
+ *        speeds and the compression ratio.
+ */
+Bool_t benchmark(TTree* input, Double_t input_read_time,
+                 const OutputProfile& profile, const std::string& dir)
+{
+    std::string path = dir + "/compression_benchmark-" + profile.name + ".root";
+
+    TStopwatch timer;
+    TFile* output = new TFile(path.c_str(), "RECREATE");
+    if (!output->IsOpen()) {
+        std::cerr << "Failed to open file: " << path << std::endl;
+        delete output;
+        return false;
+    }
+    profile.apply(output);
+    TTree* copy = input->CloneTree(0);
+    profile.apply(copy);
+    Long64_t entries = input->GetEntries();
+    for (Long64_t i = 0; i < entries; ++i) {
+        input->GetEntry(i);
+        copy->Fill();
+    }
+    copy->Write();
+    Double_t bytes = copy->GetTotBytes();
+    Double_t zip_bytes = copy->GetZipBytes();
+    output->Close();
+    timer.Stop();
+    delete output;
+    Double_t write_time = TMath::Max(timer.RealTime() - input_read_time, 1e-6);
+
+    TFile* file = TFile::Open(path.c_str(), "READ");
+    TTree* tree = NULL;
+    if (file) file->GetObject(input->GetName(), tree);
+    if (!tree) {
+        std::cerr << "Failed to read back " << path << std::endl;
+        delete file;
+        return false;
+    }
+    Double_t read_time = TMath::Max(readTree(tree), 1e-6);
+    delete file;
+    unlink(path.c_str());
+
+    const Double_t MB = 1e6;
+    std::cout << "  " << std::left << std::setw(10) << profile.name
+              << std::right << std::fixed << std::setprecision(1)
+              << std::setw(10) << bytes / MB / write_time
+              << std::setw(10) << bytes / MB / read_time
+              << std::setw(10) << std::setprecision(2)
+              << (zip_bytes > 0 ? bytes / zip_bytes : 0.)
+              << std::setw(12) << std::setprecision(1) << zip_bytes / MB
+              << "   " << profile.describe() << std::endl;
+    return true;
+}
+
+Int_t main(Int_t argc, char** argv)
+{
+    std::string dir = "/tmp";
+    std::vector<std::string> profile_names = OutputProfile::names();
+    std::vector<std::string> inputs;
+    Bool_t valid = true;
+    for (Int_t i = 1; i < argc && valid; ++i) {
+        std::string arg = argv[i];
+        if (arg.compare(0, 2, "--") != 0) {
+            inputs.push_back(arg);
+            continue;
+        }
+        if (i + 1 >= argc) {
+            valid = false;
+        } else if (arg == "--dir") {
+            dir = argv[++i];
+        } else if (arg == "--profiles") {
+            profile_names.clear();
+            std::istringstream iss(argv[++i]);
+            std::string name;
+            while (std::getline(iss, name, ',')) profile_names.push_back(name);
+        } else {
+            valid = false;
+        }
+    }
+    if (!valid || inputs.empty()) {
+        std::cerr << "Usage: " << argv[0] << " [--dir DIR] [--profiles a,b,...]"
+                  << " <file>..." << std::endl;
+        return 1;
+    }
+
+    std::vector<OutputProfile> profiles(profile_names.size());
+    for (size_t i = 0; i < profile_names.size(); ++i) {
+        if (!OutputProfile::get(profile_names[i], profiles[i])) return 1;
+    }
+
+    const char* tree_names[] = { "data", "values" };
+    Int_t failed = 0;
+    for (size_t f = 0; f < inputs.size(); ++f) {
+        TFile* file = TFile::Open(inputs[f].c_str(), "READ");
+        if (!file || file->IsZombie()) {
+            std::cerr << "Failed to open " << inputs[f] << std::endl;
+            delete file;
+            ++failed;
+            continue;
+        }
+        for (size_t t = 0; t < sizeof(tree_names) / sizeof(tree_names[0]); ++t) {
+            TTree* tree = NULL;
+            file->GetObject(tree_names[t], tree);
+            if (!tree) continue;
+
+            readTree(tree);     // Warms up the page cache
+            Double_t input_read_time = readTree(tree);
+            std::cout << inputs[f] << ": tree " << tree_names[t] << ", "
+                      << tree->GetEntries() << " entries" << std::endl
+                      << "  profile   write MB/s read MB/s     ratio     size MB"
+                      << std::endl;
+            for (size_t p = 0; p < profiles.size(); ++p) {
+                if (!benchmark(tree, input_read_time, profiles[p], dir)) ++failed;
+            }
+        }
+        delete file;
+    }
+    return failed > 0 ? 1 : 0;
+}
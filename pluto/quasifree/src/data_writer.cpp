@@ -31,41 +31,30 @@ DataWriter::DataWriter() {}     ///< Default constructor.
 
 DataWriter::~DataWriter() {}    ///< Destructor.
 
-void DataWriter::writeTreeToFile(TTree* tree, const std::string& file_name) 
+TFile* DataWriter::openTreeFile(const std::string& file_name, Bool_t resume)
 {
-    // Writes a ROOT TTree structure to a file.
+    // Opens a ROOT file for writing a tree event by event.
 
-    if (!tree) {
-        std::cerr << "No tree provided to write." << std::endl;
-        return;
-    }
-    TFile file(file_name.c_str(), "RECREATE");
-    if (!file.IsOpen()) {
+    TFile* file = new TFile(file_name.c_str(), resume ? "UPDATE" : "RECREATE");
+    if (!file->IsOpen()) {
         std::cerr << "Failed to open file: " << file_name << std::endl;
-        return;
+        delete file;
+        return NULL;
     }
-
-    tree->Write();
-    file.Close();
+    if (!resume) profile_.apply(file);
+    return file;
 }
 
-void DataWriter::writeProtonData(
-    const std::vector<std::pair<Double_t, Double_t> >& data, 
-    const std::string& file_name) 
+void DataWriter::closeTreeFile(TFile*& file, TTree* tree)
 {
-    // Writes pairs of proton momentum and scattering angle to a text file.
+    // Writes the tree, replacing the copy saved by the last checkpoint.
 
-    std::ofstream out_file(file_name.c_str());
-    if (!out_file.is_open()) {
-        std::cerr << "Failed to open text file for writing: " << file_name << std::endl;
-        return;
-    }
-
-    for (size_t i = 0; i < data.size(); ++i) {
-        out_file << data[i].first << "\t" << data[i].second << "\n";
-    }
-
-    out_file.close();
+    if (!file) return;
+    file->cd();
+    if (tree) tree->Write("", TObject::kOverwrite);
+    file->Close();
+    delete file;    // Also deletes the tree owned by the file
+    file = NULL;
 }
 
 std::string DataWriter::getPlutoFilePath(
@@ -90,14 +79,56 @@ std::string DataWriter::getDataFilePath(
     return getAbsolutePath(path.str());
 }
 
-std::string DataWriter::getProtonFilePath(
+std::string DataWriter::getCombinedFilePath(
     const std::string& model_name, Int_t iteration)
+{
+    // Returns the path for the file with the PLUTO tree and the calculated
+    // values, formatted with the model name and iteration.
+    std::ostringstream path;
+    path << "../data/ppn_spec-" << model_name << "-" << (iteration + 1) 
+         << ".root";
+    return getAbsolutePath(path.str());
+}
+
+std::string DataWriter::getProtonFilePath(
+    const std::string& model_name, Int_t iteration,
+    ProtonDataWriter::Format format)
 {
     // Returns the file path for storing proton data, 
     // formatted with the model name and iteration.
     std::ostringstream path;
     path << "../data/proton_momentum_theta-" << model_name << "-" 
-         << (iteration + 1) << ".txt";
+         << (iteration + 1) << ProtonDataWriter::extension(format);
+    return getAbsolutePath(path.str());
+}
+
+std::string DataWriter::getArrowFilePath(
+    const std::string& model_name, Int_t iteration)
+{
+    // Returns the path for the Arrow file of the calculated values,
+    // formatted with the model name and iteration.
+    std::ostringstream path;
+    path << "../data/values_ppn_spec-" << model_name << "-" << (iteration + 1) 
+         << ".arrow";
+    return getAbsolutePath(path.str());
+}
+
+std::string DataWriter::getHistogramFilePath(
+    const std::string& model_name, Int_t iteration)
+{
+    // Returns the path for the histograms of the calculated values,
+    // formatted with the model name and iteration.
+    std::ostringstream path;
+    path << "../data/hist_ppn_spec-" << model_name << "-" << (iteration + 1) 
+         << ".root";
+    return getAbsolutePath(path.str());
+}
+
+std::string DataWriter::getCheckpointPath(const std::string& model_name)
+{
+    // Returns the path of the checkpoint shared by all iterations of a model.
+    std::ostringstream path;
+    path << "../data/ppn_spec-" << model_name << ".ckpt";
     return getAbsolutePath(path.str());
 }
 
@@ -15,7 +15,13 @@
 #include "physics_calculator.h"
 #include "constants.h"
 #include <iostream>
+#include <time.h>
+#include <unistd.h>
+#include "RVersion.h"
 #include "TROOT.h"
+#if ROOT_VERSION_CODE < ROOT_VERSION(6,0,0)
+#include "TThread.h"
+#endif
 #include "TGraph.h"
 #include "PParticle.h"
 
@@ -23,57 +29,236 @@ const Double_t proton_mass = Constants::PROTON_MASS;
 const Double_t neutron_mass = Constants::NEUTRON_MASS;
 const Double_t deuteron_mass = Constants::DEUTERON_MASS;
 
+const useconds_t RING_POLL_US = 20;     ///< Wait for the other thread [us].
+const Long64_t SINGLE_FILE_CLUSTER = 10000;     ///< Entries per cluster.
+
 RandomGenerator rand_gen;
 
 EventGenerator::EventGenerator(
     TGraph* graph, DataWriter& writer, 
     const std::string& pluto_data_file, 
     const std::string& analysis_data_file, 
-    const std::string& proton_data_file)
-    : graph_(graph), writer_(writer), 
+    const std::string& proton_data_file,
+    GINFile* gin_file)
+    : graph_(graph), writer_(writer), gin_file_(gin_file),
     pluto_data_file_(pluto_data_file), 
     analysis_data_file_(analysis_data_file), 
-    proton_data_file_(proton_data_file) {}
+    proton_data_file_(proton_data_file),
+    checkpoint_(NULL), checkpoint_interval_(0), file_events_(0),
+    file_generated_(0), file_accepted_(0), acceptance_(NULL),
+    histograms_(NULL), values_tree_(true), precision_(NULL),
+    proton_format_(ProtonDataWriter::kText),
+    single_file_(false), with_catalogue_(false), async_slots_(0), ring_(NULL), writer_stop_(false),
+    ring_stalls_(0), writer_waits_(0), ring_peak_(0),
+    pluto_file_(NULL), data_file_(NULL),
+    particles_tree_(NULL), particles_(NULL), data_tree_(NULL) {}
 
 EventGenerator::~EventGenerator() {}
 
-void EventGenerator::setupTree() 
+void EventGenerator::enableCheckpoints(
+    RunCheckpoint* checkpoint, const std::string& path, Long64_t interval)
+{
+    checkpoint_ = checkpoint;
+    checkpoint_path_ = path;
+    checkpoint_interval_ = interval;
+}
+
+void EventGenerator::setHistograms(
+    HistogramBank* bank, const std::string& file_name)
+{
+    histograms_ = bank;
+    histogram_file_ = file_name;
+}
+
+void EventGenerator::setArrowOutput(
+    const std::string& file_name, const std::vector<std::string>& columns)
+{
+    arrow_data_file_ = file_name;
+    arrow_.select(columns);
+}
+
+void EventGenerator::attachColumn(
+    const char* name, std::vector<Double_t>& column, Bool_t resume)
+{
+    if (histograms_) histograms_->bind(name, &column);
+    if (!arrow_data_file_.empty()) arrow_.bind(name, &column);
+    if (!data_tree_) return;
+    PrecisionSpec::Column* reduced = precision_ ? precision_->find(name) : NULL;
+    if (reduced) {
+        PrecisionSpec::branch(data_tree_, *reduced, resume);
+        reduced_columns_.push_back(std::make_pair(reduced, &column));
+    } else if (resume) {
+        data_tree_->SetBranchAddress(name, &column);
+    } else {
+        data_tree_->Branch(name, &column);
+    }
+}
+
+Bool_t EventGenerator::isPrecisionBound() const
+{
+    Bool_t bound = true;
+    for (size_t i = 0; i < precision_->columns().size(); ++i) {
+        const std::string& name = precision_->columns()[i].name;
+        size_t j = 0;
+        while (j < reduced_columns_.size() && reduced_columns_[j].first->name != name) ++j;
+        if (j == reduced_columns_.size()) {
+            std::cerr << "Unknown column in the precision specification: "
+                      << name << std::endl;
+            bound = false;
+        }
+    }
+    return bound;
+}
+
+Bool_t EventGenerator::setupTree(Long64_t first_event) 
 {
-    // Set up a tree structure for storing data on outgoing particles
+    Bool_t resume = first_event > 0;
+    Bool_t flagged = acceptance_ && !acceptance_->dropsEvents();
+    file_generated_ = first_event;
+    file_events_ = (resume && checkpoint_) ? checkpoint_->file_events : first_event;
+    file_accepted_ = (resume && checkpoint_) ? checkpoint_->file_accepted : first_event;
+    Npart_ = 3;     // Spectator neutron and two scattered protons
     Impact_ = 0;
     Phi_ = 0;
+    Accepted_ = 1;
     particles_ = new TClonesArray("PParticle", Npart_);
 
-    particles_tree_ = new TTree("data", "Particles Tree");
-    particles_tree_->Branch("Npart", &Npart_, "Npart/I");
-    particles_tree_->Branch("Impact", &Impact_, "Impact/F");
-    particles_tree_->Branch("Phi", &Phi_, "Phi/F");
-    particles_tree_->Branch("Particles", &particles_);
-
-    // Set up a tree structure with calculated values
-    data_tree_ = new TTree("values", "Simulation Data");
-    data_tree_->Branch("beam_momentum_lab", &beam_momentum_lab_);
-    data_tree_->Branch("beam_momentum_cm", &beam_momentum_cm_);
-    data_tree_->Branch("beam_energy_lab", &beam_energy_lab_);
-    data_tree_->Branch("beam_energy_cm", &beam_energy_cm_);
-    data_tree_->Branch("inv_mass_pd", &inv_mass_pd_);
-    data_tree_->Branch("target_neutron_momentum_cm", &target_neutron_momentum_cm_);
-    data_tree_->Branch("target_neutron_theta_cm", &target_neutron_theta_cm_);
-    data_tree_->Branch("target_neutron_phi_cm", &target_neutron_phi_cm_);
-    data_tree_->Branch("target_proton_momentum_cm", &target_proton_momentum_cm_);
-    data_tree_->Branch("target_proton_theta_cm", &target_proton_theta_cm_);
-    data_tree_->Branch("target_proton_phi_cm", &target_proton_phi_cm_);
-    data_tree_->Branch("proton_proton_angle", &proton_proton_angle_);
-    data_tree_->Branch("inv_mass_pp", &inv_mass_pp_);
-    data_tree_->Branch("effective_proton_mass", &effective_proton_mass_);
-    data_tree_->Branch("effective_proton_momentum", &effective_proton_momentum_);
-    data_tree_->Branch("beam_proton_momentum_pp", &beam_proton_momentum_pp_);
-    data_tree_->Branch("beam_proton_theta_scat_cm", &beam_proton_theta_scat_cm_);
-    data_tree_->Branch("beam_proton_phi_scat_cm", &beam_proton_phi_scat_cm_);
-    data_tree_->Branch("target_proton_momentum_pp", &target_proton_momentum_pp_);
-    data_tree_->Branch("target_proton_theta_scat_cm", &target_proton_theta_scat_cm_);
-    data_tree_->Branch("target_proton_phi_scat_cm", &target_proton_phi_scat_cm_);
-    data_tree_->Branch("target_proton_energy_cm", &target_proton_energy_cm_);
+    // Events filled after the last checkpoint are dropped from the files
+    // of a resumed run; the PLUTO file lacks the events rejected by the
+    // acceptance filter
+    if (resume) {
+        if ((!gin_file_ && !RunCheckpoint::truncateTree(
+                 pluto_data_file_, "data", file_events_)) ||
+            (values_tree_ && !RunCheckpoint::truncateTree(
+                 analysis_data_file_, "values", first_event))) {
+            return false;
+        }
+        // The histograms were written with the last checkpoint
+        if (histograms_) {
+            Long64_t filled = histograms_->merge(histogram_file_);
+            if (filled != first_event) {
+                std::cerr << "Cannot resume " << histogram_file_ << ": "
+                          << filled << " events filled, " << first_event
+                          << " committed" << std::endl;
+                return false;
+            }
+        }
+    }
+
+    // Set up a tree structure for storing data on outgoing particles;
+    // streamed events are read by WMC directly, no PLUTO file is needed
+    if (!gin_file_) {
+        pluto_file_ = writer_.openTreeFile(pluto_data_file_, resume);
+        if (!pluto_file_) return false;
+        if (resume) {
+            pluto_file_->GetObject("data", particles_tree_);
+            if (!particles_tree_) return false;
+            particles_tree_->SetBranchAddress("Npart", &Npart_);
+            particles_tree_->SetBranchAddress("Impact", &Impact_);
+            particles_tree_->SetBranchAddress("Phi", &Phi_);
+            particles_tree_->SetBranchAddress("Particles", &particles_);
+            if (flagged) particles_tree_->SetBranchAddress("Accepted", &Accepted_);
+        } else {
+            particles_tree_ = new TTree("data", "Particles Tree");
+            particles_tree_->Branch("Npart", &Npart_, "Npart/I");
+            particles_tree_->Branch("Impact", &Impact_, "Impact/F");
+            particles_tree_->Branch("Phi", &Phi_, "Phi/F");
+            particles_tree_->Branch("Particles", &particles_);
+            if (flagged) particles_tree_->Branch("Accepted", &Accepted_, "Accepted/I");
+            writer_.configureTree(particles_tree_);
+        }
+    }
+
+    // Set up a tree structure with calculated values, unless only their
+    // histograms are kept
+    if (values_tree_) {
+        data_file_ = single_file_ ? pluto_file_ : 
+                     writer_.openTreeFile(analysis_data_file_, resume);
+        if (!data_file_) return false;
+        data_file_->cd();
+        if (resume) {
+            data_file_->GetObject("values", data_tree_);
+            if (!data_tree_) return false;
+        } else {
+            data_tree_ = new TTree("values", "Simulation Data");
+            // Entry i of both trees is the same event
+            if (single_file_) data_tree_->AddFriend(particles_tree_);
+        }
+    }
+    reduced_columns_.clear();
+    attachColumn("beam_momentum_lab", beam_momentum_lab_, resume);
+    attachColumn("beam_momentum_cm", beam_momentum_cm_, resume);
+    attachColumn("beam_energy_lab", beam_energy_lab_, resume);
+    attachColumn("beam_energy_cm", beam_energy_cm_, resume);
+    attachColumn("inv_mass_pd", inv_mass_pd_, resume);
+    attachColumn("target_neutron_momentum_cm", target_neutron_momentum_cm_, resume);
+    attachColumn("target_neutron_theta_cm", target_neutron_theta_cm_, resume);
+    attachColumn("target_neutron_phi_cm", target_neutron_phi_cm_, resume);
+    attachColumn("target_proton_momentum_cm", target_proton_momentum_cm_, resume);
+    attachColumn("target_proton_theta_cm", target_proton_theta_cm_, resume);
+    attachColumn("target_proton_phi_cm", target_proton_phi_cm_, resume);
+    attachColumn("proton_proton_angle", proton_proton_angle_, resume);
+    attachColumn("inv_mass_pp", inv_mass_pp_, resume);
+    attachColumn("effective_proton_mass", effective_proton_mass_, resume);
+    attachColumn("effective_proton_momentum", effective_proton_momentum_, resume);
+    attachColumn("beam_proton_momentum_pp", beam_proton_momentum_pp_, resume);
+    attachColumn("beam_proton_theta_scat_cm", beam_proton_theta_scat_cm_, resume);
+    attachColumn("beam_proton_phi_scat_cm", beam_proton_phi_scat_cm_, resume);
+    attachColumn("target_proton_momentum_pp", target_proton_momentum_pp_, resume);
+    attachColumn("target_proton_theta_scat_cm", target_proton_theta_scat_cm_, resume);
+    attachColumn("target_proton_phi_scat_cm", target_proton_phi_scat_cm_, resume);
+    attachColumn("target_proton_energy_cm", target_proton_energy_cm_, resume);
+    if (acceptance_) attachColumn("accepted", accepted_, resume);
+    if (data_tree_ && !resume) writer_.configureTree(data_tree_);
+    if (single_file_ && !resume) {
+        // Common cluster boundaries, so that both trees can be read in
+        // parallel cluster by cluster
+        particles_tree_->SetAutoFlush(SINGLE_FILE_CLUSTER);
+        data_tree_->SetAutoFlush(SINGLE_FILE_CLUSTER);
+    }
+    if (histograms_ && !histograms_->isBound()) return false;
+    if (data_tree_ && precision_ && !isPrecisionBound()) return false;
+    if (!arrow_data_file_.empty()) {
+        Long64_t arrow_offset = (resume && checkpoint_) ? checkpoint_->arrow_offset : 0;
+        if (!arrow_.isBound() || !arrow_.open(arrow_data_file_, arrow_offset)) {
+            return false;
+        }
+        if (arrow_.rows() != first_event) {
+            std::cerr << "Cannot resume " << arrow_data_file_ << ": "
+                      << arrow_.rows() << " events written, " << first_event
+                      << " committed" << std::endl;
+            return false;
+        }
+    }
+    if (!values_tree_) return true;
+
+    Long64_t text_offset = (resume && checkpoint_) ? checkpoint_->text_offset : 0;
+    return proton_data_.open(proton_data_file_, proton_format_, text_offset);
+}
+
+void EventGenerator::saveCheckpoint()
+{
+    if (!checkpoint_ || checkpoint_path_.empty()) return;
+
+    // The state is only consistent once the writer thread caught up
+    drainRecords();
+
+    // Entries are committed once the tree headers on disk include them
+    if (particles_tree_) particles_tree_->AutoSave("SaveSelf");
+    if (data_tree_) data_tree_->AutoSave("SaveSelf");
+    if (histograms_) histograms_->write(histogram_file_, file_generated_);
+    if (proton_data_.isOpen()) {
+        proton_data_.flush();
+        checkpoint_->text_offset = proton_data_.offset();
+    }
+    if (arrow_.isOpen()) {
+        arrow_.flush();
+        checkpoint_->arrow_offset = arrow_.offset();
+    }
+    checkpoint_->file_events = file_events_;
+    checkpoint_->file_generated = file_generated_;
+    checkpoint_->file_accepted = file_accepted_;
+    checkpoint_->commit(checkpoint_path_, rand_gen.getEngine());
 }
 
 void EventGenerator::clearVectors() {
@@ -99,6 +284,7 @@ void EventGenerator::clearVectors() {
     target_proton_theta_scat_cm_.clear();
     target_proton_phi_scat_cm_.clear();
     target_proton_energy_cm_.clear();
+    accepted_.clear();
 }
 
 void EventGenerator::setParticles(
@@ -120,16 +306,17 @@ void EventGenerator::setParticles(
     }
 }
 
-void EventGenerator::generateEvents(Int_t num_events)
+Bool_t EventGenerator::generateEvents(Int_t num_events, Long64_t first_event)
 {
-    setupTree();
-
-    if (!particles_tree_ || !data_tree_ || !particles_) {
+    if (!setupTree(first_event) || (values_tree_ && !data_tree_) || !particles_) {
         std::cerr << "Tree or Particles array not initialized." << std::endl;
-        return;
+        cleanup();
+        return false;
+    }
+    if (!startWriter()) {
+        cleanup();
+        return false;
     }
-
-    proton_data.clear();
 
     for (Int_t i = 0; i < num_events; ) {
         std::vector<ParticleData> event_particles;
@@ -186,7 +373,8 @@ void EventGenerator::generateEvents(Int_t num_events)
 
         if (!graph_) {
             std::cerr << "Graph not set." << std::endl;
-            return;
+            cleanup();
+            return false;
         }
 
         Double_t target_nucleon_mom_distr_max = TMath::MaxElement(
@@ -331,9 +519,6 @@ void EventGenerator::generateEvents(Int_t num_events)
                     effective_proton_mass, target_proton_momentum_pp, 
                     target_proton_theta_scat_cm, target_proton_phi_scat_cm);
 
-            proton_data.push_back(std::make_pair(
-                effective_proton_momentum, beam_proton_theta_scat_cm));
-
             /* Proton-deuteron LAB frame */
             TVector3 b_pd;
             b_pd = proton_proton_4vector.BoostVector();
@@ -348,98 +533,516 @@ void EventGenerator::generateEvents(Int_t num_events)
             event_particles.push_back(ParticleData(
                 "p", target_proton_scat_4vector));
 
-            particles_->Clear();
-
-            setParticles(particles_, event_particles);
-
-            Npart_ = event_particles.size();
-
-            beam_momentum_lab_.push_back(beam_momentum_lab);
-            beam_momentum_cm_.push_back(beam_momentum_cm);
-            beam_energy_lab_.push_back(beam_energy_lab);
-            beam_energy_cm_.push_back(beam_energy_cm);
-            inv_mass_pd_.push_back(inv_mass_pd);
-            target_neutron_momentum_cm_.push_back(target_neutron_momentum_cm);
-            target_neutron_theta_cm_.push_back(target_neutron_theta_cm);
-            target_neutron_phi_cm_.push_back(target_neutron_phi_cm);
-            target_proton_momentum_cm_.push_back(target_proton_momentum_cm);
-            target_proton_theta_cm_.push_back(target_proton_theta_cm);
-            target_proton_phi_cm_.push_back(target_proton_phi_cm);
-            proton_proton_angle_.push_back(proton_proton_angle);
-            inv_mass_pp_.push_back(inv_mass_pp);
-            effective_proton_mass_.push_back(effective_proton_mass);
-            effective_proton_momentum_.push_back(effective_proton_momentum);
-            beam_proton_momentum_pp_.push_back(beam_proton_momentum_pp);
-            target_proton_momentum_pp_.push_back(target_proton_momentum_pp);
-            beam_proton_theta_scat_cm_.push_back(beam_proton_theta_scat_cm);
-            beam_proton_phi_scat_cm_.push_back(beam_proton_phi_scat_cm);
-            target_proton_theta_scat_cm_.push_back(target_proton_theta_scat_cm);
-            target_proton_phi_scat_cm_.push_back(target_proton_phi_scat_cm);
-            target_proton_energy_cm_.push_back(target_proton_energy_cm);
-
-            particles_tree_->Fill();
-            data_tree_->Fill();
-
-            clearVectors();
+            // Events outside the detector acceptance are not passed to WMC
+            // in the drop mode
+            Int_t detected = 0;
+            for (size_t k = 0; acceptance_ && k < event_particles.size(); ++k) {
+                if (acceptance_->isDetected(event_particles[k].name, 
+                        event_particles[k].vector.Vect())) {
+                    ++detected;
+                }
+            }
+            Int_t accepted = !acceptance_ || acceptance_->isAccepted(detected);
+            Bool_t passed = accepted || !acceptance_->dropsEvents();
+
+            // The outputs are written by writeEvent(), inline or by the
+            // writer thread
+            EventRecord* record = claimRecord();
+            record->particles = event_particles;
+            record->accepted = accepted;
+            record->passed = passed;
+            record->beam_momentum_lab = beam_momentum_lab;
+            record->beam_momentum_cm = beam_momentum_cm;
+            record->beam_energy_lab = beam_energy_lab;
+            record->beam_energy_cm = beam_energy_cm;
+            record->inv_mass_pd = inv_mass_pd;
+            record->target_neutron_momentum_cm = target_neutron_momentum_cm;
+            record->target_neutron_theta_cm = target_neutron_theta_cm;
+            record->target_neutron_phi_cm = target_neutron_phi_cm;
+            record->target_proton_momentum_cm = target_proton_momentum_cm;
+            record->target_proton_theta_cm = target_proton_theta_cm;
+            record->target_proton_phi_cm = target_proton_phi_cm;
+            record->proton_proton_angle = proton_proton_angle;
+            record->inv_mass_pp = inv_mass_pp;
+            record->effective_proton_mass = effective_proton_mass;
+            record->effective_proton_momentum = effective_proton_momentum;
+            record->beam_proton_momentum_pp = beam_proton_momentum_pp;
+            record->target_proton_momentum_pp = target_proton_momentum_pp;
+            record->beam_proton_theta_scat_cm = beam_proton_theta_scat_cm;
+            record->beam_proton_phi_scat_cm = beam_proton_phi_scat_cm;
+            record->target_proton_theta_scat_cm = target_proton_theta_scat_cm;
+            record->target_proton_phi_scat_cm = target_proton_phi_scat_cm;
+            record->target_proton_energy_cm = target_proton_energy_cm;
+            commitRecord();
 
             i++;
+            ++file_generated_;
+            if (accepted) ++file_accepted_;
+            if (passed) ++file_events_;
+            if (checkpoint_) {
+                ++checkpoint_->events_generated;
+                if (passed) ++checkpoint_->events_written;
+                if (checkpoint_interval_ > 0 && 
+                    checkpoint_->events_generated % checkpoint_interval_ == 0) {
+                    saveCheckpoint();
+                }
+            }
         }
     }
 
-    writer_.writeTreeToFile(particles_tree_, pluto_data_file_);
-    writer_.writeTreeToFile(data_tree_, analysis_data_file_);
-    writer_.writeProtonData(proton_data, proton_data_file_);
-
+    stopWriter();
+    saveCheckpoint();
+    Bool_t written = true;
+    if (histograms_ && (!checkpoint_ || checkpoint_path_.empty())) {
+        written = histograms_->write(histogram_file_, file_generated_);
+    }
     cleanup();
+    if (with_catalogue_) catalogueFiles();
+    return written;
 }
 
-void EventGenerator::runSimulations(
-    const std::string& model_name, TGraph* graph, 
-        Int_t num_events, Int_t num_iterations)
+void EventGenerator::catalogueFiles()
+{
+    EventCatalogue::Entry entry = catalogue_run_;
+    entry.events = file_generated_;
+    if (!gin_file_) {
+        entry.tree = "data";
+        entry.entries = file_events_;
+        EventCatalogue::record(pluto_data_file_, entry);
+    }
+    if (values_tree_) {
+        entry.tree = "values";
+        entry.entries = file_generated_;
+        EventCatalogue::record(analysis_data_file_, entry);
+    }
+}
+
+void EventGenerator::writeEvent(const EventRecord& record)
+{
+    Accepted_ = record.accepted;
+    particles_->Clear();
+    setParticles(particles_, record.particles);
+    Npart_ = record.particles.size();
+
+    if (gin_file_ && record.passed) {
+        writeGinEvent(record.particles, record.beam_momentum_lab);
+    }
+    if (values_tree_) {
+        proton_data_.write(record.effective_proton_momentum, 
+                           record.beam_proton_theta_scat_cm);
+    }
+
+    beam_momentum_lab_.push_back(record.beam_momentum_lab);
+    beam_momentum_cm_.push_back(record.beam_momentum_cm);
+    beam_energy_lab_.push_back(record.beam_energy_lab);
+    beam_energy_cm_.push_back(record.beam_energy_cm);
+    inv_mass_pd_.push_back(record.inv_mass_pd);
+    target_neutron_momentum_cm_.push_back(record.target_neutron_momentum_cm);
+    target_neutron_theta_cm_.push_back(record.target_neutron_theta_cm);
+    target_neutron_phi_cm_.push_back(record.target_neutron_phi_cm);
+    target_proton_momentum_cm_.push_back(record.target_proton_momentum_cm);
+    target_proton_theta_cm_.push_back(record.target_proton_theta_cm);
+    target_proton_phi_cm_.push_back(record.target_proton_phi_cm);
+    proton_proton_angle_.push_back(record.proton_proton_angle);
+    inv_mass_pp_.push_back(record.inv_mass_pp);
+    effective_proton_mass_.push_back(record.effective_proton_mass);
+    effective_proton_momentum_.push_back(record.effective_proton_momentum);
+    beam_proton_momentum_pp_.push_back(record.beam_proton_momentum_pp);
+    target_proton_momentum_pp_.push_back(record.target_proton_momentum_pp);
+    beam_proton_theta_scat_cm_.push_back(record.beam_proton_theta_scat_cm);
+    beam_proton_phi_scat_cm_.push_back(record.beam_proton_phi_scat_cm);
+    target_proton_theta_scat_cm_.push_back(record.target_proton_theta_scat_cm);
+    target_proton_phi_scat_cm_.push_back(record.target_proton_phi_scat_cm);
+    target_proton_energy_cm_.push_back(record.target_proton_energy_cm);
+    if (acceptance_) accepted_.push_back(record.accepted);
+
+    if (particles_tree_ && record.passed) particles_tree_->Fill();
+    for (size_t i = 0; i < reduced_columns_.size(); ++i) {
+        PrecisionSpec::set(*reduced_columns_[i].first,
+                           reduced_columns_[i].second->front());
+    }
+    if (data_tree_) data_tree_->Fill();
+    if (histograms_) histograms_->fill();
+    if (arrow_.isOpen()) arrow_.fill();
+
+    clearVectors();
+}
+
+EventRecord* EventGenerator::claimRecord()
+{
+    if (!ring_) return &record_;
+
+    EventRecord* record = ring_->claim();
+    if (record) return record;
+
+    // Back-pressure: the writer thread lags behind the generation
+    ++ring_stalls_;
+    stall_timer_.Start(kFALSE);
+    while (!(record = ring_->claim())) usleep(RING_POLL_US);
+    stall_timer_.Stop();
+    return record;
+}
+
+void EventGenerator::commitRecord()
+{
+    if (!ring_) {
+        writeEvent(record_);
+        return;
+    }
+    ring_->publish();
+    size_t queued = ring_->size();
+    if (queued > ring_peak_) ring_peak_ = queued;
+}
+
+void EventGenerator::drainRecords()
+{
+    while (ring_ && ring_->size() > 0) usleep(RING_POLL_US);
+}
+
+void* EventGenerator::writerLoop(void* arg)
+{
+    EventGenerator* generator = static_cast<EventGenerator*>(arg);
+    SpscRing<EventRecord>* ring = generator->ring_;
+    for (;;) {
+        EventRecord* record = ring->front();
+        if (record) {
+            generator->writeEvent(*record);
+            ring->release();
+        } else if (generator->writer_stop_) {
+            // Stop is set after the last record was published
+            if (!ring->front()) break;
+        } else {
+            ++generator->writer_waits_;
+            usleep(RING_POLL_US);
+        }
+    }
+    return NULL;
+}
+
+Bool_t EventGenerator::startWriter()
+{
+    if (async_slots_ <= 0) return true;
+    ring_ = new SpscRing<EventRecord>(async_slots_);
+    writer_stop_ = false;
+    ring_stalls_ = writer_waits_ = 0;
+    ring_peak_ = 0;
+    stall_timer_.Reset();
+    if (pthread_create(&writer_thread_, NULL, writerLoop, this) != 0) {
+        std::cerr << "Failed to start the writer thread." << std::endl;
+        delete ring_;
+        ring_ = NULL;
+        return false;
+    }
+    return true;
+}
+
+void EventGenerator::stopWriter()
+{
+    if (!ring_) return;
+    __sync_synchronize();
+    writer_stop_ = true;
+    pthread_join(writer_thread_, NULL);
+    delete ring_;
+    ring_ = NULL;
+
+    // Frequent stalls mean the output (compression) limits the run, a ring
+    // mostly empty that the generation does
+    std::cout << "Writer thread: " << ring_stalls_ << " stalls on a full ring (" 
+              << stall_timer_.RealTime() << " s waiting), peak " << ring_peak_ 
+              << " of " << async_slots_ << " slots, " << writer_waits_ 
+              << " idle polls" << std::endl;
+}
+
+void EventGenerator::writeGinEvent(
+    const std::vector<ParticleData>& particles_data, 
+    Double_t beam_momentum)
+{
+    gin_file_->Reset();
+    gin_file_->SetBeamPz(beam_momentum);
+    for (size_t i = 0; i < particles_data.size(); ++i) {
+        gin_file_->AddParticle(getGeantId(particles_data[i].name), 
+                               &particles_data[i].vector);
+    }
+    gin_file_->WriteEvent(1.);
+}
+
+Int_t EventGenerator::getGeantId(const std::string& name)
+{
+    if (name == "g") return 1;
+    if (name == "pi0") return 7;
+    if (name == "n") return 13;
+    if (name == "p") return 14;
+    if (name == "d") return 45;
+    if (name == "He3") return 49;
+    std::cerr << "No GEANT code for particle: " << name << std::endl;
+    return 0;
+}
+
+Bool_t EventGenerator::runSimulations(
+    const SimulationOptions& options, TGraph* graph)
 {
     DataWriter dataWriter;
+    const std::string& model_name = options.model_name;
+
+    // A continued run is set up from the options recorded in its checkpoint;
+    // runs streamed to WMC (--gin) are not checkpointed
+    Bool_t continued = options.resume || options.extend_events > 0;
+    if (continued && !options.recorded.empty()) {
+        std::cerr << "Continued runs take their options from the checkpoint, " 
+                  << "only --checkpoint and --async can be given." << std::endl;
+        return false;
+    }
+    RunCheckpoint checkpoint;
+    std::string checkpoint_path = DataWriter::getCheckpointPath(model_name);
+    SimulationOptions run = options;
+    if (continued) {
+        if (!checkpoint.load(checkpoint_path)) return false;
+        std::vector<std::string> args = checkpoint.arguments();
+        args.insert(args.begin(), model_name);
+        run = SimulationOptions();
+        if (!run.parse(args)) {
+            std::cerr << "Invalid options in checkpoint " << checkpoint_path 
+                      << std::endl;
+            return false;
+        }
+        run.checkpoint_interval = options.checkpoint_interval;
+        run.async_slots = options.async_slots;
+    }
+    const std::string& gin_file_path = run.gin_file;
+
+    // The entries of both trees of a single file are the same events
+    if (run.single_file && (!gin_file_path.empty() || !run.values_tree ||
+        (!run.acceptance_file.empty() && run.acceptance_mode == "drop"))) {
+        std::cerr << "--single-file needs the PLUTO and the values tree of " 
+                  << "every event: it cannot be combined with --gin, " 
+                  << "--no-values or dropping events by --acceptance." 
+                  << std::endl;
+        return false;
+    }
+
+    if (!run.precision_file.empty() && !run.values_tree) {
+        std::cerr << "--precision applies to the values tree, it cannot be " 
+                  << "combined with --no-values." << std::endl;
+        return false;
+    }
+
+    if (continued) {
+        if (!checkpoint.restoreRandom(rand_gen.getEngine())) return false;
+        if (options.extend_events > 0) {
+            if (!checkpoint.isComplete()) {
+                std::cerr << "The run in " << checkpoint_path 
+                          << " is not finished, resume it first." << std::endl;
+                return false;
+            }
+            checkpoint.total_events += options.extend_events;
+        } else if (checkpoint.isComplete()) {
+            std::cout << "All " << checkpoint.total_events << " events of " 
+                      << checkpoint_path << " are already written." << std::endl;
+            return true;
+        }
+        std::cout << "Continuing after event " << checkpoint.events_generated 
+                  << " of " << checkpoint.total_events << std::endl;
+    } else {
+        checkpoint.seed = run.seed ? run.seed : static_cast<UInt_t>(time(NULL));
+        rand_gen.setSeed(checkpoint.seed);
+        checkpoint.total_events = 
+            static_cast<Long64_t>(run.num_events) * run.num_iterations;
+        checkpoint.events_per_file = run.num_events;
+        checkpoint.options = run.recorded;
+    }
+
+    // Files added by an extension are written like the first ones
+    OutputProfile profile;
+    if (!OutputProfile::get(run.output_profile.empty() ? 
+                            "default" : run.output_profile, profile)) {
+        return false;
+    }
+    dataWriter.setProfile(profile);
+    if (!run.output_profile.empty()) {
+        std::cout << "Output profile: " << profile.describe() << std::endl;
+    }
+
+    // The branches of a resumed values tree keep their storage types
+    PrecisionSpec precision;
+    if (!run.precision_file.empty()) {
+        if (!precision.load(run.precision_file)) return false;
+        std::cout << "Reduced-precision columns:";
+        for (size_t i = 0; i < precision.columns().size(); ++i) {
+            const PrecisionSpec::Column& column = precision.columns()[i];
+            std::cout << " " << column.name << " ("
+                      << PrecisionSpec::describe(column) << ")";
+        }
+        std::cout << std::endl;
+    }
+
+    std::vector<std::string> arrow_columns;
+    if (!run.arrow_columns.empty() && 
+        !ArrowWriter::parseColumns(run.arrow_columns, arrow_columns)) {
+        return false;
+    }
+
+    ProtonDataWriter::Format proton_format = ProtonDataWriter::kBinary;
+    if (!run.proton_format.empty() && 
+        !ProtonDataWriter::parseFormat(run.proton_format, proton_format)) {
+        return false;
+    }
+
+    // The writer threads fill the trees while the next events are generated
+    if (run.async_slots > 0) {
+#if ROOT_VERSION_CODE >= ROOT_VERSION(6,0,0)
+        ROOT::EnableThreadSafety();
+#else
+        TThread::Initialize();
+#endif
+    }
+
+    AcceptanceFilter acceptance;
+    if (!run.acceptance_file.empty()) {
+        if (!acceptance.load(run.acceptance_file, run.acceptance_mode)) {
+            return false;
+        }
+        std::cout << "Acceptance filter: " << acceptance.label() << std::endl;
+    }
+
+    GINFile gin_file;
+    if (!gin_file_path.empty()) {
+        std::cout << "Writing WMC input to: " << gin_file_path << std::endl;
+        if (gin_file.WriteHeader(gin_file_path.c_str(), Constants::GIN_REACTION_ID,
+                Constants::BEAM_MOMENTUM_MAX, 
+                static_cast<Int_t>(checkpoint.total_events))) {
+            std::cerr << "Failed to open WMC input file: " << gin_file_path 
+                      << std::endl;
+            return false;
+        }
+    }
+
+    // Iteration i holds the generated events [i * E, (i + 1) * E) of the
+    // run, E being the number of events per iteration; a resumed or
+    // extended run completes the partially written file first
+    while (!checkpoint.isComplete()) {
+        Long64_t events_per_file = checkpoint.events_per_file;
+        Int_t iteration = static_cast<Int_t>(
+            checkpoint.events_generated / events_per_file);
+        Long64_t first_event = checkpoint.events_generated % events_per_file;
+        Long64_t num_events = TMath::Min(events_per_file - first_event, 
+            checkpoint.total_events - checkpoint.events_generated);
+        checkpoint.file_index = iteration + 1;
 
-    for (Int_t iteration = 0; iteration < num_iterations; ++iteration) {
         std::cout << "Processing simulation run " << (iteration + 1) << "..." 
                   << std::endl;
 
-        std::string pluto_file_path = 
+        std::string pluto_file_path = run.single_file ? 
+            DataWriter::getCombinedFilePath(model_name, iteration) : 
             DataWriter::getPlutoFilePath(model_name, iteration);
-        std::string data_file_path = 
+        std::string data_file_path = run.single_file ? pluto_file_path :
             DataWriter::getDataFilePath(model_name, iteration);
         std::string proton_file_path = 
-            DataWriter::getProtonFilePath(model_name, iteration);
+            DataWriter::getProtonFilePath(model_name, iteration, proton_format);
+        std::string histogram_file_path = 
+            DataWriter::getHistogramFilePath(model_name, iteration);
+        std::string arrow_file_path = 
+            DataWriter::getArrowFilePath(model_name, iteration);
         
         // Initialise EventGenerator with the current model's graph and file names
         EventGenerator eventGenerator(graph, dataWriter, pluto_file_path,
-                                      data_file_path, proton_file_path);
+                                      data_file_path, proton_file_path,
+                                      gin_file_path.empty() ? NULL : &gin_file);
+        eventGenerator.enableCheckpoints(&checkpoint, 
+            gin_file_path.empty() ? checkpoint_path : "", 
+            run.checkpoint_interval);
+        if (!run.acceptance_file.empty()) {
+            eventGenerator.setAcceptance(&acceptance);
+        }
+        eventGenerator.setValuesTree(run.values_tree);
+        eventGenerator.setProtonFormat(proton_format);
+        eventGenerator.setAsyncOutput(run.async_slots);
+        eventGenerator.setSingleFile(run.single_file);
+        EventCatalogue::Entry catalogue_run;
+        catalogue_run.first_event = iteration * events_per_file;
+        catalogue_run.seed = checkpoint.seed;
+        catalogue_run.model = model_name;
+        catalogue_run.reaction = "pd -> ppn_spec";
+        eventGenerator.setCatalogue(catalogue_run);
+        if (!run.precision_file.empty()) eventGenerator.setPrecision(&precision);
+        if (!run.arrow_columns.empty()) {
+            eventGenerator.setArrowOutput(arrow_file_path, arrow_columns);
+        }
+
+        // Every file gets its own histograms
+        HistogramBank histograms;
+        if (!run.histogram_file.empty()) {
+            if (!histograms.load(run.histogram_file)) {
+                if (!gin_file_path.empty()) gin_file.Close();
+                return false;
+            }
+            eventGenerator.setHistograms(&histograms, histogram_file_path);
+        }
         
         // Generate and process events
-        eventGenerator.generateEvents(num_events);
+        if (!eventGenerator.generateEvents(static_cast<Int_t>(num_events), 
+                                           first_event)) {
+            if (!gin_file_path.empty()) gin_file.Close();
+            return false;
+        }
 
         std::cout << "Simulation run " << (iteration + 1) << " completed." 
                   << std::endl;
-        std::cout << "PLUTO file: " << pluto_file_path << std::endl;
-        std::cout << "Calculated data file: " << data_file_path << std::endl;
-        std::cout << "Proton data file: " << proton_file_path 
-                  << std::endl << std::endl;
+        if (run.single_file) {
+            std::cout << "PLUTO and calculated data file: " << pluto_file_path 
+                      << std::endl;
+        } else if (gin_file_path.empty()) {
+            std::cout << "PLUTO file: " << pluto_file_path << std::endl;
+        }
+        if (run.values_tree && !run.single_file) {
+            std::cout << "Calculated data file: " << data_file_path << std::endl;
+        }
+        if (run.values_tree) {
+            std::cout << "Proton data file: " << proton_file_path << std::endl;
+        }
+        if (!run.histogram_file.empty()) {
+            std::cout << "Histogram file: " << histogram_file_path << std::endl;
+        }
+        if (!run.arrow_columns.empty()) {
+            std::cout << "Arrow file: " << arrow_file_path << std::endl;
+        }
+        std::cout << std::endl;
 
     }
+    if (!gin_file_path.empty()) gin_file.Close();
     std::cout << "Simulation completed successfully." << std::endl;
+    return true;
 }
 
 void EventGenerator::cleanup() 
 {
-    if (particles_tree_ != NULL) {
-        delete particles_tree_;
-        particles_tree_ = NULL;
+    stopWriter();
+
+    // Counts for the normalisation of the acceptance
+    if (acceptance_) {
+        if (pluto_file_) {
+            acceptance_->writeCounts(pluto_file_, file_generated_, file_accepted_);
+        }
+        if (data_file_ && data_file_ != pluto_file_) {
+            acceptance_->writeCounts(data_file_, file_generated_, file_accepted_);
+        }
     }
 
-    if (data_tree_ != NULL) {
-        delete data_tree_;
-        data_tree_ = NULL;
+    // A single file is closed with the PLUTO tree
+    if (data_file_ && data_file_ == pluto_file_) {
+        data_file_->cd();
+        if (data_tree_) data_tree_->Write("", TObject::kOverwrite);
+        data_file_ = NULL;
     }
 
+    // The trees are owned and deleted by their files
+    writer_.closeTreeFile(pluto_file_, particles_tree_);
+    particles_tree_ = NULL;
+    writer_.closeTreeFile(data_file_, data_tree_);
+    data_tree_ = NULL;
+
+    proton_data_.close();
+    arrow_.close();
+
     if (particles_ != NULL) {
         delete particles_;
         particles_ = NULL;
@@ -0,0 +1,158 @@
+/**
+ * @file histogram_bank.cpp
+ * @author AK <alex.nuclearboy@gmail.com>
+ * @brief Implementation of the HistogramBank class.
+ *
+ * @date 2026-10-18
+ *
+ * @note Distributed under the GNU General Public License version 3.0 (GPLv3).
+ */
+
+#include "histogram_bank.h"
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include "TFile.h"
+#include "TH1D.h"
+#include "TH2D.h"
+#include "TParameter.h"
+
+HistogramBank::HistogramBank() {}
+
+HistogramBank::~HistogramBank()
+{
+    for (size_t i = 0; i < histograms_.size(); ++i) {
+        delete histograms_[i].histogram;
+    }
+}
+
+Bool_t HistogramBank::load(const std::string& config_file)
+{
+    std::ifstream in(config_file.c_str());
+    if (!in.is_open()) {
+        std::cerr << "Failed to open histogram definitions: " << config_file
+                  << std::endl;
+        return false;
+    }
+
+    std::string line, type, name;
+    Int_t line_number = 0;
+    while (std::getline(in, line)) {
+        ++line_number;
+        std::istringstream iss(line);
+        if (!(iss >> type) || type[0] == '#') continue;
+
+        Histogram h;
+        h.histogram = NULL;
+        h.x_column = h.y_column = NULL;
+        Int_t x_bins = 0, y_bins = 0;
+        Double_t x_min = 0, x_max = 0, y_min = 0, y_max = 0;
+        if (type == "h1" &&
+            iss >> name >> h.x_variable >> x_bins >> x_min >> x_max &&
+            x_bins > 0 && x_max > x_min) {
+            h.histogram = new TH1D(name.c_str(), h.x_variable.c_str(),
+                                   x_bins, x_min, x_max);
+        } else if (type == "h2" &&
+            iss >> name >> h.x_variable >> x_bins >> x_min >> x_max
+                >> h.y_variable >> y_bins >> y_min >> y_max &&
+            x_bins > 0 && x_max > x_min && y_bins > 0 && y_max > y_min) {
+            std::string title = h.y_variable + " vs " + h.x_variable;
+            h.histogram = new TH2D(name.c_str(), title.c_str(),
+                                   x_bins, x_min, x_max, y_bins, y_min, y_max);
+        } else {
+            std::cerr << "Invalid histogram definition in line " << line_number
+                      << " of " << config_file << ": " << line << std::endl;
+            return false;
+        }
+        h.histogram->SetDirectory(NULL);    // Owned by the bank
+        histograms_.push_back(h);
+    }
+    return true;
+}
+
+void HistogramBank::bind(
+    const std::string& variable, const std::vector<Double_t>* column)
+{
+    for (size_t i = 0; i < histograms_.size(); ++i) {
+        if (histograms_[i].x_variable == variable) histograms_[i].x_column = column;
+        if (histograms_[i].y_variable == variable) histograms_[i].y_column = column;
+    }
+}
+
+Bool_t HistogramBank::isBound() const
+{
+    Bool_t bound = true;
+    for (size_t i = 0; i < histograms_.size(); ++i) {
+        const Histogram& h = histograms_[i];
+        if (!h.x_column || (!h.y_variable.empty() && !h.y_column)) {
+            std::cerr << "Unknown variable in histogram "
+                      << h.histogram->GetName() << ": " << h.x_variable << " "
+                      << h.y_variable << std::endl;
+            bound = false;
+        }
+    }
+    return bound;
+}
+
+void HistogramBank::fill()
+{
+    for (size_t i = 0; i < histograms_.size(); ++i) {
+        Histogram& h = histograms_[i];
+        if (h.x_column->empty()) continue;
+        if (h.y_column) {
+            if (h.y_column->empty()) continue;
+            static_cast<TH2D*>(h.histogram)->Fill(h.x_column->front(),
+                                                  h.y_column->front());
+        } else {
+            h.histogram->Fill(h.x_column->front());
+        }
+    }
+}
+
+Long64_t HistogramBank::merge(const std::string& file_name)
+{
+    TFile* file = TFile::Open(file_name.c_str(), "READ");
+    TParameter<Long64_t>* filled = NULL;
+    if (file && !file->IsZombie()) file->GetObject("EventsFilled", filled);
+    if (!filled) {
+        std::cerr << "Failed to open histograms: " << file_name << std::endl;
+        delete file;
+        return -1;
+    }
+    Long64_t events = filled->GetVal();
+    for (size_t i = 0; i < histograms_.size(); ++i) {
+        TH1* saved = NULL;
+        file->GetObject(histograms_[i].histogram->GetName(), saved);
+        if (!saved) {
+            std::cerr << "Histogram " << histograms_[i].histogram->GetName()
+                      << " not found in " << file_name << std::endl;
+            events = -1;
+            continue;
+        }
+        histograms_[i].histogram->Add(saved);
+    }
+    delete file;
+    return events;
+}
+
+Bool_t HistogramBank::write(const std::string& file_name, Long64_t events) const
+{
+    // A checkpoint must never see a partially written file
+    std::string tmp_name = file_name + ".tmp";
+    TFile file(tmp_name.c_str(), "RECREATE");
+    if (!file.IsOpen()) {
+        std::cerr << "Failed to open file: " << tmp_name << std::endl;
+        return false;
+    }
+    for (size_t i = 0; i < histograms_.size(); ++i) {
+        histograms_[i].histogram->Write();
+    }
+    TParameter<Long64_t>("EventsFilled", events).Write();
+    file.Close();
+    if (rename(tmp_name.c_str(), file_name.c_str()) != 0) {
+        std::cerr << "Failed to write histograms: " << file_name << std::endl;
+        return false;
+    }
+    return true;
+}
@@ -61,19 +61,6 @@ Bool_t LibraryManager::initialiseLibraries()
     std::cout << "Include path for PLUTO headers set to: " << include_path 
               << std::endl;
 
-    // Compile and dynamically load the GINFile.cxx source file.
-    // This process involves compiling GINFile.cxx into a shared object (GINFile_cxx.so)
-    // and loading it for use within the current ROOT session.
-    std::cout << "Compiling and loading GINFile.cxx..." << std::endl;
-    if (gROOT->ProcessLine(".L ../src/GINFile.cxx+") == -1) {
-        std::cerr << "Compilation of GINFile.cxx failed." << std::endl;
-        return false;
-    }
-    if (gSystem->Load("../src/GINFile_cxx.so") == -1) {
-        std::cerr << "Unable to load GINFile_cxx.so" << std::endl;
-        return false;
-    }
-
     std::cout << "All libraries loaded successfully. "
               << "Simulation environment is ready." << std::endl;
 
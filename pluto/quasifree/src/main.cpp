@@ -17,7 +17,67 @@
  * The program outputs:
  * - A ROOT file containing the simulated events.
  * - A ROOT file with calculated data from the events.
- * - A text file listing the proton momentum and scattering angle.
+ * - A binary or text file listing the proton momentum and scattering angle.
+ *
+ * Usage: run_simulate <Model Name> [--events N] [--iterations N] [--gin FILE]
+ *                     [--checkpoint N] [--seed S] [--resume | --extend N]
+ *                     [--acceptance FILE [--acceptance-mode drop|flag]]
+ *                     [--histograms FILE] [--no-values]
+ *                     [--proton-format binary|text] [--async N]
+ *                     [--profile default|none|fast|archive] [--single-file]
+ *                     [--precision FILE] [--arrow all|COLUMNS]
+ *
+ * With --gin the events are written in the WMC input format (GINFile) to
+ * FILE instead of the PLUTO ROOT files. FILE may be a named pipe read by
+ * WMC as fort.31 (see wmc/wmc_stream.sh), so that the detector simulation
+ * runs while the events are generated.
+ *
+ * The run is checkpointed every N events (--checkpoint, default 100000;
+ * 0 - only at the end of each file) in ../data/ppn_spec-<model>.ckpt.
+ * --resume continues an interrupted run exactly where it stopped, and
+ * --extend N appends N events to a finished run, continuing its random
+ * number stream. Both take the other options from the checkpoint, only
+ * --checkpoint and --async may be given again.
+ *
+ * --acceptance checks the outgoing particles against the detector acceptance
+ * windows in FILE (e.g. ../../config/acceptance_B009.dat). Events outside
+ * the acceptance are not passed to WMC (PLUTO file or --gin) in the drop
+ * mode, or written with Accepted = 0 in the flag mode; the calculated
+ * values keep all generated events with an "accepted" column.
+ *
+ * --histograms fills the histograms defined in FILE (see histogram_bank.h
+ * and ../../config/histograms_ppn_spec.dat) with the calculated values of
+ * every event and writes them to ../data/hist_ppn_spec-<model>-<i>.root.
+ * --no-values leaves out the per-event calculated values (the ROOT file
+ * with the "values" tree and the proton data file).
+ *
+ * The proton data (momentum and scattering angle) are streamed to
+ * ../data/proton_momentum_theta-<model>-<i>.bin as fixed-size binary
+ * records (see proton_data_writer.h), or with --proton-format text to the
+ * .txt file of tab-separated pairs written by the earlier versions.
+ *
+ * --async N writes the output by a separate thread, fed through a ring of
+ * N events, so that the generation overlaps with the compression of the
+ * ROOT files. The thread reports how often the generation had to wait for
+ * it; the output is the same as without --async.
+ *
+ * --profile sets the compression, basket size and cluster size of the ROOT
+ * files (see output_profile.h); compression_benchmark compares the
+ * profiles on files written by a run.
+ *
+ * --single-file writes the PLUTO tree "data" and the calculated values
+ * "values" (with "data" as a friend) to ../data/ppn_spec-<model>-<i>.root
+ * instead of two files. split_output extracts the PLUTO file for WMC.
+ *
+ * --precision stores the columns of the "values" tree listed in FILE (see
+ * precision_spec.h and ../../config/precision_ppn_spec.dat) as float,
+ * Float16_t or Double32_t instead of double. precision_report shows the
+ * precision lost on the output of a full-precision run.
+ *
+ * --arrow writes the calculated values (all, or the comma-separated
+ * COLUMNS of the "values" tree) to ../data/values_ppn_spec-<model>-<i>.arrow
+ * as Arrow IPC (Feather) record batches while the events are generated
+ * (see arrow_writer.h), also with --no-values.
  *
  * @version 2.0
  * @date 2024-02-23
@@ -29,15 +89,13 @@
 #include "library_manager.h"
 #include "event_generator.h"
 #include "data_writer.h"
+#include "simulation_options.h"
 #include <iostream>
 #include <cstdlib>
 #include <string>
+#include <vector>
 #include "TGraph.h"
 
-// Constants for the simulation
-const Int_t NUM_EVENTS = 1000;
-const Int_t NUM_ITERATIONS = 2;
-
 /**
  * @brief Main function to initialise the simulation for a specific model.
  *
@@ -54,8 +112,21 @@ const Int_t NUM_ITERATIONS = 2;
  * @return 0 upon successful completion, or 1 if an error occurs.
  */
 Int_t main(Int_t argc, char** argv) {
-    if (argc != 2) {
-        std::cerr << "Usage: " << argv[0] << " <Model Name>" << std::endl;
+    SimulationOptions options;
+    if (!options.parse(std::vector<std::string>(argv + 1, argv + argc))) {
+        std::cerr << "Usage: " << argv[0] << " <Model Name> [--events N] "
+                  << "[--iterations N] [--gin FILE] [--checkpoint N] "
+                  << "[--seed S]" << std::endl
+                  << "       " << argv[0] << "    [--acceptance FILE "
+                  << "[--acceptance-mode drop|flag]] [--histograms FILE] "
+                  << "[--no-values]" << std::endl
+                  << "       " << argv[0] << "    [--proton-format binary|text] "
+                  << "[--async N] [--profile NAME] [--single-file] "
+                  << "[--precision FILE]" << std::endl
+                  << "       " << argv[0] << "    [--arrow all|COLUMNS]" 
+                  << std::endl
+                  << "       " << argv[0] << " <Model Name> --resume | "
+                  << "--extend N [--checkpoint N] [--async N]" << std::endl;
         return 1;
     }
 
@@ -77,7 +148,7 @@ Int_t main(Int_t argc, char** argv) {
     if (!LibraryManager::initialiseLibraries()) return 1;
 
     // Model selection and data loading
-    std::string model_name = argv[1];
+    const std::string& model_name = options.model_name;
     TGraph* graph = MomentumDataLoader::loadDeuteronNMD(model_name);
     if (graph == NULL || graph->GetN() <= 0) {
         std::cerr << "Error: Failed to load momentum distribution data." 
@@ -89,10 +160,10 @@ Int_t main(Int_t argc, char** argv) {
     std::cout << "Initializing simulation for model: " << model_name 
               << std::endl << std::endl;
 
-    EventGenerator::runSimulations(model_name, graph, NUM_EVENTS, NUM_ITERATIONS);
+    Bool_t success = EventGenerator::runSimulations(options, graph);
 
     // Clean up
     delete graph;
 
-    return 0;
+    return success ? 0 : 1;
 }
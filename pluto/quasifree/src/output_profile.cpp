@@ -0,0 +1,117 @@
+/**
+ * @file output_profile.cpp
+ * @author AK <alex.nuclearboy@gmail.com>
+ * @brief Implementation of the output profiles.
+ *
+ * @date 2026-10-18
+ *
+ * @note Distributed under the GNU General Public License version 3.0 (GPLv3).
+ */
+
+#include "output_profile.h"
+#include <iostream>
+#include <sstream>
+#include "RVersion.h"
+
+namespace {
+    // Compression algorithms of ROOT (ROOT::ECompressionAlgorithm)
+    const Int_t ZLIB = 1;
+    const Int_t LZMA = 2;
+    const Int_t LZ4 = 4;
+    const Int_t ZSTD = 5;
+
+    const Int_t BASKET_SIZE = 256000;           ///< 8 times the ROOT default.
+    const Long64_t CLUSTER_BYTES = -30000000;   ///< ROOT default: 30 MB.
+    const Long64_t ARCHIVE_CLUSTER_BYTES = -100000000;
+
+    const char* algorithmName(Int_t algorithm)
+    {
+        switch (algorithm) {
+            case ZLIB: return "ZLIB";
+            case LZMA: return "LZMA";
+            case LZ4:  return "LZ4";
+            case ZSTD: return "ZSTD";
+        }
+        return "?";
+    }
+}
+
+Bool_t OutputProfile::get(const std::string& name, OutputProfile& profile)
+{
+    profile = OutputProfile();
+    profile.name = name;
+    if (name == "default") return true;
+
+    if (name == "none") {
+        profile.compression = 0;
+        profile.basket_size = BASKET_SIZE;
+        profile.auto_flush = CLUSTER_BYTES;
+    } else if (name == "fast") {
+#if ROOT_VERSION_CODE >= ROOT_VERSION(6,12,0)
+        profile.compression = 100 * LZ4 + 4;
+#else
+        profile.compression = 100 * ZLIB + 1;
+#endif
+        profile.basket_size = BASKET_SIZE;
+        profile.auto_flush = CLUSTER_BYTES;
+    } else if (name == "archive") {
+#if ROOT_VERSION_CODE >= ROOT_VERSION(6,20,0)
+        profile.compression = 100 * ZSTD + 9;
+#else
+        profile.compression = 100 * LZMA + 8;
+#endif
+        // Larger baskets and clusters compress better
+        profile.basket_size = 4 * BASKET_SIZE;
+        profile.auto_flush = ARCHIVE_CLUSTER_BYTES;
+    } else {
+        std::cerr << "Unknown output profile: " << name << " (";
+        std::vector<std::string> known = names();
+        for (size_t i = 0; i < known.size(); ++i) {
+            std::cerr << (i ? ", " : "") << known[i];
+        }
+        std::cerr << ")" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+std::vector<std::string> OutputProfile::names()
+{
+    std::vector<std::string> known;
+    known.push_back("default");
+    known.push_back("none");
+    known.push_back("fast");
+    known.push_back("archive");
+    return known;
+}
+
+void OutputProfile::apply(TFile* file) const
+{
+    if (file && compression >= 0) file->SetCompressionSettings(compression);
+}
+
+void OutputProfile::apply(TTree* tree) const
+{
+    if (!tree) return;
+    if (basket_size > 0) tree->SetBasketSize("*", basket_size);
+    if (auto_flush != 0) tree->SetAutoFlush(auto_flush);
+}
+
+std::string OutputProfile::describe() const
+{
+    std::ostringstream oss;
+    oss << name << " (";
+    if (compression < 0) {
+        oss << "ROOT defaults)";
+        return oss.str();
+    }
+    if (compression % 100 == 0) {
+        oss << "uncompressed";
+    } else {
+        oss << algorithmName(compression / 100) << " level "
+            << (compression % 100);
+    }
+    oss << ", baskets " << basket_size / 1000 << " kB, clusters "
+        << -auto_flush / 1000000 << " MB)";
+    return oss.str();
+}
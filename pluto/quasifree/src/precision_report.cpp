@@ -0,0 +1,204 @@
+/**
+ * @file precision_report.cpp
+ * @author AK <alex.nuclearboy@gmail.com>
+ * @brief Reports the precision lost by storing columns of the "values" tree
+ *        with reduced precision.
+ *
+ * Usage: precision_report [--dir DIR] <precision spec> <file>...
+ *
+ * The columns of the precision specification (see precision_spec.h) are
+ * read from the "values" tree of each file, written by a full-precision
+ * run, and stored with their reduced types in a scratch file in DIR
+ * (default: /tmp), which is read back and removed. For each column the
+ * program prints the maximum and RMS absolute error, the maximum relative
+ * error (of values not smaller than 1e-6 in magnitude) and the compressed
+ * size of the full-precision and the reduced branch. The scratch file has
+ * the compression settings of the input file.
+ *
+ * @date 2026-10-18
+ *
+ * @note Distributed under the GNU General Public License version 3.0 (GPLv3).
+ */
+
+#include "precision_spec.h"
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <unistd.h>
+#include <vector>
+#include "TBranch.h"
+#include "TFile.h"
+#include "TMath.h"
+#include "TTree.h"
+
+/**
+ * @brief Precision lost in a column.
+ */
+struct ColumnError {
+    Double_t max_abs;
+    Double_t sum_squares;
+    Double_t max_rel;
+    Long64_t values;
+};
+
+/**
+ * @brief Stores the columns of spec found in the values tree of a file with
+ *        reduced precision, reads them back and prints the errors.
+ *
+ * @return false if the file or the scratch file cannot be used.
+ */
+Bool_t report(const std::string& path, PrecisionSpec& spec,
+              const std::string& dir)
+{
+    TFile* file = TFile::Open(path.c_str(), "READ");
+    TTree* values = NULL;
+    if (file && !file->IsZombie()) file->GetObject("values", values);
+    if (!values) {
+        std::cerr << "No tree \"values\" in " << path << std::endl;
+        delete file;
+        return false;
+    }
+
+    // Only the full-precision columns of the specification are read
+    std::vector<PrecisionSpec::Column*> columns;
+    std::vector<std::vector<Double_t>*> inputs;
+    inputs.reserve(spec.columns().size());  // Branch addresses stay valid
+    values->SetBranchStatus("*", false);
+    for (size_t i = 0; i < spec.columns().size(); ++i) {
+        PrecisionSpec::Column* column = spec.find(spec.columns()[i].name);
+        const char* name = column->name.c_str();
+        if (!values->GetBranch(name)) {
+            std::cerr << path << ": no column " << name << std::endl;
+            continue;
+        }
+        values->SetBranchStatus(name, true);
+        inputs.push_back(NULL);
+        if (values->SetBranchAddress(name, &inputs.back()) < 0) {
+            std::cerr << path << ": column " << name
+                      << " is not stored in full precision" << std::endl;
+            values->SetBranchStatus(name, false);
+            inputs.pop_back();
+            continue;
+        }
+        columns.push_back(column);
+    }
+    if (columns.empty()) {
+        delete file;
+        return false;
+    }
+
+    std::string scratch_path = dir + "/precision_report.root";
+    TFile* scratch = new TFile(scratch_path.c_str(), "RECREATE");
+    if (!scratch->IsOpen()) {
+        std::cerr << "Failed to open file: " << scratch_path << std::endl;
+        delete scratch;
+        delete file;
+        return false;
+    }
+    scratch->SetCompressionSettings(file->GetCompressionSettings());
+    TTree* reduced = new TTree("reduced", "Reduced-precision columns");
+    for (size_t i = 0; i < columns.size(); ++i) {
+        PrecisionSpec::branch(reduced, *columns[i], false);
+    }
+
+    Long64_t entries = values->GetEntries();
+    for (Long64_t entry = 0; entry < entries; ++entry) {
+        values->GetEntry(entry);
+        for (size_t i = 0; i < columns.size(); ++i) {
+            PrecisionSpec::set(*columns[i],
+                               inputs[i]->empty() ? 0. : inputs[i]->front());
+        }
+        reduced->Fill();
+    }
+    reduced->Write();
+
+    // Compared entry by entry after reading the written baskets back
+    std::vector<ColumnError> errors(columns.size());
+    for (size_t i = 0; i < columns.size(); ++i) {
+        errors[i].max_abs = errors[i].sum_squares = errors[i].max_rel = 0;
+        errors[i].values = 0;
+    }
+    for (size_t i = 0; i < columns.size(); ++i) {
+        PrecisionSpec::branch(reduced, *columns[i], true);
+    }
+    for (Long64_t entry = 0; entry < entries; ++entry) {
+        values->GetEntry(entry);
+        reduced->GetEntry(entry);
+        for (size_t i = 0; i < columns.size(); ++i) {
+            if (inputs[i]->empty()) continue;
+            Double_t value = inputs[i]->front();
+            Double_t error = TMath::Abs(PrecisionSpec::get(*columns[i]) - value);
+            ColumnError& column_error = errors[i];
+            column_error.max_abs = TMath::Max(column_error.max_abs, error);
+            column_error.sum_squares += error * error;
+            if (TMath::Abs(value) >= 1e-6) {
+                column_error.max_rel = TMath::Max(column_error.max_rel,
+                                                  error / TMath::Abs(value));
+            }
+            ++column_error.values;
+        }
+    }
+
+    std::cout << path << ": " << entries << " entries" << std::endl
+              << "  column                          type                     "
+              << " max abs     rms abs     max rel   full kB  reduced kB"
+              << std::endl;
+    Double_t full_total = 0, reduced_total = 0;
+    for (size_t i = 0; i < columns.size(); ++i) {
+        const ColumnError& error = errors[i];
+        const char* name = columns[i]->name.c_str();
+        Double_t full_bytes = values->GetBranch(name)->GetZipBytes();
+        Double_t reduced_bytes = reduced->GetBranch(name)->GetZipBytes();
+        full_total += full_bytes;
+        reduced_total += reduced_bytes;
+        std::cout << "  " << std::left << std::setw(32) << name
+                  << std::setw(24) << PrecisionSpec::describe(*columns[i])
+                  << std::right << std::scientific << std::setprecision(2)
+                  << std::setw(10) << error.max_abs
+                  << std::setw(12) << (error.values > 0 ?
+                      TMath::Sqrt(error.sum_squares / error.values) : 0.)
+                  << std::setw(12) << error.max_rel
+                  << std::fixed << std::setprecision(1)
+                  << std::setw(10) << full_bytes / 1000
+                  << std::setw(12) << reduced_bytes / 1000 << std::endl;
+    }
+    std::cout << "  total" << std::setw(95) << full_total / 1000
+              << std::setw(12) << reduced_total / 1000 << std::endl;
+
+    scratch->Close();
+    delete scratch;
+    unlink(scratch_path.c_str());
+    delete file;
+    return true;
+}
+
+Int_t main(Int_t argc, char** argv)
+{
+    std::string dir = "/tmp";
+    std::vector<std::string> arguments;
+    Bool_t valid = true;
+    for (Int_t i = 1; i < argc && valid; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--dir" && i + 1 < argc) {
+            dir = argv[++i];
+        } else if (arg.compare(0, 2, "--") == 0) {
+            valid = false;
+        } else {
+            arguments.push_back(arg);
+        }
+    }
+    if (!valid || arguments.size() < 2) {
+        std::cerr << "Usage: " << argv[0] << " [--dir DIR] <precision spec>"
+                  << " <file>..." << std::endl;
+        return 1;
+    }
+
+    PrecisionSpec spec;
+    if (!spec.load(arguments[0])) return 1;
+
+    Int_t failed = 0;
+    for (size_t f = 1; f < arguments.size(); ++f) {
+        if (!report(arguments[f], spec, dir)) ++failed;
+    }
+    return failed > 0 ? 1 : 0;
+}
@@ -0,0 +1,124 @@
+/**
+ * @file precision_spec.cpp
+ * @author AK <alex.nuclearboy@gmail.com>
+ * @brief Implementation of the PrecisionSpec class.
+ *
+ * @date 2026-10-18
+ *
+ * @note Distributed under the GNU General Public License version 3.0 (GPLv3).
+ */
+
+#include "precision_spec.h"
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include "RVersion.h"
+
+Bool_t PrecisionSpec::load(const std::string& file_name)
+{
+    columns_.clear();
+    std::ifstream in(file_name.c_str());
+    if (!in.is_open()) {
+        std::cerr << "Failed to open precision specification: " << file_name
+                  << std::endl;
+        return false;
+    }
+
+    std::string line, type;
+    Int_t line_number = 0;
+    while (std::getline(in, line)) {
+        ++line_number;
+        std::istringstream iss(line);
+        Column column;
+        if (!(iss >> column.name) || column.name[0] == '#') continue;
+        column.min = column.max = 0;
+        column.bits = 0;
+        column.float_value = 0;
+        column.double_value = 0;
+
+        Bool_t valid = static_cast<Bool_t>(iss >> type);
+        if (valid && type == "double") {
+            column.type = kDouble;
+        } else if (valid && type == "float") {
+            column.type = kFloat;
+        } else if (valid && (type == "float16" || type == "double32")) {
+            column.type = (type == "float16") ? kFloat16 : kDouble32;
+            // ROOT keeps a truncated mantissa in 16 bits with its sign
+            valid = (iss >> column.min >> column.max >> column.bits) &&
+                    column.min <= column.max && column.bits >= 2 &&
+                    column.bits <= (column.min < column.max ? 32 : 14);
+#if ROOT_VERSION_CODE < ROOT_VERSION(6,16,0)
+            std::cerr << "Float16_t and Double32_t leaves need ROOT 6.16 or "
+                      << "newer (column " << column.name << ")." << std::endl;
+            return false;
+#endif
+        } else {
+            valid = false;
+        }
+        if (!valid) {
+            std::cerr << "Invalid precision in line " << line_number << " of "
+                      << file_name << ": " << line << std::endl;
+            return false;
+        }
+        columns_.push_back(column);
+    }
+    return true;
+}
+
+PrecisionSpec::Column* PrecisionSpec::find(const std::string& name)
+{
+    for (size_t i = 0; i < columns_.size(); ++i) {
+        if (columns_[i].name == name) return &columns_[i];
+    }
+    return NULL;
+}
+
+void PrecisionSpec::branch(TTree* tree, Column& column, Bool_t exists)
+{
+    Bool_t is_float = column.type == kFloat || column.type == kFloat16;
+    void* address = is_float ? static_cast<void*>(&column.float_value) :
+                               static_cast<void*>(&column.double_value);
+    if (exists) {
+        tree->SetBranchAddress(column.name.c_str(), address);
+        return;
+    }
+
+    std::ostringstream leaf;
+    leaf << column.name;
+    switch (column.type) {
+        case kDouble:   leaf << "/D"; break;
+        case kFloat:    leaf << "/F"; break;
+        case kFloat16:  leaf << "/f"; break;
+        case kDouble32: leaf << "/d"; break;
+    }
+    if (column.type == kFloat16 || column.type == kDouble32) {
+        leaf << "[" << column.min << "," << column.max << "," << column.bits
+             << "]";
+    }
+    tree->Branch(column.name.c_str(), address, leaf.str().c_str());
+}
+
+void PrecisionSpec::set(Column& column, Double_t value)
+{
+    column.float_value = static_cast<Float_t>(value);
+    column.double_value = value;
+}
+
+Double_t PrecisionSpec::get(const Column& column)
+{
+    return (column.type == kFloat || column.type == kFloat16) ?
+           column.float_value : column.double_value;
+}
+
+std::string PrecisionSpec::describe(const Column& column)
+{
+    std::ostringstream oss;
+    switch (column.type) {
+        case kDouble:   return "double";
+        case kFloat:    return "float";
+        case kFloat16:  oss << "float16"; break;
+        case kDouble32: oss << "double32"; break;
+    }
+    oss << "[" << column.min << "," << column.max << "," << column.bits << "]";
+    return oss.str();
+}
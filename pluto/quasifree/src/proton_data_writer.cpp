@@ -0,0 +1,129 @@
+/**
+ * @file proton_data_writer.cpp
+ * @author AK <alex.nuclearboy@gmail.com>
+ * @brief Implementation of the ProtonDataWriter class.
+ *
+ * @date 2026-10-18
+ *
+ * @note Distributed under the GNU General Public License version 3.0 (GPLv3).
+ */
+
+#include "proton_data_writer.h"
+#include <cstring>
+#include <iostream>
+#include <unistd.h>
+
+namespace {
+    const size_t BUFFER_SIZE = 1 << 20;     ///< Bytes per block.
+    const size_t MAX_RECORD_SIZE = 64;      ///< Longest text line of a record.
+    const UInt_t VERSION = 1;
+    const char MAGIC[4] = { 'P', 'P', 'N', 'P' };
+}
+
+ProtonDataWriter::ProtonDataWriter()
+    : file_(NULL), format_(kText), buffer_(BUFFER_SIZE), used_(0),
+      offset_(0), failed_(false) {}
+
+ProtonDataWriter::~ProtonDataWriter()
+{
+    close();
+}
+
+Bool_t ProtonDataWriter::parseFormat(const std::string& name, Format& format)
+{
+    if (name == "text") {
+        format = kText;
+    } else if (name == "binary") {
+        format = kBinary;
+    } else {
+        std::cerr << "Unknown proton data format: " << name << std::endl;
+        return false;
+    }
+    return true;
+}
+
+const char* ProtonDataWriter::extension(Format format)
+{
+    return format == kBinary ? ".bin" : ".txt";
+}
+
+Bool_t ProtonDataWriter::open(
+    const std::string& file_name, Format format, Long64_t offset)
+{
+    close();
+    file_name_ = file_name;
+    format_ = format;
+    used_ = 0;
+    failed_ = false;
+
+    // The committed part of the file of a resumed run is kept
+    if (offset > 0) {
+        if (truncate(file_name.c_str(), offset) != 0) {
+            std::cerr << "Failed to truncate proton data file: " << file_name
+                      << std::endl;
+            return false;
+        }
+        file_ = fopen(file_name.c_str(), "ab");
+    } else {
+        file_ = fopen(file_name.c_str(), "wb");
+    }
+    if (!file_) {
+        std::cerr << "Failed to open proton data file for writing: "
+                  << file_name << std::endl;
+        return false;
+    }
+    // Blocks are written whole, stdio buffering would only copy them
+    setvbuf(file_, NULL, _IONBF, 0);
+    offset_ = offset;
+
+    if (format_ == kBinary && offset == 0) {
+        UInt_t header[3] = { VERSION, 2 * sizeof(Float_t), 0 };
+        memcpy(&buffer_[0], MAGIC, sizeof(MAGIC));
+        memcpy(&buffer_[sizeof(MAGIC)], header, sizeof(header));
+        used_ = sizeof(MAGIC) + sizeof(header);
+    }
+    return true;
+}
+
+void ProtonDataWriter::write(Double_t momentum, Double_t theta)
+{
+    if (used_ + MAX_RECORD_SIZE > buffer_.size()) flush();
+
+    if (format_ == kBinary) {
+        Float_t record[2] = { static_cast<Float_t>(momentum),
+                              static_cast<Float_t>(theta) };
+        memcpy(&buffer_[used_], record, sizeof(record));
+        used_ += sizeof(record);
+    } else {
+        // Same output as std::ostream with its default precision
+        used_ += snprintf(&buffer_[used_], MAX_RECORD_SIZE, "%g\t%g\n",
+                          momentum, theta);
+    }
+}
+
+Bool_t ProtonDataWriter::flush()
+{
+    if (!file_) return false;
+    if (used_ > 0) {
+        if (fwrite(&buffer_[0], 1, used_, file_) != used_) {
+            if (!failed_) {
+                std::cerr << "Failed to write proton data: " << file_name_
+                          << std::endl;
+            }
+            failed_ = true;
+        } else {
+            offset_ += used_;
+        }
+        used_ = 0;
+    }
+    return !failed_;
+}
+
+Bool_t ProtonDataWriter::close()
+{
+    if (!file_) return true;
+    Bool_t written = flush();
+    if (fclose(file_) != 0) written = false;
+    file_ = NULL;
+    return written;
+}
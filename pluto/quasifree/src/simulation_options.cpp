@@ -0,0 +1,85 @@
+/**
+ * @file simulation_options.cpp
+ * @author AK <alex.nuclearboy@gmail.com>
+ * @brief Parsing of the command-line options of run_simulate.
+ *
+ * @date 2026-10-18
+ *
+ * @note Distributed under the GNU General Public License version 3.0 (GPLv3).
+ */
+
+#include "simulation_options.h"
+#include <cstdlib>
+
+Bool_t SimulationOptions::parse(const std::vector<std::string>& args)
+{
+    for (size_t i = 0; i < args.size(); ++i) {
+        const std::string& arg = args[i];
+        if (arg.compare(0, 2, "--") != 0) {
+            if (!model_name.empty()) return false;
+            model_name = arg;
+            continue;
+        }
+        if (arg == "--resume") {
+            resume = true;
+            continue;
+        }
+        if (arg == "--no-values") {
+            values_tree = false;
+            recorded[arg] = "";
+            continue;
+        }
+        if (arg == "--single-file") {
+            single_file = true;
+            recorded[arg] = "";
+            continue;
+        }
+        if (i + 1 >= args.size()) return false;
+        const std::string& value = args[++i];
+        if (arg == "--checkpoint") {
+            checkpoint_interval = atoll(value.c_str());
+            continue;
+        }
+        if (arg == "--extend") {
+            extend_events = atoll(value.c_str());
+            if (extend_events <= 0) return false;
+            continue;
+        }
+        if (arg == "--async") {
+            async_slots = atoi(value.c_str());
+            if (async_slots <= 0) return false;
+            continue;
+        }
+
+        if (arg == "--events") {
+            num_events = atoi(value.c_str());
+        } else if (arg == "--iterations") {
+            num_iterations = atoi(value.c_str());
+        } else if (arg == "--gin") {
+            gin_file = value;
+        } else if (arg == "--seed") {
+            seed = static_cast<UInt_t>(strtoul(value.c_str(), NULL, 10));
+        } else if (arg == "--acceptance") {
+            acceptance_file = value;
+        } else if (arg == "--acceptance-mode") {
+            acceptance_mode = value;
+        } else if (arg == "--histograms") {
+            histogram_file = value;
+        } else if (arg == "--precision") {
+            precision_file = value;
+        } else if (arg == "--arrow") {
+            arrow_columns = value;
+        } else if (arg == "--profile") {
+            output_profile = value;
+        } else if (arg == "--proton-format") {
+            proton_format = value;
+            if (proton_format != "binary" && proton_format != "text") {
+                return false;
+            }
+        } else {
+            return false;
+        }
+        recorded[arg] = value;
+    }
+    return !model_name.empty() && num_events > 0 && num_iterations > 0;
+}
@@ -0,0 +1,75 @@
+/**
+ * @file split_output.cpp
+ * @author AK <alex.nuclearboy@gmail.com>
+ * @brief Extracts the PLUTO file needed by WMC from a single-file output.
+ *
+ * Usage: split_output <combined file> <PLUTO file>
+ *
+ * run_simulate --single-file writes the PLUTO tree "data" and the
+ * calculated values "values" to one file. WMC reads plain PLUTO files, so
+ * the "data" tree is copied without decompressing its baskets, together
+ * with the acceptance counts (EventsGenerated, EventsAccepted, Acceptance)
+ * if present. The combined file is left unchanged.
+ *
+ * @date 2026-10-18
+ *
+ * @note Distributed under the GNU General Public License version 3.0 (GPLv3).
+ */
+
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include "Rtypes.h"
+#include "TFile.h"
+#include "TTree.h"
+
+Int_t main(Int_t argc, char** argv)
+{
+    if (argc != 3) {
+        std::cerr << "Usage: " << argv[0] << " <combined file> <PLUTO file>"
+                  << std::endl;
+        return 1;
+    }
+    std::string input_path = argv[1];
+    std::string output_path = argv[2];
+
+    TFile* input = TFile::Open(input_path.c_str(), "READ");
+    TTree* tree = NULL;
+    if (input && !input->IsZombie()) input->GetObject("data", tree);
+    if (!tree) {
+        std::cerr << "No PLUTO tree \"data\" in " << input_path << std::endl;
+        delete input;
+        return 1;
+    }
+
+    // Written under a temporary name, so that WMC never sees a partial file
+    std::string tmp_path = output_path + ".tmp";
+    TFile output(tmp_path.c_str(), "RECREATE");
+    if (!output.IsOpen()) {
+        std::cerr << "Failed to open file: " << tmp_path << std::endl;
+        delete input;
+        return 1;
+    }
+    output.SetCompressionSettings(input->GetCompressionSettings());
+    TTree* copy = tree->CloneTree(-1, "fast");
+    copy->Write();
+
+    const char* counts[] = { "EventsGenerated", "EventsAccepted", "Acceptance" };
+    for (size_t i = 0; i < sizeof(counts) / sizeof(counts[0]); ++i) {
+        TObject* object = input->Get(counts[i]);
+        if (object) {
+            output.cd();
+            object->Write(counts[i]);
+        }
+    }
+    Long64_t entries = copy->GetEntries();
+    output.Close();
+    delete input;
+
+    if (rename(tmp_path.c_str(), output_path.c_str()) != 0) {
+        std::cerr << "Failed to write " << output_path << std::endl;
+        return 1;
+    }
+    std::cout << entries << " events written to " << output_path << std::endl;
+    return 0;
+}
@@ -0,0 +1,105 @@
+/**
+ * @file test_arrow_writer.cpp
+ * @author AK <alex.nuclearboy@gmail.com>
+ * @brief Writes the Arrow files read back by test_arrow_writer.py.
+ *
+ * Usage: test_arrow_writer <directory>
+ *
+ * Binds the columns "a", "b" and "c" of row i with the values i, i / 4 and
+ * -i / 3 and selects "c" and "a". full.arrow gets ROWS rows in one run.
+ * resumed.arrow is written by a run which flushes at a checkpoint after
+ * CHECKPOINT rows, writes further rows and stops, and by a second run which
+ * reopens it at the offset of the checkpoint and writes the rows from there
+ * on, as a resumed job does. Both files must hold the same table.
+ *
+ * @date 2026-10-18
+ *
+ * @note Distributed under the GNU General Public License version 3.0 (GPLv3).
+ */
+
+#include "arrow_writer.h"
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace {
+
+const Long64_t ROWS = 150000;       // Two full batches and a partial one
+const Long64_t CHECKPOINT = 70000;  // Within the second batch
+
+struct Columns {
+    std::vector<Double_t> a, b, c;
+
+    void bind(ArrowWriter& writer)
+    {
+        std::vector<std::string> selected;
+        selected.push_back("c");
+        selected.push_back("a");
+        writer.select(selected);
+        writer.bind("a", &a);
+        writer.bind("b", &b);
+        writer.bind("c", &c);
+    }
+
+    void set(Long64_t i)
+    {
+        a.assign(1, static_cast<Double_t>(i));
+        b.assign(1, i / 4.0);
+        c.assign(1, -i / 3.0);
+    }
+};
+
+Bool_t fill(ArrowWriter& writer, Columns& columns, Long64_t first, Long64_t last)
+{
+    for (Long64_t i = first; i < last; ++i) {
+        columns.set(i);
+        writer.fill();
+    }
+    return writer.flush();
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    if (argc != 2) {
+        std::cerr << "Usage: " << argv[0] << " <directory>" << std::endl;
+        return 2;
+    }
+    std::string directory = argv[1];
+    Columns columns;
+
+    ArrowWriter full;
+    columns.bind(full);
+    if (!full.isBound() || !full.open(directory + "/full.arrow") ||
+        !fill(full, columns, 0, ROWS) || !full.close()) {
+        return 1;
+    }
+
+    // First run: the checkpoint, then rows lost by the interruption
+    ArrowWriter first;
+    columns.bind(first);
+    if (!first.open(directory + "/resumed.arrow") ||
+        !fill(first, columns, 0, CHECKPOINT)) {
+        return 1;
+    }
+    Long64_t offset = first.offset();
+    if (!fill(first, columns, CHECKPOINT, ROWS - 1000) || !first.close()) {
+        return 1;
+    }
+
+    // Second run from the checkpoint
+    ArrowWriter second;
+    columns.bind(second);
+    if (!second.open(directory + "/resumed.arrow", offset)) return 1;
+    if (second.rows() != CHECKPOINT) {
+        std::cerr << "Resumed file holds " << second.rows() << " rows instead of "
+                  << CHECKPOINT << std::endl;
+        return 1;
+    }
+    if (!fill(second, columns, CHECKPOINT, ROWS) || !second.close()) return 1;
+
+    std::cout << "Wrote " << ROWS << " rows to full.arrow and resumed.arrow"
+              << std::endl;
+    return 0;
+}
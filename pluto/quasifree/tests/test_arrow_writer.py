@@ -0,0 +1,52 @@
+#!/usr/bin/env python3
+"""Write-then-read test of ArrowWriter.
+
+Usage: test_arrow_writer.py <test_arrow_writer executable>
+
+Runs the writer in a temporary directory and reads full.arrow and
+resumed.arrow back with pyarrow as Arrow IPC files, checking the schema,
+the row count and every value. Exits with 0 if all checks pass and with 77
+(skipped) if pyarrow is not installed.
+"""
+
+import subprocess
+import sys
+import tempfile
+
+try:
+    import pyarrow as pa
+except ImportError:
+    print("SKIP: pyarrow is not installed")
+    sys.exit(77)
+
+ROWS = 150000
+
+
+def check(path):
+    reader = pa.ipc.open_file(pa.memory_map(path))
+    table = reader.read_all()
+    assert table.schema.names == ["c", "a"], table.schema
+    assert all(field.type == pa.float64() and not field.nullable
+               for field in table.schema), table.schema
+    assert table.num_rows == ROWS, table.num_rows
+    assert reader.num_record_batches >= 3, reader.num_record_batches
+    assert table.column("a").to_pylist() == [float(i) for i in range(ROWS)]
+    assert table.column("c").to_pylist() == [-i / 3.0 for i in range(ROWS)]
+
+
+def main():
+    failures = 0
+    with tempfile.TemporaryDirectory() as directory:
+        subprocess.check_call([sys.argv[1], directory])
+        for name in ("full.arrow", "resumed.arrow"):
+            try:
+                check(directory + "/" + name)
+                print("PASS: " + name)
+            except (AssertionError, pa.ArrowInvalid) as error:
+                print("FAIL: {} {}".format(name, error))
+                failures += 1
+    return 1 if failures else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,115 @@
+/**
+ * @file test_spsc_ring.cpp
+ * @author AK <alex.nuclearboy@gmail.com>
+ * @brief Tests of SpscRing, alone and between a producer and a consumer
+ *        thread.
+ *
+ * The producer fills every slot with a sequence number and a block of
+ * values derived from it; the consumer checks that it receives every
+ * number once, in order, with the values the producer wrote. A small ring
+ * keeps both threads running into a full and an empty ring all the time.
+ * Exits with 0 if all checks pass.
+ *
+ * @date 2026-10-18
+ *
+ * @note Distributed under the GNU General Public License version 3.0 (GPLv3).
+ */
+
+#include "spsc_ring.h"
+#include <iostream>
+#include <pthread.h>
+#include <sched.h>
+#include <string>
+#include "test_check.h"
+
+namespace {
+
+const long kItems = 2000000;
+const int kValues = 15;
+
+struct Slot {
+    long sequence;
+    long values[kValues];
+};
+
+struct Shared {
+    SpscRing<Slot>* ring;
+    long full;          ///< Times the producer found the ring full.
+    long received;
+    long errors;
+};
+
+void* produce(void* argument)
+{
+    Shared* shared = static_cast<Shared*>(argument);
+    for (long i = 0; i < kItems; ++i) {
+        Slot* slot;
+        while (!(slot = shared->ring->claim())) {
+            ++shared->full;
+            sched_yield();
+        }
+        slot->sequence = i;
+        for (int j = 0; j < kValues; ++j) slot->values[j] = i * kValues + j;
+        shared->ring->publish();
+    }
+    return NULL;
+}
+
+void* consume(void* argument)
+{
+    Shared* shared = static_cast<Shared*>(argument);
+    while (shared->received < kItems) {
+        Slot* slot = shared->ring->front();
+        if (!slot) {
+            sched_yield();
+            continue;
+        }
+        bool valid = slot->sequence == shared->received;
+        for (int j = 0; j < kValues; ++j) {
+            valid = valid && slot->values[j] == slot->sequence * kValues + j;
+        }
+        if (!valid) ++shared->errors;
+        // Overwrite the slot, which the producer must not see before release
+        slot->sequence = -1;
+        shared->ring->release();
+        ++shared->received;
+    }
+    return NULL;
+}
+
+} // namespace
+
+int main()
+{
+    // One thread: capacity, full and empty ring, wrap-around
+    SpscRing<int> small(3);
+    check(small.capacity() == 3 && small.size() == 0 && !small.front(), "empty ring");
+    for (int i = 0; i < 3; ++i) {
+        *small.claim() = i;
+        small.publish();
+    }
+    check(small.size() == 3 && !small.claim(), "full ring");
+    bool ordered = true;
+    for (int round = 0; round < 10; ++round) {
+        ordered = ordered && *small.front() == round;
+        small.release();
+        *small.claim() = round + 3;
+        small.publish();
+    }
+    check(ordered && small.size() == 3, "order over wrap-around");
+
+    // Two threads
+    SpscRing<Slot> ring(4);
+    Shared shared = { &ring, 0, 0, 0 };
+    pthread_t producer, consumer;
+    pthread_create(&consumer, NULL, consume, &shared);
+    pthread_create(&producer, NULL, produce, &shared);
+    pthread_join(producer, NULL);
+    pthread_join(consumer, NULL);
+    check(shared.received == kItems && shared.errors == 0 && ring.size() == 0,
+          "producer and consumer thread");
+    std::cout << "Producer found the ring full " << shared.full << " times"
+              << std::endl;
+
+    return testResult();
+}
@@ -0,0 +1,87 @@
+/**
+ * @file ems_file.h
+ * @author AK <alex.nuclearboy@gmail.com>
+ * @brief Checks and counts the events of an EPIO output file (.ems) of WMC.
+ *
+ * WMC writes its events with EPIO (card EPIO of run/wmc.dat.m4, unit 42)
+ * in physical records ("blocks") of a fixed number of 16-bit words, 10240
+ * with the STATUS words of the setup. The file of a killed WMC job ends
+ * with an incomplete block, and the last events before the kill may still
+ * have been buffered. EmsFile reads the blocks as follows:
+ *
+ * - every block starts with a header of 8 <= H <= 64 words: word 0 is the length
+ *   of the block, word 1 is H, word 6 is the position (in words from the
+ *   start of the block) of the first logical record starting in the block,
+ *   or 0 if none does;
+ * - the logical records follow each other in the words after the headers
+ *   and may continue in the next block; word 0 of a logical record is its
+ *   length in words including its header, word 1 the length of its header;
+ *   a length of 0 fills the rest of a block;
+ * - every logical record holds one event (the hit record of WMC).
+ *
+ * The byte order of the words is taken from the first block. Every block
+ * must agree with this layout: the same length and header length, and a
+ * first record where the chain of the records of the earlier blocks puts
+ * it. A file failing any check is not counted. The events are the logical
+ * records ending within the complete blocks; trim() cuts the file after
+ * the last complete block.
+ *
+ * @date 2026-10-18
+ *
+ * @note Distributed under the GNU General Public License version 3.0 (GPLv3).
+ */
+
+#ifndef EMS_FILE_H
+#define EMS_FILE_H
+
+#include <string>
+#include <sys/types.h>
+#include <vector>
+
+/**
+ * @class EmsFile
+ * @brief Block and record structure of an EPIO file.
+ */
+class EmsFile {
+public:
+    EmsFile();
+
+    /**
+     * Reads the blocks of a file and counts its complete events.
+     *
+     * @return false if the file cannot be read or does not have the layout
+     *         described above; the reason is printed.
+     */
+    bool scan(const std::string& path);
+
+    /**
+     * Cuts the scanned file to its complete blocks.
+     *
+     * @return false if the file cannot be truncated.
+     */
+    bool trim(const std::string& path) const;
+
+    /// Events (logical records) ending within the complete blocks.
+    long events() const { return events_; }
+
+    /// Bytes of the complete blocks.
+    off_t completeBytes() const { return complete_bytes_; }
+
+    /// Length of the blocks in 16-bit words (0 - no complete block).
+    long blockWords() const { return block_words_; }
+
+private:
+    unsigned int word(const std::vector<unsigned char>& block, long i) const;
+    bool checkBlock(const std::vector<unsigned char>& block, long index);
+    bool fail(long index, const std::string& reason) const;
+
+    std::string path_;
+    bool big_endian_;
+    long block_words_;
+    long header_words_;
+    long pending_;          ///< Words of the current record in later blocks.
+    long events_;
+    off_t complete_bytes_;
+};
+
+#endif // EMS_FILE_H
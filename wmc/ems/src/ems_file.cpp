@@ -0,0 +1,144 @@
+/**
+ * @file ems_file.cpp
+ * @author AK <alex.nuclearboy@gmail.com>
+ * @brief Implementation of the EmsFile class.
+ *
+ * @date 2026-10-18
+ *
+ * @note Distributed under the GNU General Public License version 3.0 (GPLv3).
+ */
+
+#include "ems_file.h"
+#include <cstdio>
+#include <iostream>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+/// A block header: its length and header length in 16-bit words
+bool isHeader(unsigned int length, unsigned int header)
+{
+    return header >= 8 && header <= 64 && header < length;
+}
+
+} // namespace
+
+EmsFile::EmsFile()
+    : big_endian_(false), block_words_(0), header_words_(0), pending_(0),
+      events_(0), complete_bytes_(0)
+{}
+
+unsigned int EmsFile::word(const std::vector<unsigned char>& block, long i) const
+{
+    unsigned int first = block[2 * i], second = block[2 * i + 1];
+    return big_endian_ ? (first << 8 | second) : (second << 8 | first);
+}
+
+bool EmsFile::fail(long index, const std::string& reason) const
+{
+    std::cerr << path_ << ": block " << index << " " << reason
+              << ", not an EPIO file of the expected layout." << std::endl;
+    return false;
+}
+
+bool EmsFile::scan(const std::string& path)
+{
+    path_ = path;
+    block_words_ = header_words_ = pending_ = events_ = 0;
+    complete_bytes_ = 0;
+
+    struct stat info;
+    FILE* file = std::fopen(path.c_str(), "rb");
+    if (!file || fstat(fileno(file), &info) != 0) {
+        std::cerr << "Failed to open " << path << std::endl;
+        if (file) std::fclose(file);
+        return false;
+    }
+
+    // The byte order is the one giving a valid header of the first block
+    std::vector<unsigned char> block(4);
+    if (std::fread(&block[0], 1, 4, file) != 4) {
+        std::fclose(file);
+        return true;    // No block written yet
+    }
+    bool little = isHeader(block[1] << 8 | block[0], block[3] << 8 | block[2]);
+    bool big = isHeader(block[0] << 8 | block[1], block[2] << 8 | block[3]);
+    if (little == big) {
+        std::fclose(file);
+        return fail(0, little ? "has a header in both byte orders"
+                              : "has no valid header");
+    }
+    big_endian_ = big;
+    block_words_ = word(block, 0);
+    header_words_ = word(block, 1);
+
+    std::rewind(file);
+    block.resize(2 * block_words_);
+    bool valid = true;
+    for (long index = 0; valid && complete_bytes_ + static_cast<off_t>(block.size())
+             <= info.st_size; ++index) {
+        if (std::fread(&block[0], 1, block.size(), file) != block.size()) {
+            std::cerr << "Failed to read " << path << std::endl;
+            valid = false;
+        } else if ((valid = checkBlock(block, index))) {
+            complete_bytes_ += block.size();
+        }
+    }
+    std::fclose(file);
+    if (complete_bytes_ == 0) block_words_ = 0;
+    return valid;
+}
+
+bool EmsFile::checkBlock(const std::vector<unsigned char>& block, long index)
+{
+    if (static_cast<long>(word(block, 0)) != block_words_ ||
+        static_cast<long>(word(block, 1)) != header_words_) {
+        return fail(index, "differs in length or header length from the first");
+    }
+    long first = word(block, 6);
+    long position = header_words_;
+
+    // Rest of a record started in an earlier block
+    if (pending_ > 0) {
+        long words = pending_ < block_words_ - position ? pending_
+                                                        : block_words_ - position;
+        position += words;
+        pending_ -= words;
+        if (pending_ == 0) ++events_;
+    }
+
+    bool found = false;
+    while (position < block_words_) {
+        long length = word(block, position);
+        if (length == 0) break;     // Filler up to the end of the block
+        if (!found && position != first) {
+            return fail(index, "points to its first record at the wrong word");
+        }
+        found = true;
+        long header = position + 1 < block_words_ ? word(block, position + 1) : 2;
+        if (length < 2 || header < 2 || header > length) {
+            return fail(index, "holds a record with an invalid length");
+        }
+        if (position + length <= block_words_) {
+            ++events_;
+            position += length;
+        } else {
+            pending_ = length - (block_words_ - position);
+            position = block_words_;
+        }
+    }
+    if (!found && first != 0) {
+        return fail(index, "points to a record that does not start there");
+    }
+    return true;
+}
+
+bool EmsFile::trim(const std::string& path) const
+{
+    if (truncate(path.c_str(), complete_bytes_) != 0) {
+        std::cerr << "Failed to truncate " << path << std::endl;
+        return false;
+    }
+    return true;
+}
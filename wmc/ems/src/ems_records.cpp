@@ -0,0 +1,36 @@
+/**
+ * @file ems_records.cpp
+ * @author AK <alex.nuclearboy@gmail.com>
+ * @brief Prints the number of complete events of a WMC output file.
+ *
+ * Usage: ems_records [--trim] <ems file>
+ *
+ * The file is checked block by block (see ems_file.h) and the number of
+ * events in its complete blocks is printed. --trim cuts the file after the
+ * last complete block. Exits with 1 if the file cannot be read or checked;
+ * the WMC scripts then drop the output of an interrupted job rather than
+ * keep it as a segment.
+ *
+ * @date 2026-10-18
+ *
+ * @note Distributed under the GNU General Public License version 3.0 (GPLv3).
+ */
+
+#include "ems_file.h"
+#include <iostream>
+#include <string>
+
+int main(int argc, char** argv)
+{
+    bool trim = argc == 3 && std::string(argv[1]) == "--trim";
+    if (argc != 2 + (trim ? 1 : 0) || argv[argc - 1][0] == '-') {
+        std::cerr << "Usage: " << argv[0] << " [--trim] <ems file>" << std::endl;
+        return 1;
+    }
+
+    EmsFile file;
+    if (!file.scan(argv[argc - 1])) return 1;
+    if (trim && !file.trim(argv[argc - 1])) return 1;
+    std::cout << file.events() << std::endl;
+    return 0;
+}
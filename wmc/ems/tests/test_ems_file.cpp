@@ -0,0 +1,141 @@
+/**
+ * @file test_ems_file.cpp
+ * @author AK <alex.nuclearboy@gmail.com>
+ * @brief Tests of EmsFile on EPIO files written by the test itself.
+ *
+ * The files have the layout described in ems_file.h: events of various
+ * lengths, some of them continued in the next block, in both byte orders.
+ * The test checks the counts of complete and interrupted files, trimming,
+ * and that inconsistent files are rejected. Exits with 0 if all checks
+ * pass.
+ *
+ * @date 2026-10-18
+ *
+ * @note Distributed under the GNU General Public License version 3.0 (GPLv3).
+ */
+
+#include "ems_file.h"
+#include <algorithm>
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+#include "test_check.h"
+
+namespace {
+
+const long kBlockWords = 64;
+const long kHeaderWords = 12;
+
+/**
+ * @brief Writes events of the given lengths (in words) in blocks of
+ *        kBlockWords words, as EPIO does.
+ */
+std::vector<unsigned int> writeBlocks(const std::vector<long>& lengths)
+{
+    std::vector<unsigned int> words;
+    long pending = 0;       // Words of the current event still to write
+    size_t next = 0;
+    while (next < lengths.size() || pending > 0) {
+        size_t start = words.size();
+        words.resize(start + kBlockWords, 0);
+        words[start] = kBlockWords;
+        words[start + 1] = kHeaderWords;
+        long position = kHeaderWords;
+        long take = pending < kBlockWords - position ? pending : kBlockWords - position;
+        position += take;
+        pending -= take;
+        // Events start only if their header fits into the block
+        while (pending == 0 && next < lengths.size() && position + 2 <= kBlockWords) {
+            if (words[start + 6] == 0) words[start + 6] = position;
+            long length = lengths[next++];
+            words[start + position] = length;
+            words[start + position + 1] = 4;
+            long in_block = length < kBlockWords - position ? length : kBlockWords - position;
+            position += in_block;
+            pending = length - in_block;
+        }
+    }
+    return words;
+}
+
+std::string writeFile(const std::vector<unsigned int>& words, bool big_endian,
+                      size_t bytes)
+{
+    std::string path = "test_ems_file.ems";
+    FILE* file = std::fopen(path.c_str(), "wb");
+    for (size_t i = 0; i < words.size() && 2 * i < bytes; ++i) {
+        unsigned char pair[2] = { static_cast<unsigned char>(words[i] & 0xff),
+                                  static_cast<unsigned char>(words[i] >> 8) };
+        if (big_endian) std::swap(pair[0], pair[1]);
+        std::fwrite(pair, 1, 2 * i + 1 < bytes ? 2 : 1, file);
+    }
+    std::fclose(file);
+    return path;
+}
+
+off_t fileSize(const std::string& path)
+{
+    struct stat info;
+    return stat(path.c_str(), &info) == 0 ? info.st_size : -1;
+}
+
+} // namespace
+
+int main()
+{
+    // 20 events of 10 to 48 words, several of them continued
+    std::vector<long> lengths;
+    for (long i = 0; i < 20; ++i) lengths.push_back(10 + (i * 7) % 39);
+    std::vector<unsigned int> words = writeBlocks(lengths);
+    size_t blocks = words.size() / kBlockWords;
+
+    for (int order = 0; order < 2; ++order) {
+        std::string name = order ? " (big endian)" : " (little endian)";
+        EmsFile file;
+        std::string path = writeFile(words, order == 1, 2 * words.size());
+        check(file.scan(path) && file.events() == 20 &&
+              file.blockWords() == kBlockWords, "complete file" + name);
+    }
+
+    // Interrupted in the last block: the events ending before it remain
+    std::vector<unsigned int> head(words.begin(), words.end() - kBlockWords);
+    long complete = 0;
+    {
+        EmsFile file;
+        file.scan(writeFile(head, false, 2 * head.size()));
+        complete = file.events();
+    }
+    EmsFile file;
+    std::string path = writeFile(words, false, 2 * words.size() - 37);
+    check(file.scan(path) && file.events() == complete && complete > 0 &&
+          complete < 20, "interrupted file");
+    check(file.completeBytes() == static_cast<off_t>(2 * (blocks - 1) * kBlockWords) &&
+          file.trim(path) && fileSize(path) == file.completeBytes(), "trimmed");
+    check(file.scan(path) && file.events() == complete, "trimmed file rescanned");
+
+    // Shorter than a block: nothing to keep
+    check(file.scan(writeFile(words, false, 100)) && file.events() == 0 &&
+          file.completeBytes() == 0, "no complete block");
+
+    // Inconsistent files are rejected
+    std::vector<unsigned int> broken = words;
+    broken[kBlockWords + 6] += 1;
+    check(!file.scan(writeFile(broken, false, 2 * broken.size())),
+          "wrong first record");
+    broken = words;
+    broken[2 * kBlockWords] = kBlockWords / 2;
+    check(!file.scan(writeFile(broken, false, 2 * broken.size())),
+          "wrong block length");
+    broken = words;
+    broken[kHeaderWords] = 1;
+    check(!file.scan(writeFile(broken, false, 2 * broken.size())),
+          "wrong record length");
+    std::vector<unsigned int> text(kBlockWords, 0x2020);
+    check(!file.scan(writeFile(text, false, 2 * text.size())), "not EPIO");
+
+    unlink("test_ems_file.ems");
+    return testResult();
+}
@@ -1,3 +1,10 @@
+m4_dnl Event range of the job, set by wmc.sh with -D on the m4 command line:
+m4_dnl WMC_EVENTS - number of events to process (TRIG card)
+m4_dnl WMC_KINE_START - RE1 of the KINE 50 card, RE1*1000 = first event
+m4_dnl WMC_KINE_MODE - 50 reads pluto.root, 10 reads the ASCII events in fort.31
+m4_ifdef(`WMC_EVENTS',,`m4_define(`WMC_EVENTS',`3000000')')m4_dnl
+m4_ifdef(`WMC_KINE_START',,`m4_define(`WMC_KINE_START',`0.')')m4_dnl
+m4_ifdef(`WMC_KINE_MODE',,`m4_define(`WMC_KINE_MODE',`50')')m4_dnl
  LIST
 C
 C GEANT MC example job 
@@ -14,7 +21,7 @@ LIST
 WPLT  0  3 'WASA' 0 0.040 2  0. 0. 0. 0. 0. 0.
 C WPLT = 1 plot setup (interactive) ; = 0 batch 
 NOLI
-TRIG 3000000  NB OF EVENTS TO PROCESS $$$
+TRIG WMC_EVENTS  NB OF EVENTS TO PROCESS $$$
 C RUNG 78 37    RUN AND EVENT NB
 TIME 10. 10. 0  AFTER INIT / FOR TERM / TIME CHECK INTERVAL IN EVENTS 
 DEBU 0 0 500  FIRST,LAST EVENT FOR USER DEBUG AND GTRIGI PRINT FREQUENCY
@@ -58,8 +65,9 @@ C KINE 10 TRACK GENERATION MODE $$$
 C 1.   3.    0.   0.   0.   0.   0.  0.   1.  1.
 
 C For KINE 50 RE1*1000 gives the event number to start with
-KINE 50 TRACK GENERATION MODE $$$
-  0.   3.    0.   0.   0.   0.   0.  0.   1.  1.
+C KINE 10 is selected by wmc.sh when the events are streamed (WMC_KINE_INPUT)
+KINE WMC_KINE_MODE TRACK GENERATION MODE $$$
+  WMC_KINE_START   3.    0.   0.   0.   0.   0.  0.   1.  1.
 
 C For KINE 1 option line has the following meaning
 C THETA(DEG),  PHI(DEG) ,  EKIN(GEV) , NB.  , PART. , NB. , REACTION
@@ -4,6 +4,12 @@
 # $Id: wmc.sh 277 2008-10-30 10:31:03Z hejny $
 # Modified: 2015-04 by rundel
 # Modified: 2024-02-01 by khreptak
+# Usage: wmc.sh <pluto file> <ems file> [<first event> <number of events>]
+# If WMC_KINE_INPUT is set, the events are read in KINE 10 mode from that
+# ASCII file or named pipe (GINFile format) instead of the PLUTO file.
+# If WMC_TEMPLATE is set, the directory was prepared from a run template
+# (see wmc_prepare_template in wmc_common.sh): the alignment links and the
+# expanded cards wmc.dat/fort.4 are already in place.
 #******************************************************************************
 
 # Display start time and host information
@@ -63,7 +69,16 @@ echo "System configuration completed."
 
 # Preparing simulation environment
 echo "Preparing simulation environment..."
-rm -f fort.* >& /dev/null
+set use_template = 0
+if ( $?WMC_TEMPLATE ) then
+    if ( "$WMC_TEMPLATE" != "" ) set use_template = 1
+endif
+if ( $use_template ) then
+    echo "Using run template: $WMC_TEMPLATE"
+    rm -f fort.31 >& /dev/null
+else
+    rm -f fort.* >& /dev/null
+endif
 rm -f epio41 epio42 pluto.root >& /dev/null
 rm -f etap.ems >& /dev/null
 
@@ -72,17 +87,40 @@ ln -s  $1 pluto.root
 ln -s  $2 etap.ems
 
 # Configure kinematic event input text file and alignment files
-ln -s  $WASA_ROOT/examples/evg/etap.out     fort.31
+if ( $?WMC_KINE_INPUT ) then
+    echo "Reading events from: $WMC_KINE_INPUT"
+    ln -s  $WMC_KINE_INPUT     fort.31
+else
+    ln -s  $WASA_ROOT/examples/evg/etap.out     fort.31
+endif
 ln -s  etap.epo     epio41
 ln -s  etap.ems     epio42
 
-# Linking alignment files
-$WASA_ROOT/alig/links.sh
-ln -s $WASA_ROOT/alig/al4cosy0_mc_009.dat042    fort.13
-
-# Process user cards
-m4 -I$WASA_ROOT/alig/m4 -P wmc.dat.m4 > wmc.dat
-ln -s wmc.dat   fort.4
+if ( ! $use_template ) then
+    # Linking alignment files
+    $WASA_ROOT/alig/links.sh
+    ln -s $WASA_ROOT/alig/al4cosy0_mc_009.dat042    fort.13
+
+    # Process user cards, restricted to an event range if one is given.
+    # KINE 50 starts at event RE1*1000; RE1 is offset by a quarter of an event
+    # so that truncation and rounding of RE1*1000 both give the first event.
+    # RE1 is a REAL, which is precise enough for first events below 4096000.
+    set m4_defs = ""
+    if ( $#argv >= 4 ) then
+        if ( $3 >= 4096000 ) then
+            echo "ERROR: KINE 50 cannot start at event $3 (4096000 or more). Exiting."
+            exit 1
+        endif
+        set kine_start = `awk -v n=$3 'BEGIN { printf "%.5f", (n + 0.25) / 1000 }'`
+        set m4_defs = "-DWMC_KINE_START=$kine_start -DWMC_EVENTS=$4"
+        echo "Processing $4 events starting from event $3"
+    endif
+    if ( $?WMC_KINE_INPUT ) then
+        set m4_defs = "$m4_defs -DWMC_KINE_MODE=10 -DWMC_KINE_START=1."
+    endif
+    m4 -I$WASA_ROOT/alig/m4 -P $m4_defs wmc.dat.m4 > wmc.dat
+    ln -s wmc.dat   fort.4
+endif
 
 echo "Simulation environment prepared. Starting main program..."
 $NICE $TIME $WASA_ROOT/examples/wmc3/src/wmc.exe
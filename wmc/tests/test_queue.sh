@@ -0,0 +1,89 @@
+#!/bin/bash
+#******************************************************************************
+# Test of the work queue (wmc_queue.sh) with several local workers
+# Usage: ./tests/test_queue.sh
+# WMC itself is replaced by a stub wmc_execute which writes the task name to
+# the .ems file. The test checks that every task is processed exactly once
+# (failing tasks are retried), that tasks of dead workers are requeued, and
+# that a worker leaves a task alone which was handed to another worker while
+# it ran. Exits with 0 if all checks pass.
+#******************************************************************************
+
+set -e
+
+test_dir=$(mktemp -d "${TMPDIR:-/tmp}/wmc_queue_test.XXXXXX")
+trap '[ -n "${KEEP}" ] || rm -rf "${test_dir}"' EXIT
+
+# Copies of the scripts, with the stub appended to the shared functions
+cp "$(dirname "$0")"/../wmc_queue.sh "$(dirname "$0")"/../wmc_common.sh "${test_dir}"
+cat >> "${test_dir}/wmc_common.sh" <<'EOF'
+
+# Stub of WMC: task "fail" fails on its first attempt, task "handover" is
+# handed to another worker on its first attempt
+wmc_execute() {
+    echo "$1 ${WMC_OWNER}" >> "${WMC_DATA}/executed"
+    sleep 0.2
+    if [ ! -e "${WMC_DATA}/$1.tried" ]; then
+        touch "${WMC_DATA}/$1.tried"
+        case "$1" in
+            fail) return 1 ;;
+            handover)
+                echo "otherhost 1" > "${WMC_OWNER_FILE}"
+                touch -d '1 hour ago' "${WMC_OWNER_FILE}"
+                return 1 ;;
+        esac
+    fi
+    echo "$1" > "$3"
+}
+EOF
+
+export PLUTO_OUTPUT="${test_dir}/pluto" WMC_DATA="${test_dir}/data"
+export WMC_HEARTBEAT=1 WMC_HEARTBEAT_TIMEOUT=2
+mkdir -p "${PLUTO_OUTPUT}" "${WMC_DATA}"
+cd "${test_dir}"
+
+failures=0
+check() {
+    if eval "$2"; then
+        echo "PASS: $1"
+    else
+        echo "FAIL: $1"
+        failures=$((failures + 1))
+    fi
+}
+
+for i in $(seq 1 12); do
+    touch "${PLUTO_OUTPUT}/test-${i}.root"
+done
+./wmc_queue.sh init test > /dev/null
+
+# Tasks of the failing and the handed-over job, and one of a dead worker
+queue="${WMC_DATA}/queue"
+for task in fail handover; do
+    echo "${PLUTO_OUTPUT}/test-1.root ${WMC_DATA}/${task}.ems - - 0" > "${queue}/pending/${task}"
+done
+echo "${PLUTO_OUTPUT}/test-1.root ${WMC_DATA}/dead.ems - - 0" > "${queue}/running/dead"
+echo "otherhost 2" > "${queue}/running/dead.owner"
+touch -d '1 hour ago' "${queue}/running/dead.owner"
+
+timeout 120 ./wmc_queue.sh worker -j 4 > worker.log 2>&1 || true
+
+tasks="$(echo test-{1..12}) fail handover dead"
+check "all tasks done" \
+    '[ "$(ls "${queue}/done" | wc -l)" -eq 15 ] && [ -z "$(find "${queue}"/{pending,running,failed} -type f)" ]'
+check "every output written" \
+    '( for task in ${tasks}; do [ "$(cat "${WMC_DATA}/${task}.ems")" = "${task}" ] || exit 1; done )'
+check "tasks run once" \
+    '[ "$(cut -d " " -f 1 "${WMC_DATA}/executed" | grep -c "^test-")" -eq 12 ] && [ -z "$(cut -d " " -f 1 "${WMC_DATA}/executed" | sort | uniq -d | grep -v "^fail$\|^handover$")" ]'
+check "failed task retried" \
+    '[ "$(grep -c "^fail " "${WMC_DATA}/executed")" -eq 2 ] && [ "$(cut -d " " -f 5 "${queue}/done/fail")" -eq 2 ]'
+check "handed-over task left alone" \
+    'grep -q "handover was requeued while running" worker.log && [ "$(grep -c "^handover " "${WMC_DATA}/executed")" -eq 2 ]'
+check "dead worker requeued" 'grep -q "Requeued dead" worker.log'
+check "several workers" \
+    '[ "$(cut -d " " -f 2- "${WMC_DATA}/executed" | sort -u | wc -l)" -gt 1 ]'
+
+if [ "${failures}" -ne 0 ]; then
+    cat worker.log
+    exit 1
+fi
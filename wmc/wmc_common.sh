@@ -0,0 +1,696 @@
+#!/bin/bash
+#******************************************************************************
+# Helper functions shared by the WASA Monte Carlo job scripts
+# Source this file from bash: source "$(dirname "$0")/wmc_common.sh"
+#******************************************************************************
+
+# Directory of the WMC scripts with the run/ template
+WMC_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+
+# Directories for the job locks and the per-job status files
+WMC_LOCK_DIR="${WMC_LOCK_DIR:-locks}"
+WMC_STATUS_DIR="${WMC_STATUS_DIR:-status}"
+
+# Cache of prepared run directories, see wmc_prepare_template
+WMC_TEMPLATE_DIR="${WMC_TEMPLATE_DIR:-templates}"
+
+# With WMC_SCRATCH set to a node-local directory the jobs of this process
+# read their input from and write their output to local copies in
+# WMC_SCRATCH_DIR; the outputs are copied back in the background
+if [ -n "${WMC_SCRATCH}" ]; then
+    WMC_SCRATCH_DIR="${WMC_SCRATCH}/wmc-$(hostname)-$$"
+fi
+WMC_COPY_PIDS=()
+
+# Run database with one CSV line of resource metrics per job
+WMC_METRICS_DB="${WMC_METRICS_DB:-${WMC_DATA:-.}/metrics.csv}"
+WMC_METRICS_HEADER="time,host,kind,job,reaction,geometry,exit_code,wall_s,user_s,sys_s,max_rss_kb,input_bytes,output_bytes,events,events_per_s"
+WMC_TIME="${WMC_TIME:-/usr/bin/time}"
+
+# Interval [s] at which running jobs record the last completed event
+WMC_PROGRESS_INTERVAL="${WMC_PROGRESS_INTERVAL:-60}"
+
+# First events KINE 50 can start at: WMC reads RE1 = (n + 0.25) / 1000 as a
+# single precision REAL. While RE1 < 4096, RE1*1000 truncated or rounded
+# gives n for every n, in single as well as in double precision.
+WMC_KINE_START_MAX=4096000
+
+# Counter of the complete events of an interrupted WMC output (ems/)
+WMC_EMS_RECORDS="${WMC_EMS_RECORDS:-${WMC_DIR}/ems/ems_records}"
+
+# Converter of archived event files (archive/) to the PLUTO tree of KINE 50
+WMC_RESTORE="${WMC_RESTORE:-${WMC_DIR}/../archive/restore_events}"
+
+# Interval [s] at which running jobs touch their lock (and queue task), and
+# the age [s] after which a lock of another host without heartbeat is stale
+WMC_HEARTBEAT="${WMC_HEARTBEAT:-60}"
+WMC_HEARTBEAT_TIMEOUT="${WMC_HEARTBEAT_TIMEOUT:-600}"
+
+# Check whether a lock directory is stale: its owner is a process of this
+# host which no longer runs, or the lock of another host (or one without
+# owner) has not been touched for $WMC_HEARTBEAT_TIMEOUT seconds
+# Usage: wmc_lock_stale <lock directory>
+wmc_lock_stale() {
+    local owner_host owner_pid beat
+    read -r owner_host owner_pid 2>/dev/null < "$1/owner" || true
+    if [ "${owner_host}" = "$(hostname)" ] && [ -n "${owner_pid}" ]; then
+        ! kill -0 "${owner_pid}" 2>/dev/null
+        return
+    fi
+    beat=$(stat -c %Y "$1/owner" 2>/dev/null || stat -c %Y "$1" 2>/dev/null) \
+        || return 1
+    [ $(( $(date +%s) - beat )) -gt "${WMC_HEARTBEAT_TIMEOUT}" ]
+}
+
+# Acquire the lock of a job. The lock is a directory holding the host name
+# and PID of its owner; it is prepared under a private name and renamed into
+# place, which fails atomically while another lock exists. A stale lock (see
+# wmc_lock_stale) is renamed away and removed by the one process holding
+# <lock>.break, which checks the lock again before it breaks it.
+# Usage: wmc_lock_acquire <job> [pid]
+wmc_lock_acquire() {
+    local lock="${WMC_LOCK_DIR}/$1.lock"
+    local new="${lock}.new.$(hostname).${BASHPID}"
+    local stale="${lock}.stale.$(hostname).${BASHPID}"
+    mkdir -p "${WMC_LOCK_DIR}"
+
+    rm -rf "${new}"
+    mkdir "${new}" && echo "$(hostname) ${2:-$$}" > "${new}/owner" || return 1
+    while ! mv -T "${new}" "${lock}" 2>/dev/null; do
+        if ! wmc_lock_stale "${lock}"; then
+            rm -rf "${new}"
+            return 1
+        fi
+        if ! mkdir "${lock}.break" 2>/dev/null; then
+            # Another process is breaking the lock; a crashed one leaves
+            # the directory, which is removed once it is as old as a lock
+            wmc_lock_stale "${lock}.break" && rmdir "${lock}.break" 2>/dev/null
+            rm -rf "${new}"
+            return 1
+        fi
+        if wmc_lock_stale "${lock}" && mv -T "${lock}" "${stale}" 2>/dev/null; then
+            echo "INFO: Removing stale lock of $1."
+            rm -rf "${stale}"
+        fi
+        rmdir "${lock}.break"
+    done
+}
+
+# Pass the lock of a job on to another process (e.g. a background job)
+# Usage: wmc_lock_update <job> <pid>
+wmc_lock_update() {
+    local lock="${WMC_LOCK_DIR}/$1.lock"
+    echo "$(hostname) $2" > "${lock}/owner.tmp" && mv -f "${lock}/owner.tmp" "${lock}/owner"
+}
+
+# Touch the lock of a job every $WMC_HEARTBEAT seconds while the calling
+# process runs, so that other hosts do not consider it stale
+# Usage: wmc_lock_heartbeat <job>
+wmc_lock_heartbeat() {
+    local owner="${WMC_LOCK_DIR}/$1.lock/owner" parent="${BASHPID}"
+    ( while sleep "${WMC_HEARTBEAT}" && kill -0 "${parent}" 2>/dev/null; do
+          touch -c "${owner}" 2>/dev/null
+      done ) > /dev/null 2>&1 &
+}
+
+# The lock is renamed away before it is removed, so that a lock acquired
+# meanwhile is not deleted with it
+# Usage: wmc_lock_release <job>
+wmc_lock_release() {
+    local lock="${WMC_LOCK_DIR}/$1.lock"
+    local released="${lock}.released.$(hostname).${BASHPID}"
+    if mv -T "${lock}" "${released}" 2>/dev/null; then
+        rm -rf "${released}"
+    fi
+}
+
+# Record the state of a job: <state> <exit code> <start> <end> <host>
+# Usage: wmc_set_status <job> <state> [exit code] [start time]
+wmc_set_status() {
+    mkdir -p "${WMC_STATUS_DIR}"
+    echo "$2 ${3:--} ${4:-$(date +%s)} $(date +%s) $(hostname)" \
+        > "${WMC_STATUS_DIR}/$1.status"
+}
+
+# Print the state of the given jobs as a table
+# Usage: wmc_print_status <job>...
+wmc_print_status() {
+    local job state code start end host
+    printf "%-40s %-10s %6s %10s\n" "JOB" "STATE" "EXIT" "TIME [s]"
+    for job in "$@"; do
+        if [ -f "${WMC_STATUS_DIR}/${job}.status" ]; then
+            read -r state code start end host < "${WMC_STATUS_DIR}/${job}.status"
+            printf "%-40s %-10s %6s %10s\n" "${job}" "${state}" "${code}" \
+                "$((end - start))"
+        else
+            printf "%-40s %-10s %6s %10s\n" "${job}" "-" "-" "-"
+        fi
+    done
+}
+
+# Number of processor cores of this host
+wmc_num_cores() {
+    nproc 2>/dev/null || getconf _NPROCESSORS_ONLN 2>/dev/null || echo 1
+}
+
+# m4 definitions of the cards for an event range and the input mode; must
+# match those set by run/wmc.sh when it expands the cards itself
+# Usage: wmc_card_defines [<first event> <events>]
+wmc_card_defines() {
+    local defines=""
+    if [ -n "$2" ]; then
+        defines="-DWMC_KINE_START=$(awk -v n="$1" \
+            'BEGIN { printf "%.5f", (n + 0.25) / 1000 }') -DWMC_EVENTS=$2"
+    fi
+    if [ -n "${WMC_KINE_INPUT}" ]; then
+        defines="${defines} -DWMC_KINE_MODE=10 -DWMC_KINE_START=1."
+    fi
+    echo "${defines}"
+}
+
+# Prepare the read-only run template for the current setup and print the
+# expanded cards for the given event range. The template holds the files of
+# run/, the alignment links made by $WASA_ROOT/alig/links.sh and fort.13; it
+# is keyed by a hash of these inputs and built only once. The cards are
+# expanded once per set of m4 definitions into <template>/cards/.
+# Usage: wmc_prepare_template [<first event> <events>]
+wmc_prepare_template() {
+    local alignment="${WASA_ROOT}/alig/al4cosy0_mc_009.dat042"
+    [ -n "${WASA_ROOT}" ] && [ -f "${alignment}" ] || return 1
+
+    local hash template build
+    hash=$( { cat "${WMC_DIR}"/run/* "${WASA_ROOT}/alig/links.sh" \
+              "${alignment}"; echo "${WASA_ROOT}"; } | md5sum | cut -c1-12)
+    mkdir -p "${WMC_TEMPLATE_DIR}"
+    template="$(cd "${WMC_TEMPLATE_DIR}" && pwd)/${hash}"
+
+    if [ ! -d "${template}" ]; then
+        build="${template}.tmp.$(hostname).${BASHPID}"
+        mkdir -p "${build}/cards"
+        cp "${WMC_DIR}"/run/* "${build}"
+        (cd "${build}" && "${WASA_ROOT}/alig/links.sh" \
+            && ln -s "${alignment}" fort.13) > /dev/null || {
+            rm -rf "${build}"
+            return 1
+        }
+        find "${build}" -maxdepth 1 -type f -exec chmod a-w {} +
+        # Another job may have built the same template in the meantime
+        mv -T "${build}" "${template}" 2>/dev/null || rm -rf "${build}"
+    fi
+
+    local defines cards
+    defines=$(wmc_card_defines "$@")
+    cards="${template}/cards/wmc-$(echo "${defines}" | md5sum | cut -c1-12).dat"
+    if [ ! -f "${cards}" ]; then
+        m4 -I"${WASA_ROOT}/alig/m4" -P ${defines} "${template}/wmc.dat.m4" \
+            > "${cards}.tmp.$$" || { rm -f "${cards}.tmp.$$"; return 1; }
+        mv -f "${cards}.tmp.$$" "${cards}"
+    fi
+    echo "${cards}"
+}
+
+# Run a command and write "<wall> <user> <sys> <max RSS kB>" of it and its
+# children to a file; without GNU time only the wall time is measured
+# Usage: wmc_timed <stats file> <command>...
+wmc_timed() {
+    local stats="$1"
+    shift
+    if [ -x "${WMC_TIME}" ]; then
+        "${WMC_TIME}" -f "%e %U %S %M" -o "${stats}" "$@"
+        return
+    fi
+    local start=$(date +%s.%N) code=0
+    "$@" || code=$?
+    awk -v s="${start}" -v e="$(date +%s.%N)" \
+        'BEGIN { printf "%.2f - - -\n", e - s }' > "${stats}"
+    return "${code}"
+}
+
+# Total size in bytes of the given files ("-" and missing files count 0)
+wmc_file_bytes() {
+    local file total=0
+    for file in "$@"; do
+        [ -f "${file}" ] && total=$(( total + $(stat -L -c %s "${file}") ))
+    done
+    echo "${total}"
+}
+
+# Append one line to the run database
+# Usage: wmc_metrics_record <kind> <job> <reaction> <exit code> <stats file>
+#                           <input bytes> <output bytes> <events>
+wmc_metrics_record() {
+    local wall user sys rss rate
+    read -r wall user sys rss < <(tail -n 1 "$5" 2>/dev/null)
+    rate=$(awk -v n="$8" -v t="${wall}" \
+        'BEGIN { if (n > 0 && t > 0) printf "%.2f", n / t; else print "" }')
+    mkdir -p "$(dirname "${WMC_METRICS_DB}")"
+    (
+        flock 9 2>/dev/null || true
+        [ -s "${WMC_METRICS_DB}" ] || echo "${WMC_METRICS_HEADER}" > "${WMC_METRICS_DB}"
+        echo "$(date +%Y-%m-%dT%H:%M:%S),$(hostname),$1,$2,$3,${WMC_GEOMETRY:-B009},$4,${wall:-},${user/-/},${sys/-/},${rss/-/},$6,$7,$8,${rate}" \
+            >> "${WMC_METRICS_DB}"
+    ) 9>> "${WMC_METRICS_DB}.lock"
+}
+
+# Reaction of a job <reaction>-<n>[.chunk-<k>]
+wmc_job_reaction() {
+    local job="${1%%.chunk-*}"
+    echo "${job%-*}"
+}
+
+# Median events per second of the successful jobs of a kind (wmc, pluto)
+# recorded for a reaction and geometry; empty if nothing was recorded
+# Usage: wmc_median_rate <kind> <reaction> [<geometry>]
+wmc_median_rate() {
+    [ -s "${WMC_METRICS_DB}" ] || return 0
+    awk -F, -v kind="$1" -v reaction="$2" -v geometry="${3:-${WMC_GEOMETRY:-B009}}" \
+        'NR > 1 && $3 == kind && $5 == reaction && $6 == geometry &&
+         $7 == 0 && $15 > 0 { print $15 }' "${WMC_METRICS_DB}" \
+        | sort -g | awk '{ rate[NR] = $1 }
+            END { if (NR == 0) exit
+                  if (NR % 2) print rate[(NR + 1) / 2]
+                  else print (rate[NR / 2] + rate[NR / 2 + 1]) / 2 }'
+}
+
+# Convert a duration like 5400, 90m or 1.5h to seconds
+wmc_seconds() {
+    awk -v t="$1" 'BEGIN { f = 1
+        if (t ~ /h$/) f = 3600; else if (t ~ /m$/) f = 60
+        sub(/[smh]$/, "", t); printf "%d\n", t * f }'
+}
+
+# Number of event-range chunks for a PLUTO file so that each WMC job takes
+# about the target wall time at the measured rate of the reaction
+# Usage: wmc_chunks_for_target <root file> <reaction> <target seconds>
+wmc_chunks_for_target() {
+    local rate total
+    rate=$(wmc_median_rate wmc "$2")
+    total=$(wmc_count_events "$1")
+    [ -n "${rate}" ] && [ -n "${total}" ] || return 1
+    awk -v n="${total}" -v r="${rate}" -v t="$3" 'BEGIN {
+        per_job = int(r * t); if (per_job < 1) per_job = 1
+        print int((n + per_job - 1) / per_job) }'
+}
+
+# Number of chunks to use for a PLUTO file: derived from the target wall
+# time if one is given and the reaction has recorded throughput, otherwise
+# the fixed number of chunks
+# Usage: wmc_file_chunks <root file> <reaction> <chunks> [<target seconds>]
+wmc_file_chunks() {
+    local chunks
+    if [ -n "$4" ] && chunks=$(wmc_chunks_for_target "$1" "$2" "$4"); then
+        echo "${chunks}"
+    else
+        echo "$3"
+    fi
+}
+
+# Copy an input file to the scratch directory unless a copy of the same size
+# and modification time is already there, and print the path of the local
+# copy. Concurrent calls for the same file wait for the first copy; the
+# lock of a caller which died is broken (see wmc_lock_acquire).
+# Usage: wmc_stage_in <file>
+wmc_stage_in() {
+    local source="$1" name
+    name=$(basename "$1")
+    local local_file="${WMC_SCRATCH_DIR}/input/${name}"
+
+    mkdir -p "${WMC_SCRATCH_DIR}/input"
+    while ! WMC_LOCK_DIR="${WMC_SCRATCH_DIR}/input" \
+        wmc_lock_acquire "${name}" "${BASHPID}" >&2; do
+        sleep 1
+    done
+    if [ ! -f "${local_file}" ] || \
+       [ "$(stat -c '%s %Y' "${local_file}")" != "$(stat -c '%s %Y' "${source}")" ]; then
+        if ! cp --preserve=timestamps "${source}" "${local_file}.tmp"; then
+            rm -f "${local_file}.tmp"
+            WMC_LOCK_DIR="${WMC_SCRATCH_DIR}/input" wmc_lock_release "${name}"
+            return 1
+        fi
+        mv -f "${local_file}.tmp" "${local_file}"
+    fi
+    WMC_LOCK_DIR="${WMC_SCRATCH_DIR}/input" wmc_lock_release "${name}"
+    echo "${local_file}"
+}
+
+# Start copying the input of a later job to the scratch directory
+# Usage: wmc_prefetch <file>
+wmc_prefetch() {
+    [ -n "${WMC_SCRATCH_DIR}" ] && [ -f "$1" ] || return 0
+    wmc_stage_in "$1" > /dev/null 2>&1 &
+}
+
+# Copy a finished output back to the shared filesystem. The copy is
+# verified by size and MD5 checksum before it is renamed to its final
+# name; a local file failing the check is kept in $WMC_SCRATCH/failed.
+# Usage: wmc_copy_back <local file> <destination>
+wmc_copy_back() {
+    local local_file="$1" dest="$2"
+    local part="${dest}.part-$(hostname)-${BASHPID}"
+
+    if cp "${local_file}" "${part}" && \
+       [ "$(stat -c %s "${local_file}")" = "$(stat -c %s "${part}")" ] && \
+       [ "$(md5sum < "${local_file}")" = "$(md5sum < "${part}")" ]; then
+        mv -f "${part}" "${dest}"
+        rm -f "${local_file}"
+        echo "Copied ${local_file} to ${dest}."
+        return 0
+    fi
+    rm -f "${part}"
+    mkdir -p "${WMC_SCRATCH}/failed"
+    mv -f "${local_file}" "${WMC_SCRATCH}/failed/"
+    echo "ERROR: Copying ${local_file} to ${dest} failed, the output is kept in ${WMC_SCRATCH}/failed."
+    return 1
+}
+
+# Wait for the background copies started by wmc_execute; fails if any
+# of them failed
+wmc_copy_wait() {
+    local pid failed=0
+    for pid in "${WMC_COPY_PIDS[@]}"; do
+        wait "${pid}" || failed=1
+    done
+    WMC_COPY_PIDS=()
+    return "${failed}"
+}
+
+# Remove the staged inputs of this process; work directories of failed
+# jobs are kept
+wmc_scratch_cleanup() {
+    [ -n "${WMC_SCRATCH_DIR}" ] || return 0
+    rm -rf "${WMC_SCRATCH_DIR}/input"
+    rmdir "${WMC_SCRATCH_DIR}/output" "${WMC_SCRATCH_DIR}" 2>/dev/null || true
+}
+
+# Record the progress of a WMC job in its progress file
+# <ems file>.progress.<host>-<pid> (one per attempt) as
+#   <output file> <first event> <events done>
+# The events done are taken from the last GTRIGI line written to the log
+# since the given offset (printed at the start of an event, every 500 events
+# with the DEBU card of run/wmc.dat.m4).
+# Usage: wmc_progress_update <progress file> <output> <first event> <log> <offset>
+wmc_progress_update() {
+    local done
+    done=$(tail -c +$(( $5 + 1 )) "$4" 2>/dev/null | awk '
+        /GTRIGI: IEVENT=/ { sub(/.*IEVENT= */, ""); n = $1 + 0 }
+        END { print (n > 1 ? n - 1 : 0) }')
+    echo "$2 $3 ${done}" > "$1.tmp.${BASHPID}" && mv -f "$1.tmp.${BASHPID}" "$1"
+}
+
+# Keep the output of an interrupted WMC attempt as a segment of the job: the
+# output named by the progress file <ems file>.progress.<attempt> is cut to
+# its complete EPIO blocks by $WMC_EMS_RECORDS, which counts the events in
+# them, moved to <job>.seg-<attempt>.ems and listed in <ems file>.segments
+# as "<segment> <first event> <events>". Outputs without complete events
+# or failing the check (or if the tool is not built) are removed.
+# Usage: wmc_keep_segment <ems file> <progress file>
+wmc_keep_segment() {
+    local ems_file="$1" progress="$2" output first done
+    read -r output first done 2>/dev/null < "${progress}" || true
+    rm -f "${progress}"
+    [ -n "${output}" ] && [ -f "${output}" ] || return 0
+    if [ ! -x "${WMC_EMS_RECORDS}" ] || \
+        ! done=$("${WMC_EMS_RECORDS}" --trim "${output}") || [ "${done}" -le 0 ]; then
+        echo "INFO: No complete events could be read from ${output}, it is removed."
+        rm -f "${output}"
+        return 0
+    fi
+
+    local segments="${ems_file}.segments"
+    local segment="${ems_file%.ems}.seg-${progress##*.progress.}.ems"
+    if [ -n "${WMC_SCRATCH_DIR}" ] && [[ "${output}" == "${WMC_SCRATCH_DIR}"/* ]]; then
+        wmc_copy_back "${output}" "${segment}" || return 0
+    else
+        mv -f "${output}" "${segment}"
+    fi
+    echo "${segment} ${first} ${done}" >> "${segments}"
+    echo "INFO: Kept events ${first}-$(( first + done - 1 )) of ${ems_file} in ${segment}."
+}
+
+# Keep the segments of earlier attempts of a job which are no longer running
+# (see wmc_keep_segment); attempts of this host are checked by their PID
+# Usage: wmc_keep_segments <ems file>
+wmc_keep_segments() {
+    local progress attempt
+    for progress in "$1".progress.*; do
+        [ -f "${progress}" ] || continue
+        attempt="${progress##*.progress.}"
+        case "${attempt}" in *.tmp.*) continue ;; esac
+        if [ "${attempt%-*}" = "$(hostname)" ] && kill -0 "${attempt##*-}" 2>/dev/null; then
+            continue
+        fi
+        wmc_keep_segment "$1" "${progress}"
+    done
+}
+
+# Terminate a process and its descendants
+# Usage: wmc_kill_tree <pid>
+wmc_kill_tree() {
+    local child
+    for child in $(pgrep -P "$1" 2>/dev/null); do
+        wmc_kill_tree "${child}"
+    done
+    kill "$1" 2>/dev/null || true
+}
+
+# Run one WMC job in its own temporary directory wmc_tmp_<job>, logging to
+# output_wmc_<job>.log. The directory consists of links into the run
+# template (see wmc_prepare_template); if no template can be prepared the
+# files of run/ are copied and wmc.sh sets up the directory itself.
+# The output is written to <ems file>.part-<host>-<pid> and renamed when
+# WMC succeeds, so an existing .ems file is always complete.
+# With WMC_SCRATCH set the input is staged in, WMC runs in the scratch
+# directory and the output is copied back in the background; callers
+# wait for the copies with wmc_copy_wait.
+# While WMC runs the last completed event is recorded (wmc_progress_update).
+# The output of a failed or killed job is kept as a segment holding its
+# complete events (wmc_keep_segment) and the next attempt continues after
+# the last of them, writing the remaining
+# events as the .ems file; <ems file>.segments then lists all parts of the
+# job, the .ems file last.
+# With WMC_OWNER_FILE set, WMC is stopped and its output discarded as soon
+# as that file no longer holds WMC_OWNER (the job was handed to another
+# process, e.g. a requeued queue task).
+# The temporary directory of a failed job is kept for inspection.
+# Usage: wmc_execute <job> <root file> <ems file> [<first event> <events>]
+wmc_execute() {
+    local job="$1" root_file="$2" ems_file="$3"
+    local input="$2"
+    local attempt="$(hostname)-${BASHPID}"
+    local output="${ems_file}.part-${attempt}"
+    local progress="${ems_file}.progress.${attempt}"
+    local work_dir="wmc_tmp_${job}"
+    local log="${PWD}/output_wmc_${job}.log"
+    local code=0 cards file template=""
+    local range=() first="${4:-0}" events="$5"
+    [ -n "$4" ] && range=( "$4" "$5" )
+
+    # Continue after the events kept from earlier attempts; streamed events
+    # cannot be read again
+    if [ -z "${WMC_KINE_INPUT}" ]; then
+        wmc_keep_segments "${ems_file}" >> "${log}"
+        local next=0
+        if [ -f "${ems_file}.segments" ]; then
+            next=$(awk -v ems="${ems_file}" '$1 != ems { n = $2 + $3 }
+                END { print n + 0 }' "${ems_file}.segments")
+        fi
+        if [ "${next}" -ge "${WMC_KINE_START_MAX}" ]; then
+            echo "INFO: ${job} cannot be resumed at event ${next} (KINE 50 starts below ${WMC_KINE_START_MAX}), its segments are removed." >> "${log}"
+            awk '{ print $1 }' "${ems_file}.segments" | xargs -r rm -f
+            rm -f "${ems_file}.segments"
+        elif [ "${next}" -gt "${first}" ]; then
+            events=$(( ${5:-3000000} - (next - ${4:-0}) ))
+            first="${next}"
+            range=( "${first}" "${events}" )
+            echo "INFO: Resuming ${job} at event ${first}." >> "${log}"
+        fi
+    fi
+
+    if [ -n "${WMC_SCRATCH_DIR}" ]; then
+        if [ -f "${root_file}" ]; then
+            input=$(wmc_stage_in "${root_file}") || {
+                echo "ERROR: Staging ${root_file} to ${WMC_SCRATCH_DIR} failed." >> "${log}"
+                return 1
+            }
+        fi
+        mkdir -p "${WMC_SCRATCH_DIR}/output"
+        output="${WMC_SCRATCH_DIR}/output/$(basename "${output}")"
+        work_dir="${WMC_SCRATCH_DIR}/wmc_tmp_${job}"
+    fi
+
+    rm -rf "${work_dir}"
+    mkdir -p "${work_dir}"
+    if [ -z "${WMC_KINE_INPUT}" ]; then
+        input=$(wmc_restore_input "${input}" "${work_dir}" 2>> "${log}") || {
+            echo "ERROR: Restoring the events of ${root_file} failed." >> "${log}"
+            rm -rf "${work_dir}"
+            return 1
+        }
+    fi
+    if cards=$(wmc_prepare_template "${range[@]}"); then
+        for file in "${cards%/cards/*}"/*; do
+            [ -d "${file}" ] || ln -s "${file}" "${work_dir}/"
+        done
+        ln -s "${cards}" "${work_dir}/wmc.dat"
+        ln -s wmc.dat "${work_dir}/fort.4"
+        template="${cards%/cards/*}"
+    else
+        cp -r "${WMC_DIR}"/run/* "${work_dir}"
+    fi
+
+    local offset monitor="" wmc
+    offset=$(wmc_file_bytes "${log}")
+    local stats="${work_dir}/.wmc_time"
+    wmc_timed "${stats}" env WMC_TEMPLATE="${template}" bash -c \
+        'cd "$0" && exec ./wmc.sh "$@"' "${work_dir}" \
+        "${input}" "${output}" "${range[@]}" >> "${log}" 2>&1 &
+    wmc=$!
+    if [ -z "${WMC_KINE_INPUT}" ] || [ -n "${WMC_OWNER_FILE}" ]; then
+        ( while sleep "${WMC_PROGRESS_INTERVAL}"; do
+              if [ -n "${WMC_OWNER_FILE}" ] && \
+                  [ "$(cat "${WMC_OWNER_FILE}" 2>/dev/null)" != "${WMC_OWNER}" ]; then
+                  wmc_kill_tree "${wmc}"
+                  exit 0
+              fi
+              [ -n "${WMC_KINE_INPUT}" ] || wmc_progress_update "${progress}" \
+                  "${output}" "${first}" "${log}" "${offset}"
+          done ) &
+        monitor=$!
+    fi
+    wait "${wmc}" || code=$?
+    [ -n "${monitor}" ] && kill "${monitor}" 2>/dev/null || true
+
+    # The attempt is given up if the job was handed over meanwhile
+    if [ -n "${WMC_OWNER_FILE}" ] && \
+        [ "$(cat "${WMC_OWNER_FILE}" 2>/dev/null)" != "${WMC_OWNER}" ]; then
+        echo "ERROR: ${job} is no longer owned by ${WMC_OWNER}, its output is discarded." >> "${log}"
+        rm -f "${output}" "${progress}"
+        return 1
+    fi
+
+    # Events of a whole file are counted only if ROOT is available
+    local recorded=""
+    [ -n "$5" ] && recorded="${events}"
+    if [ -z "${recorded}" ] && [ "${code}" -eq 0 ] && [ -f "${root_file}" ]; then
+        recorded=$(wmc_count_events "${root_file}")
+        [ -n "${recorded}" ] && recorded=$(( recorded - first ))
+    fi
+    wmc_metrics_record wmc "${job}" "$(wmc_job_reaction "${job}")" "${code}" \
+        "${stats}" "$(wmc_file_bytes "${root_file}")" \
+        "$(wmc_file_bytes "${output}")" "${recorded}"
+
+    if [ "${code}" -eq 0 ]; then
+        rm -f "${progress}"
+        if [ -s "${ems_file}.segments" ]; then
+            # A whole-file job ends with the last event of the file
+            local listed="-"
+            [ -n "$5" ] && listed="${events}"
+            echo "${ems_file} ${first} ${listed}" >> "${ems_file}.segments"
+        fi
+        if [ -n "${WMC_SCRATCH_DIR}" ]; then
+            wmc_copy_back "${output}" "${ems_file}" >> "${log}" 2>&1 &
+            WMC_COPY_PIDS+=( $! )
+        else
+            mv -f "${output}" "${ems_file}"
+        fi
+        rm -rf "${work_dir}"
+    elif [ -z "${WMC_KINE_INPUT}" ]; then
+        wmc_progress_update "${progress}" "${output}" "${first}" "${log}" "${offset}"
+        wmc_keep_segment "${ems_file}" "${progress}" >> "${log}" 2>&1
+    else
+        rm -f "${output}"
+    fi
+    return "${code}"
+}
+
+# Print the file to be read by KINE 50: for an event archive (see
+# archive/event_archive.h) its PLUTO file restored to <directory>, otherwise
+# the file itself. Archives are only recognised if $WMC_RESTORE is built.
+# Usage: wmc_restore_input <root file> <directory>
+wmc_restore_input() {
+    local restored="$2/restored-$(basename "$1")"
+    if [ ! -x "${WMC_RESTORE}" ] || ! "${WMC_RESTORE}" --check "$1" 2>/dev/null; then
+        echo "$1"
+        return 0
+    fi
+    "${WMC_RESTORE}" "$1" "${restored}" >&2 || return 1
+    echo "${restored}"
+}
+
+# Number of events in the PLUTO tree "data" of a ROOT file (empty on failure),
+# or in the "events" tree of an event archive, taken from the event catalogue
+# of its directory if the file is listed there with its present size,
+# otherwise read with ROOT
+# Usage: wmc_count_events <root file>
+wmc_count_events() {
+    local catalogue entries
+    catalogue="$(dirname "$1")/events.catalogue"
+    if [ -f "${catalogue}" ]; then
+        entries=$(awk -F'\t' -v file="$(basename "$1")" \
+            -v bytes="$(wmc_file_bytes "$1")" \
+            '$1 == file && ($2 == "data" || $2 == "events") {
+                 n = ($6 == bytes) ? $5 : "" }
+             END { print n }' "${catalogue}")
+        if [ -n "${entries}" ]; then
+            echo "${entries}"
+            return 0
+        fi
+    fi
+    root -l -b -q -e "TFile f(\"$1\"); TTree* t = (TTree*)f.Get(\"data\");
+        if (!t) t = (TTree*)f.Get(\"events\");
+        if (t) printf(\"WMC_EVENTS %lld\\n\", t->GetEntries());" 2>/dev/null \
+        | awk '$1 == "WMC_EVENTS" { print $2 }'
+}
+
+# Split the events of a PLUTO file into K ranges processed as separate WMC
+# jobs <job>.chunk-<k>. The plan is written to <WMC_DATA>/<job>.chunks as
+#   # <root file> <total events> <chunks>
+#   <ems file> <first event> <number of events>     (one line per chunk)
+# and reused if it already exists, so a restarted production keeps the
+# chunk boundaries of the finished chunks.
+# Usage: wmc_plan_chunks <job> <root file> <chunks>
+wmc_plan_chunks() {
+    local job="$1" root_file="$2" chunks="$3"
+    local plan="${WMC_DATA}/${job}.chunks"
+    [ -e "${plan}" ] && return 0
+
+    local total size k first
+    total=$(wmc_count_events "${root_file}")
+    if [ -z "${total}" ] || [ "${total}" -le 0 ]; then
+        echo "ERROR: Could not read the number of events of ${root_file}."
+        return 1
+    fi
+    [ "${chunks}" -gt "${total}" ] && chunks="${total}"
+    size=$(( (total + chunks - 1) / chunks ))
+    if [ $(( (total - 1) / size * size )) -ge "${WMC_KINE_START_MAX}" ]; then
+        echo "ERROR: ${job} cannot be split into ${chunks} chunks, KINE 50 starts at events below ${WMC_KINE_START_MAX} only; split ${root_file} into smaller PLUTO files."
+        return 1
+    fi
+
+    {
+        echo "# ${root_file} ${total} ${chunks}"
+        for ((k = 1, first = 0; first < total; ++k, first += size)); do
+            echo "${WMC_DATA}/${job}.chunk-${k}.ems ${first}" \
+                 "$(( total - first < size ? total - first : size ))"
+        done
+    } > "${plan}.tmp"
+    mv "${plan}.tmp" "${plan}"
+}
+
+# Register the chunks of a file as one dataset once all of them are done:
+# the plan is copied to <WMC_DATA>/<job>.dataset, which analysis code reads
+# instead of the single <job>.ems file.
+# Usage: wmc_register_dataset <job>
+wmc_register_dataset() {
+    local plan="${WMC_DATA}/$1.chunks"
+    local dataset="${WMC_DATA}/$1.dataset"
+    local ems_file first events
+    [ -e "${plan}" ] || return 1
+    [ -e "${dataset}" ] && return 0
+    while read -r ems_file first events; do
+        case "${ems_file}" in \#*) continue ;; esac
+        [ -e "${ems_file}" ] || return 1
+    done < "${plan}"
+    cp "${plan}" "${dataset}.tmp.$$" && mv "${dataset}.tmp.$$" "${dataset}"
+    echo "INFO: All chunks of $1 are done, dataset registered in ${dataset}."
+}
@@ -0,0 +1,98 @@
+#!/bin/bash
+#******************************************************************************
+# Resource metrics of the simulation jobs
+#
+# Usage: ./wmc_metrics.sh run [-k <kind>] -r <reaction> [-e <events>]
+#                             [-o <output>]... -- <command>...
+#            run a job (e.g. a PLUTO generator) and record its metrics
+#        ./wmc_metrics.sh summary [<reaction>]
+#            summarise the recorded jobs per reaction, kind and geometry
+#
+# WMC jobs started by wmc_run.sh, wmc_queue.sh and wmc_stream.sh are
+# recorded automatically. The run database $WMC_METRICS_DB (default:
+# $WMC_DATA/metrics.csv) holds one CSV line per job with the wall, user and
+# system time [s], the maximum resident set size [kB], the input and output
+# sizes [bytes], the number of events and the events per second.
+# The geometry column is taken from $WMC_GEOMETRY (default: B009).
+#******************************************************************************
+
+set -e
+
+source "$(dirname "$0")/wmc_common.sh"
+
+usage() {
+    sed -n '4,9p' "$0" | sed 's/^# \?//'
+    exit 1
+}
+
+metrics_run() {
+    local kind="pluto" reaction="" events=""
+    local outputs=()
+    local OPTIND option
+    while getopts "k:r:e:o:" option; do
+        case "${option}" in
+            k) kind="${OPTARG}" ;;
+            r) reaction="${OPTARG}" ;;
+            e) events="${OPTARG}" ;;
+            o) outputs+=( "${OPTARG}" ) ;;
+            *) usage ;;
+        esac
+    done
+    shift $((OPTIND - 1))
+    if [ -z "${reaction}" ] || [ $# -eq 0 ]; then usage; fi
+
+    local stats code=0
+    stats=$(mktemp)
+    wmc_timed "${stats}" "$@" || code=$?
+
+    # Output patterns are expanded after the job has written its files
+    local files=() pattern
+    shopt -s nullglob
+    for pattern in "${outputs[@]}"; do
+        files+=( ${pattern} )
+    done
+    wmc_metrics_record "${kind}" "${reaction}" "${reaction}" "${code}" \
+        "${stats}" 0 "$(wmc_file_bytes "${files[@]}")" "${events}"
+    rm -f "${stats}"
+    return "${code}"
+}
+
+metrics_summary() {
+    if [ ! -s "${WMC_METRICS_DB}" ]; then
+        echo "ERROR: No metrics recorded in ${WMC_METRICS_DB}."
+        exit 1
+    fi
+    awk -F, -v reaction="$1" '
+        NR == 1 { next }
+        reaction != "" && $5 != reaction { next }
+        {
+            key = $5 SUBSEP $3 SUBSEP $6
+            jobs[key]++
+            if ($7 != 0) failed[key]++
+            wall[key] += $8; cpu[key] += $9 + $10
+            if ($11 > rss[key]) rss[key] = $11
+            outb[key] += $13
+            if ($7 == 0 && $14 > 0) { events[key] += $14; ewall[key] += $8 }
+        }
+        END {
+            printf "%-28s %-6s %-5s %5s %5s %12s %10s %10s %10s %9s %9s\n",
+                   "REACTION", "KIND", "GEOM", "JOBS", "FAIL", "EVENTS",
+                   "WALL [h]", "CPU [h]", "EVENTS/S", "RSS [MB]", "OUT [GB]"
+            for (key in jobs) {
+                split(key, k, SUBSEP)
+                printf "%-28s %-6s %-5s %5d %5d %12d %10.2f %10.2f %10.1f %9.1f %9.2f\n",
+                       k[1], k[2], k[3], jobs[key], failed[key], events[key],
+                       wall[key] / 3600, cpu[key] / 3600,
+                       (ewall[key] > 0 ? events[key] / ewall[key] : 0),
+                       rss[key] / 1024, outb[key] / 1073741824
+            }
+        }' "${WMC_METRICS_DB}" | { read -r header; echo "${header}"; sort; }
+}
+
+command="$1"
+shift || true
+case "${command}" in
+    run)     metrics_run "$@" ;;
+    summary) metrics_summary "$@" ;;
+    *)       usage ;;
+esac
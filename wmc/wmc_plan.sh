@@ -0,0 +1,80 @@
+#!/bin/bash
+#******************************************************************************
+# Plans the job sizes of a production from the measured throughput
+#
+# Usage: ./wmc_plan.sh -n <total events> -t <wall time per job> <reaction>
+#   -n  number of events requested for the reaction
+#   -t  target wall time of one WMC job, e.g. 14400, 240m or 4h
+#
+# The median events/s of the WMC and generator jobs recorded for the
+# reaction and geometry ($WMC_GEOMETRY, default: B009) in $WMC_METRICS_DB
+# (see wmc_metrics.sh) gives the number of events per WMC job. The plan
+# keeps the requested total: it is split into jobs of equal size, the last
+# one taking the remainder. Without recorded WMC jobs no plan can be made;
+# run a short production first.
+#******************************************************************************
+
+set -e
+
+source "$(dirname "$0")/wmc_common.sh"
+
+usage() {
+    sed -n '4,6p' "$0" | sed 's/^# \?//'
+    exit 1
+}
+
+total=""
+target=""
+while getopts "n:t:" option; do
+    case "${option}" in
+        n) total="${OPTARG}" ;;
+        t) target=$(wmc_seconds "${OPTARG}") ;;
+        *) usage ;;
+    esac
+done
+shift $((OPTIND - 1))
+
+if [ -z "$1" ] || [ -z "${total}" ] || [ -z "${target}" ]; then
+    usage
+fi
+reaction="$1"
+geometry="${WMC_GEOMETRY:-B009}"
+
+wmc_rate=$(wmc_median_rate wmc "${reaction}" "${geometry}")
+if [ -z "${wmc_rate}" ]; then
+    echo "ERROR: No WMC jobs of ${reaction} (${geometry}) recorded in ${WMC_METRICS_DB}."
+    exit 1
+fi
+pluto_rate=$(wmc_median_rate pluto "${reaction}" "${geometry}")
+
+awk -v n="${total}" -v t="${target}" -v r="${wmc_rate}" \
+    -v g="${pluto_rate}" -v reaction="${reaction}" -v geometry="${geometry}" '
+    BEGIN {
+        per_job = int(r * t)
+        if (per_job < 1) per_job = 1
+        if (per_job > n) per_job = n
+        jobs = int((n + per_job - 1) / per_job)
+        per_job = int((n + jobs - 1) / jobs)     # Balance the jobs
+        last = n - (jobs - 1) * per_job
+
+        printf "Reaction:            %s (%s)\n", reaction, geometry
+        printf "WMC throughput:      %.2f events/s (median)\n", r
+        printf "Target wall time:    %d s per job\n", t
+        printf "Events per job:      %d\n", per_job
+        printf "Jobs:                %d (last job: %d events)\n", jobs, last
+        printf "Expected wall time:  %.1f s per job, %.2f h in total\n",
+               per_job / r, n / r / 3600
+        if (g != "")
+            printf "Generator:           %.2f events/s, %.2f h for all events\n",
+                   g, n / g / 3600
+        if (per_job > 3000000)
+            printf "WARNING: more than 3000000 events per job; whole-file " \
+                   "jobs stop at the TRIG card of run/wmc.dat.m4, use -t " \
+                   "with wmc_run.sh.\n"
+
+        print ""
+        print "Generate one PLUTO file per WMC job:"
+        printf "    ./pluto_run --events %d --per-file %d <products>\n", n, per_job
+        print "or split existing files to the target wall time:"
+        printf "    ./wmc_run.sh -t %d %s\n", t, reaction
+    }'
@@ -0,0 +1,298 @@
+#!/bin/bash
+#******************************************************************************
+# File-based work queue for WMC jobs on several hosts sharing a filesystem
+#
+# Usage: ./wmc_queue.sh init [-c <chunks> | -t <wall time>] <reaction>
+#                                             add the PLUTO files of a reaction,
+#                                             optionally split into event ranges
+#                                             (see wmc_run.sh for -c and -t)
+#        ./wmc_queue.sh worker [-j <n>]       process tasks until the queue is
+#                                             empty, with n local workers
+#        ./wmc_queue.sh requeue               return tasks of dead workers
+#        ./wmc_queue.sh status                print the state of the queue
+#
+# The queue lives in $WMC_QUEUE (default: $WMC_DATA/queue) and consists of
+# the directories pending/, running/, done/ and failed/ holding one file per
+# task: "<root file> <ems file> <first event> <number of events> <attempts>"
+# (first event and number of events are "-" for a whole file).
+# A task is claimed by renaming it from pending/ to running/, which is atomic
+# on POSIX filesystems. While a task runs its worker touches the heartbeat
+# file running/<task>.owner; tasks whose heartbeat is older than
+# $WMC_HEARTBEAT_TIMEOUT seconds are returned to pending/ by any worker.
+#******************************************************************************
+
+set -e
+shopt -s nullglob extglob  # Before the functions using +(...) are parsed
+
+source "$(dirname "$0")/wmc_common.sh"
+
+WMC_QUEUE="${WMC_QUEUE:-${WMC_DATA}/queue}"
+WMC_MAX_ATTEMPTS="${WMC_MAX_ATTEMPTS:-3}"
+
+usage() {
+    sed -n '4,11p' "$0" | sed 's/^# \?//'
+    exit 1
+}
+
+# Add a task to the queue unless it is already known
+# Usage: add_task <task> <root file> <ems file> <first event> <events>
+add_task() {
+    local task="$1"
+    local state
+    for state in pending running done failed; do
+        [ -e "${WMC_QUEUE}/${state}/${task}" ] || continue
+        # The copy of the output back from scratch may have failed
+        if [ "${state}" = "done" ] && [ ! -e "$3" ]; then
+            echo "INFO: Output of ${task} is missing, requeued."
+            mv "${WMC_QUEUE}/done/${task}" "${WMC_QUEUE}/pending/${task}"
+            return 0
+        fi
+        echo "INFO: Task ${task} is already queued (${state})."
+        return 0
+    done
+    if [ -e "$3" ]; then
+        echo "INFO: Simulation for ${task} has already been completed and will be skipped."
+        return 0
+    fi
+    # Write to a temporary name first, a worker must never see a partial task
+    echo "$2 $3 $4 $5 0" > "${WMC_QUEUE}/pending/.${task}.new"
+    mv "${WMC_QUEUE}/pending/.${task}.new" "${WMC_QUEUE}/pending/${task}"
+    echo "Queued ${task}"
+}
+
+queue_init() {
+    local chunks=1 target=""
+    local OPTIND option
+    while getopts "c:t:" option; do
+        case "${option}" in
+            c) chunks="${OPTARG}" ;;
+            t) target=$(wmc_seconds "${OPTARG}") ;;
+            *) usage ;;
+        esac
+    done
+    shift $((OPTIND - 1))
+
+    local reaction="$1"
+    if [ -z "${reaction}" ] || [ "${chunks}" -lt 1 ]; then usage; fi
+    if [ -z "${PLUTO_OUTPUT}" ] || [ -z "${WMC_DATA}" ]; then
+        echo "ERROR: The environment variables PLUTO_OUTPUT and WMC_DATA must be defined."
+        exit 1
+    fi
+
+    mkdir -p "${WMC_QUEUE}"/{pending,running,done,failed}
+
+    local root_file job chunk_ems first events file_chunks
+    for root_file in "${PLUTO_OUTPUT}/${reaction}-"+([0-9]).root; do
+        job=$(basename "${root_file}" .root)
+        file_chunks=$(wmc_file_chunks "${root_file}" "${reaction}" \
+            "${chunks}" "${target}")
+        if [ "${file_chunks}" -eq 1 ] && [ ! -e "${WMC_DATA}/${job}.chunks" ]; then
+            add_task "${job}" "${root_file}" "${WMC_DATA}/${job}.ems" - -
+            continue
+        fi
+        if [ -e "${WMC_DATA}/${job}.dataset" ]; then
+            echo "INFO: Simulation for ${job} has already been completed and will be skipped."
+            continue
+        fi
+        wmc_plan_chunks "${job}" "${root_file}" "${file_chunks}" || continue
+        while read -r chunk_ems first events; do
+            case "${chunk_ems}" in \#*) continue ;; esac
+            add_task "$(basename "${chunk_ems}" .ems)" "${root_file}" \
+                "${chunk_ems}" "${first}" "${events}"
+        done < "${WMC_DATA}/${job}.chunks"
+    done
+}
+
+# Seconds since the heartbeat of a running task. A task claimed just before
+# its worker died may have no heartbeat file yet; the claim time is then
+# taken from the status change time of the renamed task file.
+# Usage: task_age <running task file>
+task_age() {
+    local now heartbeat
+    now=$(date +%s)
+    if [ -e "$1.owner" ]; then
+        heartbeat=$(stat -c %Y "$1.owner" 2>/dev/null || echo "${now}")
+    else
+        heartbeat=$(stat -c %Z "$1" 2>/dev/null || echo "${now}")
+    fi
+    echo $(( now - heartbeat ))
+}
+
+# Return tasks whose heartbeat has stopped to pending/. The tasks are checked
+# again by the one worker holding the lock "requeue" of the queue, so that
+# a task requeued and claimed again meanwhile is not taken from its worker.
+queue_requeue() {
+    local file task age owner locked=""
+    for file in "${WMC_QUEUE}"/running/*; do
+        [ -e "${file}" ] || continue
+        case "${file}" in *.owner) continue ;; esac
+        [ "$(task_age "${file}")" -gt "${WMC_HEARTBEAT_TIMEOUT}" ] || continue
+        if [ -z "${locked}" ]; then
+            WMC_LOCK_DIR="${WMC_QUEUE}" wmc_lock_acquire requeue "${BASHPID}" \
+                > /dev/null || return 0
+            locked=1
+        fi
+        [ -e "${file}" ] || continue
+        age=$(task_age "${file}")
+        [ "${age}" -gt "${WMC_HEARTBEAT_TIMEOUT}" ] || continue
+        task=$(basename "${file}")
+        owner=$(cat "${file}.owner" 2>/dev/null || echo "unknown worker")
+        # The owner file goes first: once the task is back in pending/,
+        # another worker may claim it and write its own owner file
+        rm -f "${file}.owner"
+        if mv "${file}" "${WMC_QUEUE}/pending/${task}" 2>/dev/null; then
+            echo "INFO: Requeued ${task} (no heartbeat from ${owner} for ${age} s)."
+        fi
+    done
+    [ -z "${locked}" ] || WMC_LOCK_DIR="${WMC_QUEUE}" wmc_lock_release requeue
+}
+
+# Claim the next pending task for the worker WORKER_ID; prints its name,
+# fails if none is left
+claim_task() {
+    local file task
+    for file in "${WMC_QUEUE}"/pending/*; do
+        [ -e "${file}" ] || continue
+        task=$(basename "${file}")
+        if mv "${file}" "${WMC_QUEUE}/running/${task}" 2>/dev/null; then
+            echo "${WORKER_ID}" > "${WMC_QUEUE}/running/${task}.owner"
+            echo "${task}"
+            return 0
+        fi
+    done
+    return 1
+}
+
+# Process one claimed task and move it to done/, failed/ or back to pending/.
+# Another worker may requeue the task at any time (see queue_requeue); the
+# task is then left alone and WMC is stopped (WMC_OWNER_FILE of wmc_execute).
+run_task() {
+    local task="$1"
+    local running="${WMC_QUEUE}/running/${task}"
+    local root_file ems_file first events attempts code=0 heartbeat
+
+    read -r root_file ems_file first events attempts 2>/dev/null < "${running}" \
+        || return 0
+
+    # Stage the input of the next task while this one runs
+    local next
+    for next in "${WMC_QUEUE}"/pending/*; do
+        wmc_prefetch "$(cut -d ' ' -f 1 "${next}" 2>/dev/null)"
+        break
+    done
+
+    # Heartbeat while WMC is running and the task is still ours
+    ( while sleep "${WMC_HEARTBEAT}"; do
+          [ "$(cat "${running}.owner" 2>/dev/null)" = "${WORKER_ID}" ] || exit 0
+          touch -c "${running}.owner" 2>/dev/null || exit 0
+      done ) &
+    heartbeat=$!
+
+    echo "... ${WORKER_ID}: starting ${task} ..."
+    local range=()
+    [ "${first}" = "-" ] || range=( "${first}" "${events}" )
+    WMC_OWNER_FILE="${running}.owner" WMC_OWNER="${WORKER_ID}" \
+        wmc_execute "${task}" "${root_file}" "${ems_file}" "${range[@]}" || code=$?
+    kill "${heartbeat}" 2>/dev/null || true
+
+    # The task may have been requeued if this worker was considered dead
+    if [ "$(cat "${running}.owner" 2>/dev/null)" != "${WORKER_ID}" ]; then
+        echo "WARNING: ${task} was requeued while running on ${WORKER_ID}."
+        return 0
+    fi
+    rm -f "${running}.owner"
+
+    attempts=$((attempts + 1))
+    [ -e "${running}" ] || return 0
+    echo "${root_file} ${ems_file} ${first} ${events} ${attempts}" > "${running}" \
+        || return 0
+    if [ "${code}" -eq 0 ]; then
+        mv "${running}" "${WMC_QUEUE}/done/${task}" || return 0
+        echo "${WORKER_ID}: ${task} completed at $(date)."
+        if [ "${first}" != "-" ]; then
+            wmc_register_dataset "${task%.chunk-*}" || true
+        fi
+    elif [ "${attempts}" -lt "${WMC_MAX_ATTEMPTS}" ]; then
+        mv "${running}" "${WMC_QUEUE}/pending/${task}" || return 0
+        echo "ERROR: ${WORKER_ID}: ${task} failed with exit code ${code}, requeued."
+    else
+        mv "${running}" "${WMC_QUEUE}/failed/${task}" || return 0
+        echo "ERROR: ${WORKER_ID}: ${task} failed ${attempts} times, giving up."
+    fi
+}
+
+# Take tasks until no pending or running tasks are left
+worker_loop() {
+    local task
+    WORKER_ID="$(hostname) ${BASHPID}"
+    while true; do
+        queue_requeue
+        if task=$(claim_task); then
+            run_task "${task}"
+            continue
+        fi
+        # Nothing pending: wait for running tasks, they may still be requeued
+        if ! ls "${WMC_QUEUE}"/running/ 2>/dev/null | grep -qv '\.owner$'; then
+            break
+        fi
+        sleep "${WMC_HEARTBEAT}"
+    done
+
+    # Outputs are copied back from scratch in the background; chunks
+    # finished in the meantime may complete a dataset
+    wmc_copy_wait || echo "ERROR: ${WORKER_ID}: copying outputs back failed."
+    for task in "${WMC_QUEUE}"/done/*.chunk-*; do
+        wmc_register_dataset "$(basename "${task%.chunk-*}")" > /dev/null || true
+    done
+}
+
+queue_worker() {
+    local workers=1
+    local OPTIND option
+    while getopts "j:" option; do
+        case "${option}" in
+            j) workers="${OPTARG}" ;;
+            *) usage ;;
+        esac
+    done
+
+    if [ ! -d "${WMC_QUEUE}/pending" ]; then
+        echo "ERROR: Queue ${WMC_QUEUE} does not exist, run init first."
+        exit 1
+    fi
+
+    local i
+    for ((i = 0; i < workers; ++i)); do
+        worker_loop &
+    done
+    wait
+    wmc_scratch_cleanup
+    echo "$(hostname): no more tasks in ${WMC_QUEUE}."
+}
+
+queue_status() {
+    local state
+    for state in pending running done failed; do
+        printf "%-8s %5d\n" "${state}" \
+            "$(ls "${WMC_QUEUE}/${state}" 2>/dev/null | grep -cv '\.owner$' || true)"
+    done
+    for state in running failed; do
+        local file
+        for file in "${WMC_QUEUE}/${state}"/*; do
+            [ -e "${file}" ] || continue
+            case "${file}" in *.owner) continue ;; esac
+            echo "${state}: $(basename "${file}")" \
+                 "$(cat "${file}.owner" 2>/dev/null || true)"
+        done
+    done
+}
+
+command="$1"
+shift || true
+case "${command}" in
+    init)    queue_init "$@" ;;
+    worker)  queue_worker "$@" ;;
+    requeue) queue_requeue ;;
+    status)  queue_status ;;
+    *)       usage ;;
+esac
@@ -1,50 +1,173 @@
 #!/bin/bash
+#******************************************************************************
+# Runs the WASA Monte Carlo simulation for all PLUTO files of a reaction
+# Usage: ./wmc_run.sh [-j <parallel jobs>] [-c <chunks> | -t <wall time>]
+#                     <reaction>
+#   -j  maximum number of WMC jobs running at once (default: number of cores)
+#   -c  split every PLUTO file into this many event ranges simulated as
+#       separate jobs <file>.chunk-<k>; the outputs are registered as one
+#       dataset in $WMC_DATA/<file>.dataset (default: 1, no splitting)
+#   -t  split the files so that each job takes about this wall time (e.g.
+#       4h, 90m) at the median events/s recorded for the reaction and
+#       geometry in $WMC_METRICS_DB; falls back to -c without history
+#******************************************************************************
 
 set -e  # Exit immediately if a command exits with a non-zero status
 
+source "$(dirname "$0")/wmc_common.sh"
+
+usage() {
+    echo "Usage: $0 [-j <parallel jobs>] [-c <chunks> | -t <wall time>] <reaction>"
+    exit 1
+}
+
+max_jobs=$(wmc_num_cores)
+chunks=1
+target=""
+while getopts "j:c:t:" option; do
+    case "${option}" in
+        j) max_jobs="${OPTARG}" ;;
+        c) chunks="${OPTARG}" ;;
+        t) target=$(wmc_seconds "${OPTARG}") ;;
+        *) usage ;;
+    esac
+done
+shift $((OPTIND - 1))
+
+if [ -z "$1" ] || [ "${chunks}" -lt 1 ]; then
+    usage
+fi
+
 # Check if necessary environment variables are set
 if [ -z "${PLUTO_OUTPUT}" ] || [ -z "${WMC_DATA}" ]; then
     echo "ERROR: The environment variables PLUTO_OUTPUT and WMC_DATA must be defined."
     exit 1
 fi
 
-# Main loop to process each simulation run
-for run_number in $(seq 1 1 10); do
-    root_file="${PLUTO_OUTPUT}/$1-${run_number}.root"
-    ems_file="${WMC_DATA}/$1-${run_number}.ems"    
-    
-    # Check if the input ROOT file exists
-    if [ -e "${root_file}" ]; then
-        # Skip processing if simulation results already exist
-        if [ -e "${ems_file}" ]; then
-            echo "INFO: Simulation for $1-${run_number} has already been completed and will be skipped."
-            continue
-        else
-            script_name="wmc_run_$1-${run_number}.sh"
-            # Check if the simulation is currently being processed
-            if [ -e "${script_name}" ]; then
-                echo "INFO: File $1-${run_number} is currently being processed."
-                continue
-            else
-                echo "... Starting a WASA Monte Carlo simulation for $1-${run_number} ..."                
-                cat > "${script_name}" <<- EOM
-#!/bin/bash
-# Automatically generated script for running Monte Carlo simulation
-set -e
-mkdir -p "wmc_tmp_$1-${run_number}"
-cp -r run/* "wmc_tmp_$1-${run_number}"
-cd "wmc_tmp_$1-${run_number}"
-./wmc.sh "${root_file}" "${ems_file}"
-cd ..
-rm -rf "wmc_tmp_$1-${run_number}"
-rm -f "${script_name}"
-EOM
-                chmod u+x "${script_name}"
-                ./"${script_name}" >> output_wmc_$1-${run_number}.log 2>&1
-                echo "The simulation for $1-${run_number} has been successfully completed at $(date). Results are available at ${ems_file}."
-            fi
-        fi
+# Runs a single WMC job in its own temporary directory; the caller holds
+# the lock of the job, which is released when the job ends, and its slot,
+# which is freed when WMC ends (the output may still be copied back)
+# Usage: run_job <job> <root file> <ems file> [<first event> <events>]
+run_job() {
+    local job="$1" root_file="$2" ems_file="$3"
+    local start=$(date +%s)
+    local code=0
+
+    trap 'rm -f "${slot_dir}/${job}"; wmc_lock_release "${job}"' EXIT
+    wmc_lock_heartbeat "${job}"
+    wmc_set_status "${job}" running - "${start}"
+
+    wmc_execute "$@" || code=$?
+    rm -f "${slot_dir}/${job}"
+    if [ "${code}" -eq 0 ]; then
+        wmc_copy_wait || code=$?
+    fi
+    if [ "${code}" -eq 0 ]; then
+        wmc_set_status "${job}" done 0 "${start}"
+        echo "The simulation for ${job} has been successfully completed at $(date). Results are available at ${ems_file}."
     else
-        echo "ERROR: The ROOT file ${root_file} does not exist, skipping this simulation."
+        wmc_set_status "${job}" failed "${code}" "${start}"
+        echo "ERROR: The simulation for ${job} failed with exit code ${code}, see output_wmc_${job}.log."
+    fi
+}
+
+# Starts a job in the background as soon as a slot is free, unless its
+# output exists or another process holds its lock
+# Usage: start_job <job> <root file> <ems file> [<first event> <events>]
+start_job() {
+    local job="$1" ems_file="$3"
+
+    # Skip processing if simulation results already exist
+    if [ -e "${ems_file}" ]; then
+        echo "INFO: Simulation for ${job} has already been completed and will be skipped."
+        return 0
+    fi
+
+    # Wait for a free slot
+    while [ "$(ls "${slot_dir}" | wc -l)" -ge "${max_jobs}" ]; do
+        sleep 1
+    done
+
+    # Check if the simulation is currently being processed
+    if ! wmc_lock_acquire "${job}"; then
+        echo "INFO: File ${job} is currently being processed."
+        return 0
     fi
+
+    echo "... Starting a WASA Monte Carlo simulation for ${job} ..."
+    touch "${slot_dir}/${job}"
+    run_job "$@" &
+    wmc_lock_update "${job}" $!
+    jobs_started+=( "${job}" )
+}
+
+shopt -s nullglob extglob
+root_files=( "${PLUTO_OUTPUT}/$1-"+([0-9]).root )
+if [ ${#root_files[@]} -eq 0 ]; then
+    echo "ERROR: No ROOT files $1-<n>.root were found in ${PLUTO_OUTPUT}."
+    exit 1
+fi
+
+echo "INFO: Running up to ${max_jobs} WMC jobs at once."
+if [ -n "${target}" ]; then
+    rate=$(wmc_median_rate wmc "$1")
+    if [ -n "${rate}" ]; then
+        echo "INFO: Sizing jobs for ${target} s at ${rate} events/s."
+    else
+        echo "WARNING: No throughput recorded for $1 (${WMC_GEOMETRY:-B009}), using ${chunks} chunk(s) per file."
+    fi
+fi
+
+# Slots of the running WMC jobs, one file per job
+slot_dir=$(mktemp -d "${TMPDIR:-/tmp}/wmc_run_slots.XXXXXX")
+trap 'rm -rf "${slot_dir}"' EXIT
+
+# Main loop to process each simulation run
+mapfile -t root_files < <(printf "%s\n" "${root_files[@]}" | sort -V)
+jobs_started=()
+chunked_files=()
+for ((i = 0; i < ${#root_files[@]}; ++i)); do
+    root_file="${root_files[i]}"
+    job=$(basename "${root_file}" .root)
+    ems_file="${WMC_DATA}/${job}.ems"
+
+    # Stage the input of the next file while the jobs of this one start
+    next="${root_files[i + 1]}"
+    if [ -n "${next}" ] && [ ! -e "${WMC_DATA}/$(basename "${next}" .root).ems" ] && \
+       [ ! -e "${WMC_DATA}/$(basename "${next}" .root).dataset" ]; then
+        wmc_prefetch "${next}"
+    fi
+
+    file_chunks=$(wmc_file_chunks "${root_file}" "$1" "${chunks}" "${target}")
+    if [ "${file_chunks}" -eq 1 ] && [ ! -e "${WMC_DATA}/${job}.chunks" ]; then
+        start_job "${job}" "${root_file}" "${ems_file}"
+        continue
+    fi
+
+    if [ -e "${ems_file}" ] || [ -e "${WMC_DATA}/${job}.dataset" ]; then
+        echo "INFO: Simulation for ${job} has already been completed and will be skipped."
+        continue
+    fi
+    wmc_plan_chunks "${job}" "${root_file}" "${file_chunks}" || continue
+    chunked_files+=( "${job}" )
+
+    # The plan is read from fd 3 so that the jobs cannot consume it
+    while read -r -u 3 chunk_ems first events; do
+        case "${chunk_ems}" in \#*) continue ;; esac
+        start_job "$(basename "${chunk_ems}" .ems)" "${root_file}" \
+            "${chunk_ems}" "${first}" "${events}"
+    done 3< "${WMC_DATA}/${job}.chunks"
 done
+
+wait || true
+wmc_scratch_cleanup
+
+for job in "${chunked_files[@]}"; do
+    wmc_register_dataset "${job}" || \
+        echo "INFO: Chunks of ${job} are missing, the dataset is not complete yet."
+done
+
+if [ ${#jobs_started[@]} -gt 0 ]; then
+    echo
+    wmc_print_status "${jobs_started[@]}"
+fi
@@ -0,0 +1,112 @@
+#!/bin/bash
+#******************************************************************************
+# Runs an event generator and WMC at the same time, connected by a named pipe
+# Usage: ./wmc_stream.sh -n <events> <job> <generator command>...
+#   -n   number of events WMC processes (TRIG card)
+#   job  name of the job; the output is written to $WMC_DATA/<job>.ems
+# The generator writes GINFile records to the pipe, which WMC reads as
+# fort.31 in KINE 10 mode. Every argument "@fifo@" of the generator command
+# is replaced by the path of the pipe, e.g.
+#   ./wmc_stream.sh -n 5000 ppn_spec-cdbonn \
+#       ../pluto/quasifree/build/run_simulate cdbonn --gin @fifo@ \
+#       --events 5000 --iterations 1
+# A generator writing more than <events> events is stopped when WMC is done.
+# The events never reach the disk, only the .ems output is written.
+#******************************************************************************
+
+set -e
+
+source "$(dirname "$0")/wmc_common.sh"
+
+usage() {
+    echo "Usage: $0 -n <events> <job> <generator command>..."
+    exit 1
+}
+
+events=""
+while getopts "n:" option; do
+    case "${option}" in
+        n) events="${OPTARG}" ;;
+        *) usage ;;
+    esac
+done
+shift $((OPTIND - 1))
+
+if [ -z "${events}" ] || [ $# -lt 2 ]; then
+    usage
+fi
+
+if [ -z "${WMC_DATA}" ]; then
+    echo "ERROR: The environment variable WMC_DATA must be defined."
+    exit 1
+fi
+
+job="$1"
+shift
+ems_file="${WMC_DATA}/${job}.ems"
+
+if [ -e "${ems_file}" ]; then
+    echo "INFO: Simulation for ${job} has already been completed and will be skipped."
+    exit 0
+fi
+
+if ! wmc_lock_acquire "${job}"; then
+    echo "INFO: File ${job} is currently being processed."
+    exit 0
+fi
+wmc_lock_heartbeat "${job}"
+
+fifo_dir=$(mktemp -d "${TMPDIR:-/tmp}/wmc_stream_${job}.XXXXXX")
+fifo="${fifo_dir}/fort31.fifo"
+mkfifo "${fifo}"
+trap 'rm -rf "${fifo_dir}"; wmc_scratch_cleanup; wmc_lock_release "${job}"' EXIT
+
+# Substitute the pipe into the generator command
+generator=()
+for arg in "$@"; do
+    if [ "${arg}" = "@fifo@" ]; then
+        generator+=( "${fifo}" )
+    else
+        generator+=( "${arg}" )
+    fi
+done
+
+echo "... Streaming ${events} events of ${job} from: ${generator[*]} ..."
+"${generator[@]}" > "output_gen_${job}.log" 2>&1 &
+generator_pid=$!
+
+( WMC_KINE_INPUT="${fifo}" wmc_execute "${job}" - "${ems_file}" 0 "${events}" \
+    && wmc_copy_wait ) &
+wmc_pid=$!
+
+# WMC stops reading after its TRIG events, so a generator with more events
+# is ended by SIGPIPE (exit code 141); this is only an error if WMC failed.
+# A generator failing before it opens the pipe would leave WMC waiting for
+# a writer forever; open and close the pipe to let WMC see the end of input
+generator_code=0
+wait "${generator_pid}" || generator_code=$?
+if [ "${generator_code}" -ne 0 ] && [ "${generator_code}" -ne 141 ]; then
+    echo "ERROR: The generator failed with exit code ${generator_code}, see output_gen_${job}.log."
+    timeout 10 bash -c ': > "$1"' _ "${fifo}" 2>/dev/null || true
+fi
+
+wmc_code=0
+wait "${wmc_pid}" || wmc_code=$?
+
+if [ "${generator_code}" -eq 141 ]; then
+    if [ "${wmc_code}" -eq 0 ]; then
+        echo "INFO: WMC has read its ${events} events, the rest of the generator output was not used."
+        generator_code=0
+    else
+        echo "ERROR: WMC stopped reading the events, see output_wmc_${job}.log."
+    fi
+fi
+
+if [ "${generator_code}" -ne 0 ] || [ "${wmc_code}" -ne 0 ]; then
+    [ "${wmc_code}" -ne 0 ] && \
+        echo "ERROR: WMC failed with exit code ${wmc_code}, see output_wmc_${job}.log."
+    rm -f "${ems_file}"
+    exit 1
+fi
+
+echo "The simulation for ${job} has been successfully completed at $(date). Results are available at ${ems_file}."